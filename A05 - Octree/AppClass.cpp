@@ -1,4 +1,5 @@
 #include "AppClass.h"
+#include <chrono>
 using namespace Simplex;
 void Application::InitVariables(void)
 {
@@ -18,6 +19,8 @@ void Application::InitVariables(void)
 	int nSquare = static_cast<int>(std::sqrt(uInstances));
 	m_uObjects = nSquare * nSquare;
 	uint uIndex = -1;
+	//every cube after the first one is an instance of the same model, time how long they take
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
 	for (int i = 0; i < nSquare; i++)
 	{
 		for (int j = 0; j < nSquare; j++)
@@ -29,6 +32,7 @@ void Application::InitVariables(void)
 			m_pEntityMngr->SetModelMatrix(m4Position);
 		}
 	}
+	m_fLoadTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
 	m_uOctantLevels = 1;
 	m_pRoot = new MyOctant(m_uOctantLevels, 5);
 	m_pEntityMngr->Update();
@@ -16,6 +16,9 @@ void Simplex::MyEntityManager::Release(void)
 	}
 	m_uEntityCount = 0;
 	m_mEntityArray = nullptr;
+
+	//no instance of the loaded models is left
+	MyEntity::ReleaseModelCache();
 }
 Simplex::MyEntityManager* Simplex::MyEntityManager::GetInstance()
 {
@@ -0,0 +1,35 @@
+/*----------------------------------------------
+Programmer: Alberto Bobadilla (labigm@gmail.com)
+Date: 2017/05
+----------------------------------------------*/
+//Stand in for GLEW when C07_InstanceCheck is built on Linux, Mesa exports the entry points directly so
+//they are declared by the system headers instead of being loaded by glewInit
+#ifndef __INSTANCECHECKGLEW_H_
+#define __INSTANCECHECKGLEW_H_
+
+#define GL_GLEXT_PROTOTYPES
+#include <GL/gl.h>
+#include <GL/glext.h>
+#include <cstring>
+
+//same answer GLEW would give for the context that is current
+inline bool InstanceCheckHasBufferStorage(void)
+{
+	GLint nMajor = 0, nMinor = 0;
+	glGetIntegerv(GL_MAJOR_VERSION, &nMajor);
+	glGetIntegerv(GL_MINOR_VERSION, &nMinor);
+	if (nMajor > 4 || (nMajor == 4 && nMinor >= 4))
+		return true;
+	GLint nExtensions = 0;
+	glGetIntegerv(GL_NUM_EXTENSIONS, &nExtensions);
+	for (GLint i = 0; i < nExtensions; ++i)
+	{
+		const char* sName = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+		if (sName && strcmp(sName, "GL_ARB_buffer_storage") == 0)
+			return true;
+	}
+	return false;
+}
+#define GLEW_ARB_buffer_storage InstanceCheckHasBufferStorage()
+
+#endif //__INSTANCECHECKGLEW_H_
@@ -0,0 +1,272 @@
+/*----------------------------------------------
+Programmer: Alberto Bobadilla (labigm@gmail.com)
+Date: 2017/05
+----------------------------------------------*/
+//Checks the streamed instance path of C07_System (InstanceBuffer and the *-InstancedVBO.vs shaders) on an
+//offscreen OpenGL 4.5 core context, so it can run on Linux under Mesa llvmpipe without a window:
+//	-	the instances streamed in one draw give the same pixels as the 250 instance uniform batches
+//	-	the per instance color and the tint of the mesh reach the fragments
+//	-	a reserved frame never reallocates the buffer while it draws and the frames cycle its regions
+//build: g++ -O2 -std=c++14 -I. -I../C07_System -I../include Main.cpp ../C07_System/InstanceBuffer.cpp
+//       ../C07_System/GLState.cpp -lEGL -lGL -o C07_InstanceCheck
+//usage: C07_InstanceCheck [instances = 20000] [shader folder = ../_Binary/Shaders/]
+//       returns 0 if every check passed, run with LIBGL_ALWAYS_SOFTWARE=1 to force llvmpipe
+#include "InstanceBuffer.h"
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+const int g_nSize = 256; //width and height of the offscreen target
+uint g_uFailed = 0; //checks that did not pass
+
+//reports a check and counts it if it failed
+void Check(bool a_bPassed, const char* a_sName)
+{
+	printf("%-52s %s\n", a_sName, a_bPassed ? "ok" : "FAILED");
+	if (!a_bPassed)
+		++g_uFailed;
+}
+
+//makes a surfaceless 4.5 core context current and draws to an offscreen color and depth target
+bool CreateContext(void)
+{
+	PFNEGLGETPLATFORMDISPLAYEXTPROC pGetPlatformDisplay =
+		(PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+	if (pGetPlatformDisplay == nullptr)
+		return false;
+	EGLDisplay pDisplay = pGetPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+	EGLint nMajor = 0, nMinor = 0;
+	if (pDisplay == EGL_NO_DISPLAY || !eglInitialize(pDisplay, &nMajor, &nMinor))
+		return false;
+
+	EGLint nConfigAttributes[] = { EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE };
+	EGLConfig pConfig = nullptr;
+	EGLint nConfigs = 0;
+	if (!eglChooseConfig(pDisplay, nConfigAttributes, &pConfig, 1, &nConfigs) || nConfigs == 0)
+		return false;
+	eglBindAPI(EGL_OPENGL_API);
+
+	EGLint nContextAttributes[] = { EGL_CONTEXT_MAJOR_VERSION, 4, EGL_CONTEXT_MINOR_VERSION, 5,
+		EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT, EGL_NONE };
+	EGLContext pContext = eglCreateContext(pDisplay, pConfig, EGL_NO_CONTEXT, nContextAttributes);
+	if (pContext == EGL_NO_CONTEXT || !eglMakeCurrent(pDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, pContext))
+		return false;
+
+	//without a surface there is no default framebuffer
+	GLuint uFramebuffer = 0, uRenderbuffer[2] = { 0, 0 };
+	glGenFramebuffers(1, &uFramebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, uFramebuffer);
+	glGenRenderbuffers(2, uRenderbuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, uRenderbuffer[0]);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, g_nSize, g_nSize);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, uRenderbuffer[0]);
+	glBindRenderbuffer(GL_RENDERBUFFER, uRenderbuffer[1]);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, g_nSize, g_nSize);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, uRenderbuffer[1]);
+	glViewport(0, 0, g_nSize, g_nSize);
+	glEnable(GL_DEPTH_TEST);
+	return glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+}
+
+//compiles and links a vertex and fragment shader of the shader folder, 0 if they do not build
+GLuint LoadProgram(String a_sFolder, String a_sVertex, String a_sFragment)
+{
+	GLuint uProgram = glCreateProgram();
+	String sFile[2] = { a_sVertex, a_sFragment };
+	GLenum eType[2] = { GL_VERTEX_SHADER, GL_FRAGMENT_SHADER };
+	for (uint i = 0; i < 2; ++i)
+	{
+		std::ifstream file(a_sFolder + sFile[i]);
+		std::stringstream source;
+		source << file.rdbuf();
+		String sSource = source.str();
+		const char* sCode = sSource.c_str();
+
+		GLuint uShader = glCreateShader(eType[i]);
+		glShaderSource(uShader, 1, &sCode, nullptr);
+		glCompileShader(uShader);
+		GLint nCompiled = 0;
+		glGetShaderiv(uShader, GL_COMPILE_STATUS, &nCompiled);
+		if (!nCompiled || sSource.empty())
+		{
+			char sLog[1024] = "";
+			glGetShaderInfoLog(uShader, sizeof(sLog), nullptr, sLog);
+			printf("%s: %s\n", sFile[i].c_str(), sSource.empty() ? "not found" : sLog);
+			return 0;
+		}
+		glAttachShader(uProgram, uShader);
+		glDeleteShader(uShader);
+	}
+	glLinkProgram(uProgram);
+	GLint nLinked = 0;
+	glGetProgramiv(uProgram, GL_LINK_STATUS, &nLinked);
+	return nLinked ? uProgram : 0;
+}
+
+//clears the target before a draw
+void Clear(void)
+{
+	glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+}
+
+//reads back what was drawn
+std::vector<unsigned char> ReadPixels(void)
+{
+	std::vector<unsigned char> pixelList(g_nSize * g_nSize * 4);
+	glFinish();
+	glReadPixels(0, 0, g_nSize, g_nSize, GL_RGBA, GL_UNSIGNED_BYTE, pixelList.data());
+	return pixelList;
+}
+
+//was anything drawn (alpha set)?
+bool IsDrawn(const std::vector<unsigned char>& a_PixelList)
+{
+	for (size_t i = 3; i < a_PixelList.size(); i += 4)
+	{
+		if (a_PixelList[i] != 0)
+			return true;
+	}
+	return false;
+}
+
+//are all the pixels that were drawn (alpha set) of the given color? at least one has to be
+bool IsDrawnWith(const std::vector<unsigned char>& a_PixelList, unsigned char a_R, unsigned char a_G, unsigned char a_B)
+{
+	uint uDrawn = 0;
+	for (size_t i = 0; i < a_PixelList.size(); i += 4)
+	{
+		if (a_PixelList[i + 3] == 0)
+			continue;
+		++uDrawn;
+		if (a_PixelList[i] != a_R || a_PixelList[i + 1] != a_G || a_PixelList[i + 2] != a_B)
+			return false;
+	}
+	return uDrawn > 0;
+}
+
+int main(int argc, char* argv[])
+{
+	uint uInstances = argc > 1 ? static_cast<uint>(atoi(argv[1])) : 20000;
+	String sFolder = argc > 2 ? argv[2] : "../_Binary/Shaders/";
+	if (uInstances == 0)
+		uInstances = 1;
+
+	if (!CreateContext())
+	{
+		printf("Could not create an offscreen OpenGL 4.5 core context through EGL\n");
+		return 1;
+	}
+	printf("Renderer:  %s\nInstances: %u\n\n", glGetString(GL_RENDERER), uInstances);
+
+	InstanceBuffer* pInstanceBuffer = InstanceBuffer::GetInstance();
+	Check(pInstanceBuffer->IsSupported(), "buffer storage is available");
+	if (!pInstanceBuffer->IsSupported())
+		return 1;
+
+	//the uniform path and the streamed variants of the programs the meshes use
+	GLuint uUniform = LoadProgram(sFolder, "Basic-Instanced.vs", "BasicColor.fs");
+	GLuint uStreamed = LoadProgram(sFolder, "Basic-InstancedVBO.vs", "BasicColor.fs");
+	Check(uUniform > 0 && uStreamed > 0, "BasicColor and BasicColor_VBO build");
+	Check(LoadProgram(sFolder, "Simplex-InstancedVBO.vs", "Simplex.fs") > 0, "Simplex_VBO builds");
+	Check(LoadProgram(sFolder, "Simplex-InstancedVBO.vs", "Wireframe.fs") > 0, "Wireframe_VBO builds");
+	if (uUniform == 0 || uStreamed == 0)
+		return 1;
+
+	//a triangle with a different vertex color on each corner, laid out as the meshes lay out position and color
+	float fVertex[] = {
+		-0.5f, -0.5f, 0.0f, 1.0f, 0.0f, 0.0f,
+		0.5f, -0.5f, 0.0f, 0.0f, 1.0f, 0.0f,
+		0.0f, 0.5f, 0.0f, 0.0f, 0.0f, 1.0f };
+	GLuint uVAO = 0, uVBO = 0;
+	glGenVertexArrays(1, &uVAO);
+	glGenBuffers(1, &uVBO);
+	glBindVertexArray(uVAO);
+	//through the state cache, the instance buffer binds its own buffer through it too
+	GLState::GetInstance()->BindArrayBuffer(uVBO);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(fVertex), fVertex, GL_STATIC_DRAW);
+	for (GLuint i = 0; i < 2; ++i)
+	{
+		glEnableVertexAttribArray(i);
+		glVertexAttribPointer(i, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (GLvoid*)(i * 3 * sizeof(float)));
+	}
+
+	//small triangles scattered over the target, the same every run
+	std::vector<matrix4> m4InstanceList(uInstances);
+	std::mt19937 generator(1);
+	std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+	for (uint i = 0; i < uInstances; ++i)
+	{
+		vector3 v3Position(distribution(generator), distribution(generator), distribution(generator) * 0.5f);
+		m4InstanceList[i] = glm::translate(v3Position) * glm::scale(vector3(0.05f));
+	}
+	float* fMatrixArray = glm::value_ptr(m4InstanceList[0]);
+	matrix4 m4VP = IDENTITY_M4;
+
+	//uniform path, 250 instances per draw as Mesh::RenderSolid does without buffer storage
+	Clear();
+	glUseProgram(uUniform);
+	glUniformMatrix4fv(glGetUniformLocation(uUniform, "VP"), 1, GL_FALSE, glm::value_ptr(m4VP));
+	GLint nToWorld = glGetUniformLocation(uUniform, "m4ToWorld");
+	uint uUniformDraws = 0;
+	for (uint uStart = 0; uStart < uInstances; uStart += 250)
+	{
+		uint uCount = std::min(250u, uInstances - uStart);
+		glUniformMatrix4fv(nToWorld, uCount, GL_FALSE, &fMatrixArray[uStart * 16]);
+		glDrawArraysInstanced(GL_TRIANGLES, 0, 3, uCount);
+		++uUniformDraws;
+	}
+	std::vector<unsigned char> uniformPixelList = ReadPixels();
+
+	//streamed path, the whole frame reserved first and every instance in a single draw
+	glUseProgram(uStreamed);
+	glUniformMatrix4fv(glGetUniformLocation(uStreamed, "VP"), 1, GL_FALSE, glm::value_ptr(m4VP));
+	auto DrawStreamed = [&](vector4* a_v4ColorArray, vector4 a_v4Tint)
+	{
+		Clear();
+		pInstanceBuffer->Reserve(uInstances);
+		int nFirst = pInstanceBuffer->Stream(fMatrixArray, a_v4ColorArray, uInstances, a_v4Tint);
+		if (nFirst >= 0)
+		{
+			pInstanceBuffer->BindAttributes(nFirst);
+			glDrawArraysInstanced(GL_TRIANGLES, 0, 3, uInstances);
+		}
+		std::vector<unsigned char> pixelList = ReadPixels();
+		pInstanceBuffer->NextFrame();
+		return pixelList;
+	};
+	std::vector<unsigned char> streamedPixelList = DrawStreamed(nullptr, vector4(0.0f));
+	printf("uniform path: %u draws, streamed path: 1 draw\n", uUniformDraws);
+	Check(IsDrawn(streamedPixelList) && streamedPixelList == uniformPixelList,
+		"one streamed draw matches the uniform batches");
+
+	//a color per instance replaces the vertex colors, the tint of the mesh replaces both
+	std::vector<vector4> v4ColorList(uInstances, vector4(1.0f, 0.0f, 0.0f, 1.0f));
+	Check(IsDrawnWith(DrawStreamed(v4ColorList.data(), vector4(0.0f)), 255, 0, 0), "the instance color reaches the fragments");
+	Check(IsDrawnWith(DrawStreamed(v4ColorList.data(), vector4(0.0f, 1.0f, 0.0f, 1.0f)), 0, 255, 0), "the tint overrides the instance color");
+
+	//a frame twice as big as the buffer: it grows once when reserved, then every frame writes where its region starts
+	uint uNeeded = pInstanceBuffer->GetCapacity() + uInstances;
+	bool bRing = true;
+	uint uCapacity = 0;
+	for (uint uFrame = 0; uFrame < 6; ++uFrame)
+	{
+		pInstanceBuffer->Reserve(uNeeded);
+		if (uFrame == 0)
+			uCapacity = pInstanceBuffer->GetCapacity();
+		uint uRegionStart = (uFrame % 3) * uCapacity;
+		int nFirst = pInstanceBuffer->Stream(fMatrixArray, nullptr, uInstances, vector4(0.0f));
+		int nSecond = pInstanceBuffer->Stream(fMatrixArray, nullptr, std::min(uInstances, uNeeded - uInstances), vector4(0.0f));
+		bRing = bRing && pInstanceBuffer->GetCapacity() == uCapacity && uCapacity >= uNeeded &&
+			nFirst == static_cast<int>(uRegionStart) && nSecond == static_cast<int>(uRegionStart + uInstances);
+		pInstanceBuffer->BindAttributes(nFirst);
+		glDrawArraysInstanced(GL_TRIANGLES, 0, 3, uInstances);
+		pInstanceBuffer->NextFrame();
+	}
+	Check(bRing, "a reserved frame does not reallocate and regions cycle");
+
+	InstanceBuffer::ReleaseInstance();
+	Check(glGetError() == GL_NO_ERROR, "no OpenGL errors");
+
+	printf("\n%s\n", g_uFailed == 0 ? "All checks passed" : "Some checks FAILED");
+	return g_uFailed == 0 ? 0 : 1;
+}
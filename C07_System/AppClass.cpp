@@ -254,6 +254,12 @@ void AppClass::Display(void)
 	//Bind the VAO for the triangle
 	glBindVertexArray(0);
 	
+	//State changes of the previous frame
+	GLState* pState = GLState::GetInstance();
+	uint uIssued = pState->GetIssuedCount();
+	uint uFiltered = pState->GetFilteredCount();
+	m_pMeshMngr->Printf(C_WHITE, "GL state: %u issued, %u filtered\n", uIssued, uFiltered);
+
 	//Display render list
 	m_pMeshMngr->Render();
 
@@ -6,7 +6,9 @@ Date: 2017/05
 #define __BASICXDEFINITIONS_H_
 
 // Include standard headers
+#ifdef _WIN32
 #include <Windows.h>
+#endif
 #include <iostream>
 #include <stdio.h>
 #include <stdlib.h>
@@ -26,12 +28,12 @@ Date: 2017/05
 #include <set>
 
 // Include GLM
-#include <glm\glm.hpp>
-#include <glm\gtc\matrix_transform.hpp>
-#include <glm\gtc\type_ptr.hpp>
-#include <glm\gtx\transform.hpp>
-#include <glm\ext.hpp>
-#include <glm\gtc\quaternion.hpp>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <glm/gtx/transform.hpp>
+#include <glm/ext.hpp>
+#include <glm/gtc/quaternion.hpp>
 
 typedef unsigned int uint;
 typedef std::string String;
@@ -136,6 +138,50 @@ enum BTO_RENDER
 	RENDER_SOLID = 1,
 	RENDER_WIRE = 2,
 };
+enum BTO_UNIFORM
+{
+	//Uniforms the engine sets every draw, resolved once per program when it is linked
+	UNIFORM_VP = 0, //VP
+	UNIFORM_MVP, //MVP
+	UNIFORM_MODELTOWORLD, //m4ModelToWorld
+	UNIFORM_TOWORLD, //m4ToWorld
+	UNIFORM_CAMERAONWORLD, //m4CameraOnWorld
+	UNIFORM_TEXTURE, //TextureID
+	UNIFORM_NORMALMAP, //NormalID
+	UNIFORM_SPECULARMAP, //SpecularID
+	UNIFORM_TEXTURECOUNT, //nTexture
+	UNIFORM_LIGHTPOSITION, //LightPosition_W
+	UNIFORM_LIGHTCOLOR, //LightColor
+	UNIFORM_LIGHTPOWER, //LightPower
+	UNIFORM_AMBIENTCOLOR, //AmbientColor
+	UNIFORM_AMBIENTPOWER, //AmbientPower
+	UNIFORM_TINT, //Tint
+	UNIFORM_CAMERAPOSITION, //CameraPosition_W
+	UNIFORM_ELEMENTS, //nElements
+	UNIFORM_WIREFRAME, //vWireframe
+	UNIFORM_SOLIDCOLOR, //SolidColor
+	UNIFORM_COUNT,
+};
+enum BTO_ATTRIBUTE
+{
+	//Vertex attributes, resolved once per program when it is linked
+	ATTRIBUTE_POSITION = 0, //Position_b
+	ATTRIBUTE_COLOR, //Color_b
+	ATTRIBUTE_UV, //UV_b
+	ATTRIBUTE_NORMAL, //Normal_b
+	ATTRIBUTE_BINORMAL, //Binormal_b
+	ATTRIBUTE_TANGENT, //Tangent_b
+	ATTRIBUTE_COUNT,
+};
+enum BTO_VERTEXFORMAT
+{
+	//Encoding of the vertex buffer of a mesh, flags can be combined
+	VERTEXFORMAT_FLOAT = 0, //every attribute as three floats (72 bytes per vertex)
+	VERTEXFORMAT_HALF_UV = 1, //UV as two half floats
+	VERTEXFORMAT_BYTE_COLOR = 2, //color as four normalized bytes
+	VERTEXFORMAT_PACKED_NORMAL = 4, //normal, binormal and tangent as normalized 10_10_10_2 integers
+	VERTEXFORMAT_COMPACT = 7, //all of the above (32 bytes per vertex)
+};
 enum BTO_CAMERAMODE
 {
 	CAM_PERSP = 0,
@@ -0,0 +1,123 @@
+#include "GLState.h"
+//  GLState
+GLState* GLState::m_pInstance = nullptr;
+GLState* GLState::GetInstance(void)
+{
+	if (m_pInstance == nullptr)
+	{
+		m_pInstance = new GLState();
+	}
+	return m_pInstance;
+}
+void GLState::ReleaseInstance(void)
+{
+	if (m_pInstance != nullptr)
+	{
+		delete m_pInstance;
+		m_pInstance = nullptr;
+	}
+}
+//The big 3
+GLState::GLState(void) { Invalidate(); }
+GLState::GLState(GLState const& other) { }
+GLState& GLState::operator=(GLState const& other) { return *this; }
+GLState::~GLState(void) { }
+//Accessors
+uint GLState::GetIssuedCount(void) { return m_uLastIssued; }
+uint GLState::GetFilteredCount(void) { return m_uLastFiltered; }
+//Methods
+void GLState::Invalidate(void)
+{
+	m_uProgram = m_uUnknown;
+	m_uVertexArray = m_uUnknown;
+	m_uArrayBuffer = m_uUnknown;
+	m_uActiveTexture = m_uUnknown;
+	for (uint i = 0; i < m_uTextureUnits; ++i)
+		m_uTexture[i] = m_uUnknown;
+	m_uPolygonMode = m_uUnknown;
+	m_uPolygonOffsetLine = m_uUnknown;
+	m_bPolygonOffset = false;
+}
+void GLState::NextFrame(void)
+{
+	m_uLastIssued = m_uIssued;
+	m_uLastFiltered = m_uFiltered;
+	m_uIssued = 0;
+	m_uFiltered = 0;
+	Invalidate();
+}
+bool GLState::Change(GLuint& a_uCached, GLuint a_uValue)
+{
+	if (a_uCached == a_uValue)
+	{
+		++m_uFiltered;
+		return false;
+	}
+	a_uCached = a_uValue;
+	++m_uIssued;
+	return true;
+}
+void GLState::UseProgram(GLuint a_uProgram)
+{
+	if (Change(m_uProgram, a_uProgram))
+		glUseProgram(a_uProgram);
+}
+void GLState::BindVertexArray(GLuint a_uVertexArray)
+{
+	if (Change(m_uVertexArray, a_uVertexArray))
+		glBindVertexArray(a_uVertexArray);
+}
+void GLState::BindArrayBuffer(GLuint a_uBuffer)
+{
+	if (Change(m_uArrayBuffer, a_uBuffer))
+		glBindBuffer(GL_ARRAY_BUFFER, a_uBuffer);
+}
+void GLState::BindTexture(GLuint a_uUnit, GLuint a_uTexture)
+{
+	//units past the tracked ones are always issued
+	if (a_uUnit >= m_uTextureUnits)
+	{
+		m_uActiveTexture = a_uUnit;
+		glActiveTexture(GL_TEXTURE0 + a_uUnit);
+		glBindTexture(GL_TEXTURE_2D, a_uTexture);
+		m_uIssued += 2;
+		return;
+	}
+	if (m_uTexture[a_uUnit] == a_uTexture)
+	{
+		++m_uFiltered;
+		return;
+	}
+	if (Change(m_uActiveTexture, a_uUnit))
+		glActiveTexture(GL_TEXTURE0 + a_uUnit);
+	Change(m_uTexture[a_uUnit], a_uTexture);
+	glBindTexture(GL_TEXTURE_2D, a_uTexture);
+}
+void GLState::PolygonMode(GLenum a_eMode)
+{
+	if (Change(m_uPolygonMode, a_eMode))
+		glPolygonMode(GL_FRONT_AND_BACK, a_eMode);
+}
+void GLState::PolygonOffsetLine(bool a_bEnable, float a_fFactor, float a_fUnits)
+{
+	if (Change(m_uPolygonOffsetLine, a_bEnable ? 1 : 0))
+	{
+		if (a_bEnable)
+			glEnable(GL_POLYGON_OFFSET_LINE);
+		else
+			glDisable(GL_POLYGON_OFFSET_LINE);
+	}
+	if (!a_bEnable)
+		return;
+
+	vector2 v2Offset(a_fFactor, a_fUnits);
+	if (m_bPolygonOffset && m_v2PolygonOffset == v2Offset)
+	{
+		++m_uFiltered;
+		return;
+	}
+	m_bPolygonOffset = true;
+	m_v2PolygonOffset = v2Offset;
+	glPolygonOffset(a_fFactor, a_fUnits);
+	++m_uIssued;
+}
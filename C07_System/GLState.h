@@ -0,0 +1,149 @@
+/*----------------------------------------------
+Programmer: Alberto Bobadilla (labigm@gmail.com)
+Date: 2017/05
+----------------------------------------------*/
+#ifndef __GLSTATE_H_
+#define __GLSTATE_H_
+
+#include "Definitions.h"
+#include <GL/glew.h>
+
+//Cache of the OpenGL state set by the engine, calls that would not change anything are not issued
+class GLState
+{
+	static GLState* m_pInstance; // Singleton pointer
+	static const uint m_uTextureUnits = 8; //texture units tracked
+	static const GLuint m_uUnknown = 0xFFFFFFFF; //the cached value does not match the context
+
+	GLuint m_uProgram = m_uUnknown; //program in use
+	GLuint m_uVertexArray = m_uUnknown; //bound vertex array object
+	GLuint m_uArrayBuffer = m_uUnknown; //buffer bound to GL_ARRAY_BUFFER
+	GLuint m_uActiveTexture = m_uUnknown; //active texture unit (0 based)
+	GLuint m_uTexture[m_uTextureUnits]; //GL_TEXTURE_2D bound to each unit
+	GLuint m_uPolygonMode = m_uUnknown; //polygon mode of front and back faces
+	GLuint m_uPolygonOffsetLine = m_uUnknown; //GL_POLYGON_OFFSET_LINE enabled (0/1)
+	vector2 m_v2PolygonOffset = vector2(0.0f); //factor and units of the polygon offset
+	bool m_bPolygonOffset = false; //is m_v2PolygonOffset known
+
+	uint m_uIssued = 0; //calls sent to OpenGL this frame
+	uint m_uFiltered = 0; //calls filtered this frame
+	uint m_uLastIssued = 0; //calls sent to OpenGL the previous frame
+	uint m_uLastFiltered = 0; //calls filtered the previous frame
+
+public:
+	/*
+	USAGE: Gets/Constructs the singleton pointer
+	ARGUMENTS: ---
+	OUTPUT: singleton pointer
+	*/
+	static GLState* GetInstance(void);
+	/*
+	USAGE: Destroys the singleton
+	ARGUMENTS: ---
+	OUTPUT: ---
+	*/
+	static void ReleaseInstance(void);
+	/*
+	USAGE: Forgets the cached state, call it after OpenGL was used without the cache
+	or after deleting an object that could be bound
+	ARGUMENTS: ---
+	OUTPUT: ---
+	*/
+	void Invalidate(void);
+	/*
+	USAGE: Stores the counts of this frame as the previous frame counts and starts a
+	new frame, the cache is invalidated as the application can change the state between frames
+	ARGUMENTS: ---
+	OUTPUT: ---
+	*/
+	void NextFrame(void);
+	/*
+	USAGE: glUseProgram
+	ARGUMENTS: GLuint a_uProgram -> program to use
+	OUTPUT: ---
+	*/
+	void UseProgram(GLuint a_uProgram);
+	/*
+	USAGE: glBindVertexArray
+	ARGUMENTS: GLuint a_uVertexArray -> vertex array object to bind
+	OUTPUT: ---
+	*/
+	void BindVertexArray(GLuint a_uVertexArray);
+	/*
+	USAGE: glBindBuffer(GL_ARRAY_BUFFER, ...)
+	ARGUMENTS: GLuint a_uBuffer -> buffer to bind
+	OUTPUT: ---
+	*/
+	void BindArrayBuffer(GLuint a_uBuffer);
+	/*
+	USAGE: glActiveTexture and glBindTexture(GL_TEXTURE_2D, ...)
+	ARGUMENTS:
+	-	GLuint a_uUnit -> texture unit (0 based)
+	-	GLuint a_uTexture -> texture to bind
+	OUTPUT: ---
+	*/
+	void BindTexture(GLuint a_uUnit, GLuint a_uTexture);
+	/*
+	USAGE: glPolygonMode(GL_FRONT_AND_BACK, ...)
+	ARGUMENTS: GLenum a_eMode -> GL_FILL, GL_LINE or GL_POINT
+	OUTPUT: ---
+	*/
+	void PolygonMode(GLenum a_eMode);
+	/*
+	USAGE: glEnable/glDisable(GL_POLYGON_OFFSET_LINE) and glPolygonOffset when enabling
+	ARGUMENTS:
+	-	bool a_bEnable -> enable the offset?
+	-	float a_fFactor = -1.0f -> glPolygonOffset factor
+	-	float a_fUnits = -1.0f -> glPolygonOffset units
+	OUTPUT: ---
+	*/
+	void PolygonOffsetLine(bool a_bEnable, float a_fFactor = -1.0f, float a_fUnits = -1.0f);
+	/*
+	USAGE: Number of calls sent to OpenGL in the previous frame
+	ARGUMENTS: ---
+	OUTPUT: issued calls
+	*/
+	uint GetIssuedCount(void);
+	/*
+	USAGE: Number of calls filtered in the previous frame
+	ARGUMENTS: ---
+	OUTPUT: filtered calls
+	*/
+	uint GetFilteredCount(void);
+
+private:
+	/*
+	USAGE: Constructor
+	ARGUMENTS: ---
+	OUTPUT: class object
+	*/
+	GLState(void);
+	/*
+	USAGE: Copy Constructor
+	ARGUMENTS: class object to copy
+	OUTPUT: class object instance
+	*/
+	GLState(GLState const& other);
+	/*
+	USAGE: Copy Assignment Operator
+	ARGUMENTS: class object to copy
+	OUTPUT: ---
+	*/
+	GLState& operator=(GLState const& other);
+	/*
+	USAGE: Destructor
+	ARGUMENTS: ---
+	OUTPUT: ---
+	*/
+	~GLState(void);
+	/*
+	USAGE: Counts a filtered or issued call, returns whether it needs to be issued
+	ARGUMENTS:
+	-	GLuint& a_uCached -> cached value, updated if different
+	-	GLuint a_uValue -> requested value
+	OUTPUT: true if the call has to be sent to OpenGL
+	*/
+	bool Change(GLuint& a_uCached, GLuint a_uValue);
+};
+
+#endif //__GLSTATE_H_
@@ -0,0 +1,165 @@
+#include "InstanceBuffer.h"
+//  InstanceBuffer
+InstanceBuffer* InstanceBuffer::m_pInstance = nullptr;
+void InstanceBuffer::Init(void)
+{
+	m_bSupported = (GLEW_ARB_buffer_storage != 0);
+	m_VBO = 0;
+	m_pData = nullptr;
+	m_uCapacity = 0;
+	m_uRegion = 0;
+	m_uUsed = 0;
+	for (uint i = 0; i < m_uRegionCount; ++i)
+		m_pFence[i] = nullptr;
+	if (m_bSupported)
+		Allocate(1024);
+}
+void InstanceBuffer::Release(void)
+{
+	for (uint i = 0; i < m_uRegionCount; ++i)
+	{
+		if (m_pFence[i])
+		{
+			glDeleteSync(m_pFence[i]);
+			m_pFence[i] = nullptr;
+		}
+	}
+	if (m_VBO > 0)
+	{
+		GLState* pState = GLState::GetInstance();
+		pState->BindArrayBuffer(m_VBO);
+		glUnmapBuffer(GL_ARRAY_BUFFER);
+		pState->BindArrayBuffer(0);
+		glDeleteBuffers(1, &m_VBO);
+		m_VBO = 0;
+	}
+	m_pData = nullptr;
+	m_uCapacity = 0;
+	m_uUsed = 0;
+}
+InstanceBuffer* InstanceBuffer::GetInstance(void)
+{
+	if (m_pInstance == nullptr)
+	{
+		m_pInstance = new InstanceBuffer();
+	}
+	return m_pInstance;
+}
+void InstanceBuffer::ReleaseInstance(void)
+{
+	if (m_pInstance != nullptr)
+	{
+		delete m_pInstance;
+		m_pInstance = nullptr;
+	}
+}
+//The big 3
+InstanceBuffer::InstanceBuffer(void) { Init(); }
+InstanceBuffer::InstanceBuffer(InstanceBuffer const& other) { }
+InstanceBuffer& InstanceBuffer::operator=(InstanceBuffer const& other) { return *this; }
+InstanceBuffer::~InstanceBuffer(void) { Release(); }
+//Accessors
+bool InstanceBuffer::IsSupported(void) { return m_bSupported; }
+uint InstanceBuffer::GetCapacity(void) { return m_uCapacity; }
+GLuint InstanceBuffer::GetVBO(void) { return m_VBO; }
+//Methods
+void InstanceBuffer::WaitRegion(uint a_uRegion)
+{
+	GLsync pFence = m_pFence[a_uRegion];
+	if (pFence == nullptr)
+		return;
+	//flush once so the fence is guaranteed to signal, then keep waiting
+	GLbitfield uFlags = GL_SYNC_FLUSH_COMMANDS_BIT;
+	while (true)
+	{
+		GLenum eResult = glClientWaitSync(pFence, uFlags, 1000000);
+		if (eResult == GL_ALREADY_SIGNALED || eResult == GL_CONDITION_SATISFIED || eResult == GL_WAIT_FAILED)
+			break;
+		uFlags = 0;
+	}
+	glDeleteSync(pFence);
+	m_pFence[a_uRegion] = nullptr;
+}
+void InstanceBuffer::Allocate(uint a_uCapacity)
+{
+	//the old buffer can still be read by draws already issued, GL keeps it alive until they are done
+	Release();
+
+	m_uCapacity = a_uCapacity;
+	m_uRegion = 0;
+	m_uUsed = 0;
+
+	GLsizeiptr uSize = static_cast<GLsizeiptr>(m_uCapacity) * m_uRegionCount * sizeof(InstanceData);
+	GLbitfield uFlags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	GLState* pState = GLState::GetInstance();
+	glGenBuffers(1, &m_VBO);
+	pState->BindArrayBuffer(m_VBO);
+	glBufferStorage(GL_ARRAY_BUFFER, uSize, nullptr, uFlags);
+	m_pData = static_cast<InstanceData*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, uSize, uFlags));
+
+	//could not map the storage, let the meshes use the uniform path
+	if (m_pData == nullptr)
+	{
+		Release();
+		m_bSupported = false;
+	}
+}
+void InstanceBuffer::Reserve(uint a_uCount)
+{
+	if (!m_bSupported || m_uUsed + a_uCount <= m_uCapacity)
+		return;
+
+	uint uCapacity = m_uCapacity * 2;
+	if (uCapacity < m_uUsed + a_uCount)
+		uCapacity = m_uUsed + a_uCount;
+	Allocate(uCapacity);
+}
+int InstanceBuffer::Stream(float* a_fMatrixArray, vector4* a_v4ColorArray, uint a_uCount, vector4 a_v4Tint)
+{
+	if (!m_bSupported || a_fMatrixArray == nullptr || a_uCount == 0)
+		return -1;
+
+	//only happens if the frame was not reserved
+	Reserve(a_uCount);
+	if (!m_bSupported)
+		return -1;
+
+	uint uFirst = m_uRegion * m_uCapacity + m_uUsed;
+	InstanceData* pTarget = m_pData + uFirst;
+	for (uint i = 0; i < a_uCount; ++i)
+	{
+		memcpy(&pTarget[i].m_m4ToWorld, &a_fMatrixArray[i * 16], 16 * sizeof(float));
+		pTarget[i].m_v4Tint = a_v4Tint;
+		pTarget[i].m_v4Color = a_v4ColorArray ? a_v4ColorArray[i] : vector4(0.0f);
+	}
+	m_uUsed += a_uCount;
+	return static_cast<int>(uFirst);
+}
+void InstanceBuffer::BindAttributes(uint a_uFirst)
+{
+	GLState::GetInstance()->BindArrayBuffer(m_VBO);
+	size_t uOffset = a_uFirst * sizeof(InstanceData);
+	for (GLuint i = 0; i < m_uAttributeCount; ++i)
+	{
+		GLuint uAttribute = m_uFirstAttribute + i;
+		glEnableVertexAttribArray(uAttribute);
+		glVertexAttribPointer(uAttribute, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (GLvoid*)(uOffset + i * sizeof(vector4)));
+		glVertexAttribDivisor(uAttribute, 1);
+	}
+}
+void InstanceBuffer::NextFrame(void)
+{
+	if (!m_bSupported)
+		return;
+
+	if (m_uUsed > 0)
+	{
+		if (m_pFence[m_uRegion])
+			glDeleteSync(m_pFence[m_uRegion]);
+		m_pFence[m_uRegion] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	}
+
+	m_uRegion = (m_uRegion + 1) % m_uRegionCount;
+	m_uUsed = 0;
+	WaitRegion(m_uRegion);
+}
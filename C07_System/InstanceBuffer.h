@@ -0,0 +1,155 @@
+/*----------------------------------------------
+Programmer: Alberto Bobadilla (labigm@gmail.com)
+Date: 2017/05
+----------------------------------------------*/
+#ifndef __INSTANCEBUFFER_H_
+#define __INSTANCEBUFFER_H_
+
+#include "Definitions.h"
+#include "GLState.h"
+
+//Per instance information read by the *-InstancedVBO.vs shaders
+struct InstanceData
+{
+	matrix4 m_m4ToWorld; //model to world matrix (attributes 6 to 9, one per column)
+	vector4 m_v4Tint; //rgb tint color of the mesh, alpha is how much of it replaces the color (attribute 10)
+	vector4 m_v4Color; //rgb color of the instance, alpha is how much of it replaces the vertex color (attribute 11)
+};
+
+//Persistently mapped, triple buffered stream of per instance data shared by all meshes
+class InstanceBuffer
+{
+	static InstanceBuffer* m_pInstance; // Singleton pointer
+	static const uint m_uRegionCount = 3; //regions in the ring, the GPU reads one while the CPU writes another
+
+	bool m_bSupported = false; //whether GL_ARB_buffer_storage is available
+	GLuint m_VBO = 0; //OpenGL buffer holding all regions
+	InstanceData* m_pData = nullptr; //persistent mapping of the whole buffer
+	uint m_uCapacity = 0; //instances per region
+	uint m_uRegion = 0; //region being written this frame
+	uint m_uUsed = 0; //instances already written in the current region
+	GLsync m_pFence[m_uRegionCount]; //fence placed after the last draw that read each region
+
+public:
+	static const GLuint m_uFirstAttribute = 6; //first attribute location used by the instance data
+	static const GLuint m_uAttributeCount = 6; //vec4 attributes of the instance data
+	/*
+	USAGE: Gets/Constructs the singleton pointer
+	ARGUMENTS: ---
+	OUTPUT: singleton pointer
+	*/
+	static InstanceBuffer* GetInstance(void);
+	/*
+	USAGE: Destroys the singleton
+	ARGUMENTS: ---
+	OUTPUT: ---
+	*/
+	static void ReleaseInstance(void);
+	/*
+	USAGE: Asks if the context can persistently map buffers, if not the meshes
+	should use the uniform array path instead
+	ARGUMENTS: ---
+	OUTPUT: is the path supported?
+	*/
+	bool IsSupported(void);
+	/*
+	USAGE: Makes each region fit the instances of a frame, call before the first Stream of the frame so
+	the buffer is never reallocated while the frame draws from it
+	ARGUMENTS:
+	-	uint a_uCount -> instances the frame will stream
+	OUTPUT: ---
+	*/
+	void Reserve(uint a_uCount);
+	/*
+	USAGE: Copies the instances into the current region, growing the buffer if they do not fit (which
+	restarts the ring, Reserve the frame first to avoid it)
+	ARGUMENTS:
+	-	float* a_fMatrixArray -> array of a_uCount column major 4x4 matrices
+	-	vector4* a_v4ColorArray -> color of each instance, nullptr to keep the vertex colors
+	-	uint a_uCount -> number of instances
+	-	vector4 a_v4Tint -> tint applied to all the instances
+	OUTPUT: index of the first written instance in the buffer, -1 if nothing was written
+	*/
+	int Stream(float* a_fMatrixArray, vector4* a_v4ColorArray, uint a_uCount, vector4 a_v4Tint);
+	/*
+	USAGE: Points the instance attributes of the bound VAO to the streamed data
+	ARGUMENTS:
+	-	uint a_uFirst -> index returned by Stream
+	OUTPUT: ---
+	*/
+	void BindAttributes(uint a_uFirst);
+	/*
+	USAGE: Fences the region written this frame and moves to the next one, waiting
+	for the GPU to be done reading it if needed, call once per frame after rendering
+	ARGUMENTS: ---
+	OUTPUT: ---
+	*/
+	void NextFrame(void);
+	/*
+	USAGE: Returns the number of instances that fit in each region
+	ARGUMENTS: ---
+	OUTPUT: capacity of a region
+	*/
+	uint GetCapacity(void);
+	/*
+	USAGE: Returns the OpenGL buffer
+	ARGUMENTS: ---
+	OUTPUT: VBO
+	*/
+	GLuint GetVBO(void);
+
+private:
+	/*
+	USAGE: Constructor
+	ARGUMENTS: ---
+	OUTPUT: class object
+	*/
+	InstanceBuffer(void);
+	/*
+	USAGE: Copy Constructor
+	ARGUMENTS: class object to copy
+	OUTPUT: class object instance
+	*/
+	InstanceBuffer(InstanceBuffer const& other);
+	/*
+	USAGE: Copy Assignment Operator
+	ARGUMENTS: class object to copy
+	OUTPUT: ---
+	*/
+	InstanceBuffer& operator=(InstanceBuffer const& other);
+	/*
+	USAGE: Destructor
+	ARGUMENTS: ---
+	OUTPUT: ---
+	*/
+	~InstanceBuffer(void);
+	/*
+	USAGE: Deallocates member fields
+	ARGUMENTS: ---
+	OUTPUT: ---
+	*/
+	void Release(void);
+	/*
+	USAGE: Allocates member fields
+	ARGUMENTS: ---
+	OUTPUT: ---
+	*/
+	void Init(void);
+	/*
+	USAGE: Waits until the GPU is done with the specified region
+	ARGUMENTS:
+	-	uint a_uRegion -> region to wait for
+	OUTPUT: ---
+	*/
+	void WaitRegion(uint a_uRegion);
+	/*
+	USAGE: Reallocates the buffer so each region fits at least the specified instances,
+	the current frame restarts on the first region of the new buffer
+	ARGUMENTS:
+	-	uint a_uCapacity -> minimum instances per region
+	OUTPUT: ---
+	*/
+	void Allocate(uint a_uCapacity);
+};
+
+#endif //__INSTANCEBUFFER_H_
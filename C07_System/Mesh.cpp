@@ -11,10 +11,18 @@ void Mesh::Init(void)
 	m_pOriginal = nullptr;
 	m_bBinded = false;
 	m_uVertexCount = 0;
+	m_uIndexCount = 0;
+	m_uLODCount = 1;
+	m_uLODFirst[0] = 0;
+	m_uLODIndexCount[0] = 0;
+	m_fRadius = 0.0f;
 	m_uMaterialIndex = -1;
 	
 	m_VAO = 0;
 	m_VBO = 0;
+	m_EBO = 0;
+	m_eIndexType = GL_UNSIGNED_INT;
+	m_nVertexFormat = VERTEXFORMAT_COMPACT;
 
 	m_v3Tint = DEFAULT_V3NEG;
 
@@ -24,21 +32,32 @@ void Mesh::Init(void)
 	m_pShaderMngr = ShaderManager::GetInstance();
 	m_pLightMngr = LightManager::GetInstance();
 	m_nShader = m_pShaderMngr->GetShaderID("BasicX");
+	m_nShaderWire = m_pShaderMngr->GetShaderID("Wireframe");
 }
 void Mesh::Swap(Mesh& other)
 {
 	std::swap(m_bBinded, other.m_bBinded);
 	std::swap(m_pOriginal, other.m_pOriginal);
 	std::swap(m_uVertexCount, other.m_uVertexCount);
+	std::swap(m_uIndexCount, other.m_uIndexCount);
+	std::swap(m_uLODCount, other.m_uLODCount);
+	std::swap(m_uLODFirst, other.m_uLODFirst);
+	std::swap(m_uLODIndexCount, other.m_uLODIndexCount);
+	std::swap(m_fRadius, other.m_fRadius);
 	std::swap(m_uMaterialIndex, other.m_uMaterialIndex);
 
 	std::swap(m_v3Tint, other.m_v3Tint);
 
 	std::swap(m_VAO, other.m_VAO);
 	std::swap(m_VBO, other.m_VBO);
+	std::swap(m_EBO, other.m_EBO);
+	std::swap(m_eIndexType, other.m_eIndexType);
+	std::swap(m_nVertexFormat, other.m_nVertexFormat);
 	std::swap(m_nShader, other.m_nShader);
+	std::swap(m_nShaderWire, other.m_nShaderWire);
 
 	std::swap(m_lVertex, other.m_lVertex);
+	std::swap(m_lIndex, other.m_lIndex);
 	std::swap(m_lVertexPos, other.m_lVertexPos);
 	std::swap(m_lVertexCol, other.m_lVertexCol);
 	std::swap(m_lVertexNor, other.m_lVertexNor);
@@ -64,10 +83,18 @@ void Mesh::Release(void)
 	if (m_VBO > 0)
 		glDeleteBuffers(1, &m_VBO);
 
+	if (m_EBO > 0)
+		glDeleteBuffers(1, &m_EBO);
+
 	if(m_VAO > 0 )
 		glDeleteVertexArrays(1, &m_VAO);
+
+	//the deleted names could be cached as bound and reused by new objects
+	if (m_VAO > 0 || m_VBO > 0)
+		GLState::GetInstance()->Invalidate();
 	
 	m_lVertex.clear();
+	m_lIndex.clear();
 	m_lVertexPos.clear();
 	m_lVertexCol.clear();
 	m_lVertexNor.clear();
@@ -95,11 +122,20 @@ Mesh::Mesh(Mesh& other)
 
 	m_uMaterialIndex = other.m_uMaterialIndex;
 	m_uVertexCount = other.m_uVertexCount;
+	m_uIndexCount = other.m_uIndexCount;
+	m_uLODCount = other.m_uLODCount;
+	std::copy(other.m_uLODFirst, other.m_uLODFirst + m_uLODMax, m_uLODFirst);
+	std::copy(other.m_uLODIndexCount, other.m_uLODIndexCount + m_uLODMax, m_uLODIndexCount);
+	m_fRadius = other.m_fRadius;
 
 	m_VAO = other.m_VAO;
 	m_VBO = other.m_VBO;
+	m_EBO = other.m_EBO;
+	m_eIndexType = other.m_eIndexType;
+	m_nVertexFormat = other.m_nVertexFormat;
 
 	m_nShader = other.m_nShader;
+	m_nShaderWire = other.m_nShaderWire;
 
 	m_v3Tint = other.m_v3Tint;
 	m_v3Wireframe = other.m_v3Wireframe;
@@ -129,12 +165,21 @@ void Mesh::Instantiate(Mesh* const other)
 
 	m_bBinded = other->m_bBinded;
 	m_uVertexCount = other->m_uVertexCount;
+	m_uIndexCount = other->m_uIndexCount;
+	m_uLODCount = other->m_uLODCount;
+	std::copy(other->m_uLODFirst, other->m_uLODFirst + m_uLODMax, m_uLODFirst);
+	std::copy(other->m_uLODIndexCount, other->m_uLODIndexCount + m_uLODMax, m_uLODIndexCount);
+	m_fRadius = other->m_fRadius;
 	m_uMaterialIndex = other->m_uMaterialIndex;
 
 	m_VAO = other->m_VAO;
 	m_VBO = other->m_VBO;
+	m_EBO = other->m_EBO;
+	m_eIndexType = other->m_eIndexType;
+	m_nVertexFormat = other->m_nVertexFormat;
 
 	m_nShader = other->m_nShader;
+	m_nShaderWire = other->m_nShaderWire;
 
 	m_v3Tint = other->m_v3Tint;
 	m_v3Wireframe = other->m_v3Wireframe;
@@ -240,7 +285,7 @@ String Mesh::GetName(void){ return m_sName; }
 void Mesh::SetName(String a_sName){ m_sName = a_sName; }
 GLuint Mesh::GetShaderIndex (void){ return m_nShader; }
 //Methods
-void Mesh::CompleteTriangleInfo(bool a_bAverageNormals)
+void Mesh::CompleteTriangleInfo(bool a_bAverageNormals, float a_fCreaseAngle)
 {
 	//Complete Colors
 	int nColors = static_cast<int>(m_lVertexCol.size());
@@ -252,106 +297,149 @@ void Mesh::CompleteTriangleInfo(bool a_bAverageNormals)
 	for(uint i = nUVs; i < m_uVertexCount; i++)
 		m_lVertexUV.push_back(vector3(0,0,0));
 	
-	//Complete normals
-	int nNormals = static_cast<int>(m_lVertexNor.size());
-	if(m_uVertexCount % 3 == 0)
+	//Complete normals, tangents and binormals in a single pass over the triangles
+	uint nNormals = static_cast<uint>(m_lVertexNor.size());
+	if (nNormals < m_uVertexCount)
+		m_lVertexNor.resize(m_uVertexCount, vector3(0, 0, 1));
+	bool bTriangles = m_uVertexCount % 3 == 0;
+	bool bTangents = bTriangles && (m_lVertexTan.size() < m_uVertexCount || m_lVertexBin.size() < m_uVertexCount);
+	if (bTangents)
+	{
+		m_lVertexTan.assign(m_uVertexCount, ZERO_V3);
+		m_lVertexBin.assign(m_uVertexCount, ZERO_V3);
+	}
+	for (uint i = 0; bTriangles && i < m_uVertexCount; i += 3)
 	{
-		for(uint i = nNormals; i < m_uVertexCount -1; i += 3)
+		vector3& v0 = m_lVertexPos[i];
+		vector3& v1 = m_lVertexPos[i+1];
+		vector3& v2 = m_lVertexPos[i+2];
+
+		vector3 d0 = v1 - v0;
+		vector3 d1 = v2 - v1;
+
+		vector3 normal = glm::cross(d0, d1);
+		vector3 binormal = glm::cross(normal, d0);
+		vector3 tangent = d0;
+		if(normal.x == 0 && normal.y == 0 && normal.z == 0)
 		{
-			vector3& v0 = m_lVertexPos[i];
-			vector3& v1 = m_lVertexPos[i+1];
-			vector3& v2 = m_lVertexPos[i+2];
+			//All 3 components are 0 so this is a 0 vector and normal
+			//needs to point somewhere, the DEFAULT_V3NEG is outside of the screen
+			normal = vector3( 0.0, 0.0, 1.0);
+		}
+		else
+		{
+			normal = glm::normalize(normal);
+		}
+		for (uint j = i; j < i + 3; j++)
+		{
+			if (j >= nNormals)
+				m_lVertexNor[j] = normal;
+		}
 
-			vector3 d0 = v1 - v0;
-			vector3 d1 = v2 - v1;
+		if (!bTangents)
+			continue;
 
-			vector3 normal = glm::cross(d0, d1);
-			if(normal.x == 0 && normal.y == 0 && normal.z == 0)
-			{
-				//All 3 components are 0 so this is a 0 vector and normal
-				//needs to point somewhere, the DEFAULT_V3NEG is outside of the screen
-				normal = vector3( 0.0, 0.0, 1.0);
-			}
-			else
-			{
-				normal = glm::normalize(normal);
-			}
+		//direction of increasing U and V along the face
+		vector3 deltaPos1 = v1 - v0;
+		vector3 deltaPos2 = v2 - v0;
 
-			m_lVertexNor.push_back(normal);
-			m_lVertexNor.push_back(normal);
-			m_lVertexNor.push_back(normal);
+		vector3 deltaUV1 = m_lVertexUV[i+1] - m_lVertexUV[i];
+		vector3 deltaUV2 = m_lVertexUV[i+2] - m_lVertexUV[i];
+
+		float inv = deltaUV1.x * deltaUV2.y - deltaUV1.y * deltaUV2.x;
+		if(inv != 0)
+		{
+			float r = 1.0f / (inv);
+			tangent = (deltaPos1 * deltaUV2.y - deltaPos2 * deltaUV1.y)*r;
+			binormal = (deltaPos2 * deltaUV1.x - deltaPos1 * deltaUV2.x)*r;
+		}
+		if (tangent != ZERO_V3)
+			tangent = glm::normalize(tangent);
+		if (binormal != ZERO_V3)
+			binormal = glm::normalize(binormal);
+		for (uint j = i; j < i + 3; j++)
+		{
+			m_lVertexTan[j] = tangent;
+			m_lVertexBin[j] = binormal;
 		}
-	}
-	else
-	{
-		for(uint i = nUVs; i < m_uVertexCount; i++)
-			m_lVertexNor.push_back(vector3(0,0,1));
 	}
 
 	if(a_bAverageNormals)
 	{
-		for(uint i = 0; i < m_uVertexCount; i++)
+		//group the vertices by position, each group is a list starting on the one that owns the hash slot
+		uint uTableSize = 1;
+		while (uTableSize < m_uVertexCount * 2)
+			uTableSize <<= 1;
+		std::vector<uint> lTable(uTableSize, 0xFFFFFFFF);
+		std::vector<uint> lNext(m_uVertexCount, 0xFFFFFFFF);
+		std::vector<uint> lGroup(m_uVertexCount);
+		for (uint i = 0; i < m_uVertexCount; i++)
 		{
-			std::vector<int> vIndices;
-			for (uint j = i; j < m_uVertexCount; j++)
+			//-0 is hashed as 0 as they compare equal
+			vector3 v3Position = m_lVertexPos[i] + ZERO_V3;
+			uint uBits[3];
+			memcpy(uBits, &v3Position, sizeof(uBits));
+			uint uSlot = (uBits[0] * 73856093u ^ uBits[1] * 19349663u ^ uBits[2] * 83492791u) & (uTableSize - 1);
+			while (lTable[uSlot] != 0xFFFFFFFF && m_lVertexPos[lTable[uSlot]] != m_lVertexPos[i])
+				uSlot = (uSlot + 1) & (uTableSize - 1);
+			if (lTable[uSlot] == 0xFFFFFFFF)
+				lTable[uSlot] = i;
+			uint uFirst = lTable[uSlot];
+			lGroup[i] = uFirst;
+			if (uFirst != i)
 			{
-				if(m_lVertexPos[i] == m_lVertexPos[j])
-					vIndices.push_back(j);
+				lNext[i] = lNext[uFirst];
+				lNext[uFirst] = i;
 			}
-			int nSize = static_cast<int> (vIndices.size());
+		}
+
+		//each vertex averages the vertices in its group that are within the crease angle
+		float fCosCrease = cosf(glm::radians(a_fCreaseAngle));
+		std::vector<vector3> lNormal(m_lVertexNor.begin(), m_lVertexNor.begin() + m_uVertexCount);
+		for (uint i = 0; i < m_uVertexCount; i++)
+		{
+			if (lNormal[i] != ZERO_V3)
+				lNormal[i] = glm::normalize(lNormal[i]);
+		}
+		std::vector<vector3> lTangent;
+		std::vector<vector3> lBinormal;
+		if (bTangents)
+		{
+			lTangent = m_lVertexTan;
+			lBinormal = m_lVertexBin;
+		}
+		for (uint i = 0; i < m_uVertexCount; i++)
+		{
 			vector3 normalAverage = ZERO_V3;
-			for (int k = 0; k < nSize; k++)
+			vector3 tangentAverage = ZERO_V3;
+			vector3 binormalAverage = ZERO_V3;
+			for (uint j = lGroup[i]; j != 0xFFFFFFFF; j = lNext[j])
 			{
-				normalAverage += m_lVertexNor[vIndices[k]];
+				if (a_fCreaseAngle < 180.0f && glm::dot(lNormal[i], lNormal[j]) < fCosCrease)
+					continue;
+				normalAverage += lNormal[j];
+				//tangents only follow the UVs if they are continuous, seams stay split
+				if (bTangents && m_lVertexUV[j] == m_lVertexUV[i])
+				{
+					tangentAverage += lTangent[j];
+					binormalAverage += lBinormal[j];
+				}
 			}
 			if (normalAverage != ZERO_V3)
 				normalAverage = glm::normalize(normalAverage);
-			for (int k = 0; k < nSize; k++)
-			{
-				m_lVertexNor[vIndices[k]] = normalAverage;
-			}
-		}
-	}
-}
-void Mesh::CalculateTangents(void)
-{
-	for (uint i = 0; i < m_uVertexCount; i += 3)
-	{
-		vector3 tangent = m_lVertexPos[i+1] - m_lVertexPos[i];
-		vector3 tangent2 = m_lVertexPos[i+2] - m_lVertexPos[i+1];
-
-		vector3 normal = glm::cross(tangent,tangent2);
-		vector3 binormal = glm::cross(normal, tangent);
-		
-		vector3 deltaPos1 = m_lVertexPos[i+1] - m_lVertexPos[i];
-		vector3 deltaPos2 = m_lVertexPos[i+2] - m_lVertexPos[i];
-		
-		vector3 deltaUV1 = m_lVertexUV[i+1] - m_lVertexUV[i];
-		vector3 deltaUV2 = m_lVertexUV[i+2] - m_lVertexUV[i];
-			
-		float inv = deltaUV1.x * deltaUV2.y - deltaUV1.y * deltaUV2.x;
-		if(inv != 0)
-		{
-			float r = 1.0f / (inv);
+			m_lVertexNor[i] = normalAverage;
+			if (bTangents)
 			{
-				tangent = (deltaPos1 * deltaUV2.y   - deltaPos2 * deltaUV1.y)*r;
-				binormal = (deltaPos2 * deltaUV1.x   - deltaPos1 * deltaUV2.x)*r;
-				if( tangent.x != 0 && tangent.y != 0 && tangent.z != 0)
-					tangent = glm::normalize(tangent);
-				if( binormal.x != 0 && binormal.y != 0 && binormal.z != 0)
-					binormal = glm::normalize(binormal);
+				m_lVertexTan[i] = tangentAverage;
+				if (binormalAverage != ZERO_V3)
+					binormalAverage = glm::normalize(binormalAverage);
+				m_lVertexBin[i] = binormalAverage;
 			}
 		}
-
-		AddVertexBinormal(binormal);
-		AddVertexBinormal(binormal);
-		AddVertexBinormal(binormal);
-
-		AddVertexTangent(tangent);
-		AddVertexTangent(tangent);
-		AddVertexTangent(tangent);
 	}
 
+	if (!bTangents)
+		return;
 	for (uint i = 0 ; i < m_uVertexCount; i++ )
 	{
 		vector3 & n = m_lVertexNor[i];
@@ -370,10 +458,18 @@ void Mesh::CalculateTangents(void)
 		}
 	}
 }
+void Mesh::CalculateTangents(void)
+{
+	//calculated along the missing triangle information
+	m_lVertexTan.clear();
+	m_lVertexBin.clear();
+	CompleteTriangleInfo(false);
+}
 void Mesh::DisconnectOpenGL3X(void)
 {
 	m_VAO = 0;
 	m_VBO = 0;
+	m_EBO = 0;
 }
 void Mesh::CompleteMesh(vector3 a_v3Color)
 {
@@ -397,6 +493,514 @@ void Mesh::CompleteMesh(vector3 a_v3Color)
 	for(uint nUV = nUVTotal; nUV < m_uVertexCount; nUV++)
 		m_lVertexUV.push_back(vector3(1.0f, 0.0f, 0.0f));
 }
+uint Mesh::WeldVertices(void)
+{
+	m_lVertex.clear();
+	m_lIndex.clear();
+
+	//only whole triangles are drawn
+	uint uCount = m_uVertexCount - (m_uVertexCount % 3);
+	m_uIndexCount = uCount;
+	if (uCount == 0)
+		return 0;
+
+	//open addressing table of indices into the welded vertices, twice as big as needed
+	uint uTableSize = 1;
+	while (uTableSize < uCount * 2)
+		uTableSize <<= 1;
+	std::vector<uint> lTable(uTableSize, 0xFFFFFFFF);
+
+	m_lIndex.resize(uCount);
+	m_lVertex.reserve(uCount * 6);
+	uint uUniqueCount = 0;
+	vector3 v3Attribute[6];
+	for (uint i = 0; i < uCount; ++i)
+	{
+		v3Attribute[0] = m_lVertexPos[i];
+		v3Attribute[1] = m_lVertexCol[i];
+		v3Attribute[2] = m_lVertexUV[i];
+		v3Attribute[3] = m_lVertexNor[i];
+		v3Attribute[4] = m_lVertexBin[i];
+		v3Attribute[5] = m_lVertexTan[i];
+
+		//FNV-1a over the bits of the 18 floats, -0 is hashed as 0 as they compare equal
+		uint uHash = 2166136261u;
+		const float* fValue = &v3Attribute[0].x;
+		for (uint j = 0; j < 18; ++j)
+		{
+			float fComponent = fValue[j] + 0.0f;
+			uint uBits;
+			memcpy(&uBits, &fComponent, sizeof(uint));
+			uHash = (uHash ^ uBits) * 16777619u;
+		}
+
+		uint uSlot = uHash & (uTableSize - 1);
+		while (true)
+		{
+			uint uVertex = lTable[uSlot];
+			if (uVertex == 0xFFFFFFFF)
+			{
+				//first time this vertex is seen
+				uVertex = uUniqueCount++;
+				lTable[uSlot] = uVertex;
+				m_lVertex.insert(m_lVertex.end(), v3Attribute, v3Attribute + 6);
+				m_lIndex[i] = uVertex;
+				break;
+			}
+			bool bEqual = true;
+			for (uint j = 0; j < 6 && bEqual; ++j)
+				bEqual = m_lVertex[uVertex * 6 + j] == v3Attribute[j];
+			if (bEqual)
+			{
+				m_lIndex[i] = uVertex;
+				break;
+			}
+			uSlot = (uSlot + 1) & (uTableSize - 1);
+		}
+	}
+	return uUniqueCount;
+}
+void Mesh::OptimizeVertexCache(std::vector<uint>& a_lIndex, uint a_uUniqueCount)
+{
+	//Scoring from Tom Forsyth's "Linear-Speed Vertex Cache Optimisation"
+	const int nCacheSize = 32;
+	const float fLastTriScore = 0.75f;
+	const float fDecayPower = 1.5f;
+	const float fValenceScale = 2.0f;
+	const float fValencePower = 0.5f;
+	auto VertexScore = [&](int a_nCachePosition, uint a_uRemaining) -> float
+	{
+		if (a_uRemaining == 0)
+			return -1.0f; //no triangle needs it anymore
+		float fScore = 0.0f;
+		if (a_nCachePosition >= 0)
+		{
+			//the last triangle's vertices get a fixed score so the optimizer does not prefer strips
+			if (a_nCachePosition < 3)
+				fScore = fLastTriScore;
+			else
+				fScore = powf(1.0f - (a_nCachePosition - 3) / static_cast<float>(nCacheSize - 3), fDecayPower);
+		}
+		//vertices with few triangles left are finished first so they leave the cache for good
+		fScore += fValenceScale * powf(static_cast<float>(a_uRemaining), -fValencePower);
+		return fScore;
+	};
+
+	uint uIndexCount = static_cast<uint>(a_lIndex.size());
+	uint uTriangleCount = uIndexCount / 3;
+	if (uTriangleCount == 0)
+		return;
+
+	//triangles using each vertex, as ranges of a single list
+	std::vector<uint> lRemaining(a_uUniqueCount, 0);
+	for (uint i = 0; i < uIndexCount; ++i)
+		lRemaining[a_lIndex[i]]++;
+	std::vector<uint> lFirst(a_uUniqueCount + 1, 0);
+	for (uint i = 0; i < a_uUniqueCount; ++i)
+		lFirst[i + 1] = lFirst[i] + lRemaining[i];
+	std::vector<uint> lTriangle(uIndexCount);
+	std::vector<uint> lFill(lFirst.begin(), lFirst.end() - 1);
+	for (uint i = 0; i < uIndexCount; ++i)
+		lTriangle[lFill[a_lIndex[i]]++] = i / 3;
+
+	std::vector<float> lVertexScore(a_uUniqueCount);
+	for (uint i = 0; i < a_uUniqueCount; ++i)
+		lVertexScore[i] = VertexScore(-1, lRemaining[i]);
+
+	std::vector<float> lTriangleScore(uTriangleCount);
+	std::vector<bool> lEmitted(uTriangleCount, false);
+	int nBest = 0;
+	for (uint i = 0; i < uTriangleCount; ++i)
+	{
+		lTriangleScore[i] = lVertexScore[a_lIndex[i * 3]] + lVertexScore[a_lIndex[i * 3 + 1]] + lVertexScore[a_lIndex[i * 3 + 2]];
+		if (lTriangleScore[i] > lTriangleScore[nBest])
+			nBest = i;
+	}
+
+	std::vector<uint> lOutput;
+	lOutput.reserve(uIndexCount);
+	std::vector<uint> lCache;
+	std::vector<uint> lNewCache;
+	lCache.reserve(nCacheSize + 3);
+	lNewCache.reserve(nCacheSize + 3);
+	uint uCursor = 0; //triangles before this one are all emitted
+	for (uint uEmitted = 0; uEmitted < uTriangleCount; ++uEmitted)
+	{
+		//nothing in the cache is connected to what is left, continue with the next triangle in the list
+		if (nBest < 0)
+		{
+			while (lEmitted[uCursor])
+				++uCursor;
+			nBest = uCursor;
+		}
+
+		lEmitted[nBest] = true;
+		lNewCache.clear();
+		for (uint j = 0; j < 3; ++j)
+		{
+			uint uVertex = a_lIndex[nBest * 3 + j];
+			lOutput.push_back(uVertex);
+
+			//remove the triangle from the ones left for the vertex
+			uint uStart = lFirst[uVertex];
+			uint uEnd = uStart + lRemaining[uVertex];
+			for (uint k = uStart; k < uEnd; ++k)
+			{
+				if (lTriangle[k] == static_cast<uint>(nBest))
+				{
+					std::swap(lTriangle[k], lTriangle[uEnd - 1]);
+					break;
+				}
+			}
+			lRemaining[uVertex]--;
+
+			if (std::find(lNewCache.begin(), lNewCache.end(), uVertex) == lNewCache.end())
+				lNewCache.push_back(uVertex);
+		}
+		//the rest of the cache moves back, least recently used vertices fall out
+		for (uint uVertex : lCache)
+		{
+			if (std::find(lNewCache.begin(), lNewCache.end(), uVertex) == lNewCache.end())
+				lNewCache.push_back(uVertex);
+		}
+
+		//update the scores of the vertices that moved and of their triangles
+		nBest = -1;
+		float fBestScore = -1.0f;
+		for (uint i = 0; i < lNewCache.size(); ++i)
+		{
+			uint uVertex = lNewCache[i];
+			int nPosition = static_cast<int>(i) < nCacheSize ? static_cast<int>(i) : -1;
+			float fScore = VertexScore(nPosition, lRemaining[uVertex]);
+			float fDelta = fScore - lVertexScore[uVertex];
+			lVertexScore[uVertex] = fScore;
+			uint uStart = lFirst[uVertex];
+			uint uEnd = uStart + lRemaining[uVertex];
+			for (uint k = uStart; k < uEnd; ++k)
+			{
+				uint uTriangle = lTriangle[k];
+				lTriangleScore[uTriangle] += fDelta;
+			}
+		}
+		//the next triangle is the best one using a cached vertex
+		if (lNewCache.size() > static_cast<uint>(nCacheSize))
+			lNewCache.resize(nCacheSize);
+		for (uint uVertex : lNewCache)
+		{
+			uint uStart = lFirst[uVertex];
+			uint uEnd = uStart + lRemaining[uVertex];
+			for (uint k = uStart; k < uEnd; ++k)
+			{
+				uint uTriangle = lTriangle[k];
+				if (lTriangleScore[uTriangle] > fBestScore)
+				{
+					fBestScore = lTriangleScore[uTriangle];
+					nBest = uTriangle;
+				}
+			}
+		}
+		std::swap(lCache, lNewCache);
+	}
+
+	a_lIndex.swap(lOutput);
+}
+void Mesh::OptimizeVertexFetch(void)
+{
+	//renumber the vertices in order of first use so they are also fetched in order
+	uint uVertexCount = static_cast<uint>(m_lVertex.size() / 6);
+	std::vector<uint> lRemap(uVertexCount, 0xFFFFFFFF);
+	std::vector<vector3> lVertex(m_lVertex.size());
+	uint uNext = 0;
+	for (uint i = 0; i < m_lIndex.size(); ++i)
+	{
+		uint uVertex = m_lIndex[i];
+		if (lRemap[uVertex] == 0xFFFFFFFF)
+		{
+			lRemap[uVertex] = uNext;
+			std::copy(m_lVertex.begin() + uVertex * 6, m_lVertex.begin() + uVertex * 6 + 6, lVertex.begin() + uNext * 6);
+			++uNext;
+		}
+		m_lIndex[i] = lRemap[uVertex];
+	}
+	//vertices no triangle uses are dropped
+	lVertex.resize(uNext * 6);
+	m_lVertex.swap(lVertex);
+}
+void Mesh::GenerateLOD(uint a_uUniqueCount)
+{
+	m_uLODCount = 1;
+	m_uLODFirst[0] = 0;
+	m_uLODIndexCount[0] = m_uIndexCount;
+
+	//small meshes are cheaper drawn whole than split in more draw calls
+	if (m_uIndexCount < 3 * 256)
+		return;
+
+	std::vector<vector3> lPosition(a_uUniqueCount);
+	for (uint i = 0; i < a_uUniqueCount; ++i)
+		lPosition[i] = m_lVertex[i * 6];
+
+	//vertices on an edge used by a single triangle do not move, that keeps the holes, the
+	//borders and the seams (vertices welded apart by their UVs or normals) in place
+	std::vector<bool> lLocked(a_uUniqueCount, false);
+	{
+		//both directions of an edge get the same key, sorted so the copies of an edge are together
+		std::vector<uint64_t> lEdge(m_uIndexCount);
+		for (uint i = 0; i < m_uIndexCount; ++i)
+		{
+			uint64_t uA = m_lIndex[i];
+			uint64_t uB = m_lIndex[i - i % 3 + (i + 1) % 3];
+			lEdge[i] = uA < uB ? (uA << 32) | uB : (uB << 32) | uA;
+		}
+		std::sort(lEdge.begin(), lEdge.end());
+		for (uint i = 0; i < m_uIndexCount; ++i)
+		{
+			bool bSingle = (i == 0 || lEdge[i - 1] != lEdge[i]) && (i + 1 == m_uIndexCount || lEdge[i + 1] != lEdge[i]);
+			if (bSingle)
+			{
+				lLocked[static_cast<uint>(lEdge[i] >> 32)] = true;
+				lLocked[static_cast<uint>(lEdge[i] & 0xFFFFFFFF)] = true;
+			}
+		}
+	}
+
+	//quadric of the planes around each vertex weighted by area: a2 ab ac ad b2 bc bd c2 cd d2 area
+	std::vector<double> lQuadric(a_uUniqueCount * 11, 0.0);
+	for (uint i = 0; i < m_uIndexCount; i += 3)
+	{
+		vector3 v3Normal = glm::cross(lPosition[m_lIndex[i + 1]] - lPosition[m_lIndex[i]], lPosition[m_lIndex[i + 2]] - lPosition[m_lIndex[i]]);
+		float fArea = glm::length(v3Normal) * 0.5f;
+		if (fArea == 0.0f)
+			continue;
+		v3Normal = glm::normalize(v3Normal);
+		double a = v3Normal.x, b = v3Normal.y, c = v3Normal.z;
+		double d = -glm::dot(v3Normal, lPosition[m_lIndex[i]]);
+		double plane[11] = { a*a, a*b, a*c, a*d, b*b, b*c, b*d, c*c, c*d, d*d, 1.0 };
+		for (uint j = 0; j < 3; ++j)
+		{
+			double* pQuadric = &lQuadric[m_lIndex[i + j] * 11];
+			for (uint k = 0; k < 11; ++k)
+				pQuadric[k] += plane[k] * fArea;
+		}
+	}
+	//mean squared distance from a point to the planes accumulated in a vertex
+	auto QuadricError = [&](uint a_uVertex, vector3 a_v3Point) -> double
+	{
+		const double* q = &lQuadric[a_uVertex * 11];
+		if (q[10] == 0.0)
+			return 0.0;
+		double x = a_v3Point.x, y = a_v3Point.y, z = a_v3Point.z;
+		double fError = q[0] * x * x + q[4] * y * y + q[7] * z * z + 2.0 * (q[1] * x * y + q[2] * x * z + q[5] * y * z)
+			+ 2.0 * (q[3] * x + q[6] * y + q[8] * z) + q[9];
+		return fError > 0.0 ? fError / q[10] : 0.0;
+	};
+
+	std::vector<uint> lIndex(m_lIndex.begin(), m_lIndex.begin() + m_uIndexCount);
+	std::vector<uint> lRemap(a_uUniqueCount);
+	std::vector<bool> lTouched(a_uUniqueCount);
+	std::vector<uint> lFirst(a_uUniqueCount + 1);
+	std::vector<uint> lTriangle;
+	for (uint uLevel = 1; uLevel < m_uLODMax; ++uLevel)
+	{
+		uint uTarget = static_cast<uint>(lIndex.size()) / 6;
+		//each level may move the surface twice as much as the previous one
+		float fMaxDistance = m_fRadius * 0.01f * static_cast<float>(1 << (uLevel - 1));
+		double fMaxError = static_cast<double>(fMaxDistance) * fMaxDistance;
+
+		//collapse in passes of independent edges until the target is met or nothing can be collapsed
+		while (lIndex.size() / 3 > uTarget)
+		{
+			uint uTriangleCount = static_cast<uint>(lIndex.size() / 3);
+
+			//triangles around each vertex
+			std::fill(lFirst.begin(), lFirst.end(), 0);
+			for (uint uVertex : lIndex)
+				lFirst[uVertex + 1]++;
+			for (uint i = 0; i < a_uUniqueCount; ++i)
+				lFirst[i + 1] += lFirst[i];
+			lTriangle.resize(lIndex.size());
+			std::vector<uint> lFill(lFirst.begin(), lFirst.end() - 1);
+			for (uint i = 0; i < lIndex.size(); ++i)
+				lTriangle[lFill[lIndex[i]]++] = i / 3;
+
+			//every edge can collapse its first vertex onto the second one if the first is free to move
+			struct Collapse { double m_fError; uint m_uFrom; uint m_uTo; };
+			std::vector<Collapse> lCollapse;
+			lCollapse.reserve(lIndex.size());
+			for (uint i = 0; i < lIndex.size(); ++i)
+			{
+				uint uFrom = lIndex[i];
+				uint uTo = lIndex[i - i % 3 + (i + 1) % 3];
+				if (!lLocked[uFrom])
+					lCollapse.push_back({ QuadricError(uFrom, lPosition[uTo]), uFrom, uTo });
+				if (!lLocked[uTo])
+					lCollapse.push_back({ QuadricError(uTo, lPosition[uFrom]), uTo, uFrom });
+			}
+			std::sort(lCollapse.begin(), lCollapse.end(),
+				[](const Collapse& a, const Collapse& b) { return a.m_fError < b.m_fError; });
+
+			for (uint i = 0; i < a_uUniqueCount; ++i)
+				lRemap[i] = i;
+			std::fill(lTouched.begin(), lTouched.end(), false);
+			uint uCollapsed = 0;
+			for (const Collapse& collapse : lCollapse)
+			{
+				if (collapse.m_fError > fMaxError || uTriangleCount <= uTarget)
+					break;
+				uint uFrom = collapse.m_uFrom;
+				uint uTo = collapse.m_uTo;
+				if (lTouched[uFrom] || lTouched[uTo])
+					continue;
+
+				//the triangles that stay must not flip when the vertex moves
+				bool bFlip = false;
+				uint uRemoved = 0;
+				for (uint k = lFirst[uFrom]; k < lFirst[uFrom + 1] && !bFlip; ++k)
+				{
+					uint* pTriangle = &lIndex[lTriangle[k] * 3];
+					if (pTriangle[0] == uTo || pTriangle[1] == uTo || pTriangle[2] == uTo)
+					{
+						uRemoved++;
+						continue;
+					}
+					vector3 v3Old[3], v3New[3];
+					for (uint j = 0; j < 3; ++j)
+					{
+						v3Old[j] = lPosition[pTriangle[j]];
+						v3New[j] = pTriangle[j] == uFrom ? lPosition[uTo] : v3Old[j];
+					}
+					vector3 v3OldNormal = glm::cross(v3Old[1] - v3Old[0], v3Old[2] - v3Old[0]);
+					vector3 v3NewNormal = glm::cross(v3New[1] - v3New[0], v3New[2] - v3New[0]);
+					bFlip = glm::dot(v3OldNormal, v3NewNormal) <= 0.0f;
+				}
+				if (bFlip)
+					continue;
+
+				//nothing around the collapse can change again in this pass
+				for (uint k = lFirst[uFrom]; k < lFirst[uFrom + 1]; ++k)
+				{
+					uint* pTriangle = &lIndex[lTriangle[k] * 3];
+					lTouched[pTriangle[0]] = lTouched[pTriangle[1]] = lTouched[pTriangle[2]] = true;
+				}
+				lRemap[uFrom] = uTo;
+				double* pFrom = &lQuadric[uFrom * 11];
+				double* pTo = &lQuadric[uTo * 11];
+				for (uint k = 0; k < 11; ++k)
+					pTo[k] += pFrom[k];
+				uTriangleCount -= uRemoved;
+				uCollapsed++;
+			}
+			if (uCollapsed == 0)
+				break;
+
+			//move the collapsed vertices and drop the triangles that lost their area
+			uint uKept = 0;
+			for (uint i = 0; i < lIndex.size(); i += 3)
+			{
+				uint uA = lRemap[lIndex[i]], uB = lRemap[lIndex[i + 1]], uC = lRemap[lIndex[i + 2]];
+				if (uA == uB || uB == uC || uC == uA)
+					continue;
+				lIndex[uKept++] = uA;
+				lIndex[uKept++] = uB;
+				lIndex[uKept++] = uC;
+			}
+			lIndex.resize(uKept);
+		}
+
+		//not worth a level if it did not remove enough
+		uint uPrevious = m_uLODIndexCount[uLevel - 1];
+		if (lIndex.size() == 0 || lIndex.size() > uPrevious * 3 / 4)
+			break;
+
+		std::vector<uint> lLevel(lIndex);
+		OptimizeVertexCache(lLevel, a_uUniqueCount);
+		m_uLODFirst[uLevel] = static_cast<uint>(m_lIndex.size());
+		m_uLODIndexCount[uLevel] = static_cast<uint>(lLevel.size());
+		m_lIndex.insert(m_lIndex.end(), lLevel.begin(), lLevel.end());
+		m_uLODCount = uLevel + 1;
+	}
+}
+uint Mesh::GetVertexLayout(int a_nFormat, VertexAttribute* a_pAttribute)
+{
+	uint uOffset = 0;
+	for (uint i = 0; i < ATTRIBUTE_COUNT; ++i)
+	{
+		VertexAttribute& attribute = a_pAttribute[i];
+		attribute.m_nSize = 3;
+		attribute.m_eType = GL_FLOAT;
+		attribute.m_bNormalized = GL_FALSE;
+		attribute.m_uOffset = uOffset;
+		if (i == ATTRIBUTE_COLOR && (a_nFormat & VERTEXFORMAT_BYTE_COLOR))
+		{
+			attribute.m_nSize = 4;
+			attribute.m_eType = GL_UNSIGNED_BYTE;
+			attribute.m_bNormalized = GL_TRUE;
+		}
+		else if (i == ATTRIBUTE_UV && (a_nFormat & VERTEXFORMAT_HALF_UV))
+		{
+			attribute.m_nSize = 2;
+			attribute.m_eType = GL_HALF_FLOAT;
+		}
+		else if (i >= ATTRIBUTE_NORMAL && (a_nFormat & VERTEXFORMAT_PACKED_NORMAL))
+		{
+			attribute.m_nSize = 4;
+			attribute.m_eType = GL_INT_2_10_10_10_REV;
+			attribute.m_bNormalized = GL_TRUE;
+		}
+		//all the compact encodings take 4 bytes
+		uOffset += attribute.m_eType == GL_FLOAT ? 3 * sizeof(float) : 4;
+	}
+	return uOffset;
+}
+void Mesh::UploadVertices(void)
+{
+	VertexAttribute attribute[ATTRIBUTE_COUNT];
+	uint uStride = GetVertexLayout(m_nVertexFormat, attribute);
+	uint uVertexCount = static_cast<uint>(m_lVertex.size() / 6);
+
+	//encode each attribute of each vertex into its place in the interleaved buffer
+	std::vector<unsigned char> lBuffer(uVertexCount * uStride);
+	for (uint i = 0; i < uVertexCount; ++i)
+	{
+		unsigned char* pVertex = &lBuffer[i * uStride];
+		for (uint j = 0; j < ATTRIBUTE_COUNT; ++j)
+		{
+			vector3 v3Value = m_lVertex[i * 6 + j];
+			unsigned char* pTarget = pVertex + attribute[j].m_uOffset;
+			uint uPacked = 0;
+			switch (attribute[j].m_eType)
+			{
+			case GL_UNSIGNED_BYTE:
+				uPacked = glm::packUnorm4x8(vector4(v3Value, 1.0f));
+				break;
+			case GL_HALF_FLOAT:
+				uPacked = glm::packHalf2x16(vector2(v3Value));
+				break;
+			case GL_INT_2_10_10_10_REV:
+				//10 bits per component are only enough for directions
+				if (v3Value != ZERO_V3)
+					v3Value = glm::normalize(v3Value);
+				uPacked = glm::packSnorm3x10_1x2(vector4(v3Value, 0.0f));
+				break;
+			default:
+				memcpy(pTarget, &v3Value, sizeof(vector3));
+				continue;
+			}
+			memcpy(pTarget, &uPacked, sizeof(uint));
+		}
+	}
+
+	GLState::GetInstance()->BindArrayBuffer(m_VBO);
+	glBufferData(GL_ARRAY_BUFFER, lBuffer.size(), &lBuffer[0], GL_STATIC_DRAW);
+
+	//Position, Color, UV, Normal, Bi-Normal and Tangent attributes
+	for (GLuint i = 0; i < ATTRIBUTE_COUNT; ++i)
+	{
+		glEnableVertexAttribArray(i);
+		glVertexAttribPointer(i, attribute[i].m_nSize, attribute[i].m_eType, attribute[i].m_bNormalized,
+			uStride, (GLvoid*)(size_t)attribute[i].m_uOffset);
+	}
+}
 void Mesh::CompileOpenGL3X(void)
 {
 	if(m_bBinded)
@@ -407,51 +1011,41 @@ void Mesh::CompileOpenGL3X(void)
 
 	CompleteMesh();
 
-	for (uint i = 0; i < m_uVertexCount; i++)
-	{
-		//Position
-		m_lVertex.push_back(m_lVertexPos[i]);
-		//Color
-		m_lVertex.push_back(m_lVertexCol[i]);
-		//UV
-		m_lVertex.push_back(m_lVertexUV[i]);
-		//Normal
-		m_lVertex.push_back(m_lVertexNor[i]);
-		//Bi-Normal
-		m_lVertex.push_back(m_lVertexBin[i]);
-		//Tangent
-		m_lVertex.push_back(m_lVertexTan[i]);
-	}
+	//Store each distinct vertex once and draw through an index buffer
+	uint uUniqueCount = WeldVertices();
+	if (m_uIndexCount == 0)
+		return;
+	OptimizeVertexCache(m_lIndex, uUniqueCount);
+
+	//simplified levels of detail share the vertices, drawn from their own range of indices
+	m_fRadius = 0.0f;
+	for (uint i = 0; i < m_uIndexCount; i++)
+		m_fRadius = std::max(m_fRadius, glm::length(m_lVertexPos[i]));
+	GenerateLOD(uUniqueCount);
+	OptimizeVertexFetch();
+	uUniqueCount = static_cast<uint>(m_lVertex.size() / 6);
+
 	glGenVertexArrays( 1, &m_VAO );//Generate vertex array object
 	glGenBuffers(1, &m_VBO);//Generate Vertex Buffered Object
+	glGenBuffers(1, &m_EBO);//Generate Element Buffered Object
 	
-	glBindVertexArray( m_VAO );//Bind the VAO
-	glBindBuffer(GL_ARRAY_BUFFER, m_VBO);//Bind the VBO
-	glBufferData(GL_ARRAY_BUFFER, m_uVertexCount * 6 * sizeof(vector3), &m_lVertex[0], GL_STATIC_DRAW);//Generate space for the VBO
-
-	// Position attribute
-	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(vector3), (GLvoid*)0);
+	GLState* pState = GLState::GetInstance();
+	pState->BindVertexArray(m_VAO);//Bind the VAO
+	UploadVertices();//Fill the VBO and set the attributes
 
-	// Color attribute
-	glEnableVertexAttribArray(1);
-	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(vector3), (GLvoid*)(1 * sizeof(vector3)));
-	
-	// UV attribute
-	glEnableVertexAttribArray(2);
-	glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(vector3), (GLvoid*)(2 * sizeof(vector3)));
-	
-	// Normal attribute
-	glEnableVertexAttribArray(3);
-	glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(vector3), (GLvoid*)(3 * sizeof(vector3)));
-	
-	// Bi-Normal attribute
-	glEnableVertexAttribArray(4);
-	glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(vector3), (GLvoid*)(4 * sizeof(vector3)));
-	
-	// Tangent attribute
-	glEnableVertexAttribArray(5);
-	glVertexAttribPointer(5, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(vector3), (GLvoid*)(5 * sizeof(vector3)));
+	//The element buffer binding is part of the VAO
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
+	if (uUniqueCount <= 0xFFFF)
+	{
+		std::vector<unsigned short> lIndex(m_lIndex.begin(), m_lIndex.end());
+		m_eIndexType = GL_UNSIGNED_SHORT;
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, lIndex.size() * sizeof(unsigned short), &lIndex[0], GL_STATIC_DRAW);
+	}
+	else
+	{
+		m_eIndexType = GL_UNSIGNED_INT;
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_lIndex.size() * sizeof(uint), &m_lIndex[0], GL_STATIC_DRAW);
+	}
 
 	if(m_uMaterialIndex < 0)
 	{
@@ -467,7 +1061,7 @@ void Mesh::CompileOpenGL3X(void)
 
 	m_bBinded = true;
 
-	glBindVertexArray(0); // Unbind VAO
+	pState->BindVertexArray(0); // Unbind VAO
 
 	return;
 }
@@ -479,6 +1073,41 @@ GLuint Mesh::GetVBO(void)
 {
 	return m_VBO;
 }
+GLuint Mesh::GetEBO(void)
+{
+	return m_EBO;
+}
+uint Mesh::GetIndexCount(void)
+{
+	return m_uIndexCount;
+}
+uint Mesh::GetLODCount(void)
+{
+	return m_uLODCount;
+}
+float Mesh::GetRadius(void)
+{
+	return m_fRadius;
+}
+int Mesh::GetVertexFormat(void)
+{
+	return m_nVertexFormat;
+}
+void Mesh::SetVertexFormat(int a_nFormat)
+{
+	if (m_pOriginal != nullptr || m_nVertexFormat == a_nFormat)
+		return;
+	m_nVertexFormat = a_nFormat;
+
+	//already in the GPU, encode it again
+	if (m_bBinded)
+	{
+		GLState* pState = GLState::GetInstance();
+		pState->BindVertexArray(m_VAO);
+		UploadVertices();
+		pState->BindVertexArray(0);
+	}
+}
 void Mesh::SetWireframeColor(vector3 a_v3Color){ m_v3Wireframe = a_v3Color; }
 vector3 Mesh::GetWireframeColor(void) { return m_v3Wireframe; }
 // Compile shapes
@@ -714,7 +1343,8 @@ void Mesh::Render(matrix4 a_mProjection, matrix4 a_mView, matrix4 a_mWorld, vect
 {
 	Render(a_mProjection, a_mView, glm::value_ptr(a_mWorld), 1, a_v3CameraPosition, a_RenderOption);
 }
-void Mesh::Render( matrix4 a_mProjection, matrix4 a_mView, float* a_fMatrixArray, int a_nInstances, vector3 a_v3CameraPosition, int a_RenderOption)
+void Mesh::Render( matrix4 a_mProjection, matrix4 a_mView, float* a_fMatrixArray, int a_nInstances, vector3 a_v3CameraPosition, int a_RenderOption, uint a_uLOD,
+	vector4* a_v4ColorArray)
 {
 	//check if the shape has been binded
 	if (!m_bBinded)
@@ -733,7 +1363,7 @@ void Mesh::Render( matrix4 a_mProjection, matrix4 a_mView, float* a_fMatrixArray
 	if (a_RenderOption & BTO_RENDER::RENDER_SOLID)
 	{
 		solid = true;
-		RenderSolid(a_mProjection, a_mView, a_fMatrixArray, a_nInstances, a_v3CameraPosition);
+		RenderSolid(a_mProjection, a_mView, a_fMatrixArray, a_nInstances, a_v3CameraPosition, a_uLOD, a_v4ColorArray);
 	}
 	if (a_RenderOption & BTO_RENDER::RENDER_WIRE)
 	{
@@ -742,86 +1372,120 @@ void Mesh::Render( matrix4 a_mProjection, matrix4 a_mView, float* a_fMatrixArray
 			vector3 wireframe;
 			wireframe = m_v3Wireframe;
 			std::swap(wireframe, m_v3Wireframe);
-			RenderWire(a_mProjection, a_mView, a_fMatrixArray, a_nInstances);
+			RenderWire(a_mProjection, a_mView, a_fMatrixArray, a_nInstances, a_uLOD);
 			m_v3Wireframe = wireframe;
 		}
 		else
-			RenderWire(a_mProjection, a_mView, a_fMatrixArray, a_nInstances);
+			RenderWire(a_mProjection, a_mView, a_fMatrixArray, a_nInstances, a_uLOD);
 	}
 }
-void Mesh::RenderWire(matrix4 a_mProjection, matrix4 a_mView, float* a_fMatrixArray, int a_nInstances)
+void Mesh::RenderWire(matrix4 a_mProjection, matrix4 a_mView, float* a_fMatrixArray, int a_nInstances, uint a_uLOD)
 {
-	GLuint nShader = m_pShaderMngr->GetShaderID("Wireframe");
+	//range of the index buffer holding the level of detail
+	if (a_uLOD >= m_uLODCount)
+		a_uLOD = m_uLODCount - 1;
+	GLsizei nIndexCount = m_uLODIndexCount[a_uLOD];
+	GLvoid* pFirstIndex = (GLvoid*)(size_t)(m_uLODFirst[a_uLOD] * (m_eIndexType == GL_UNSIGNED_SHORT ? sizeof(unsigned short) : sizeof(uint)));
+
+	GLuint nShader = m_nShaderWire;
+	//if the instances can be streamed use the variant that reads them from vertex attributes
+	InstanceBuffer* pInstanceBuffer = InstanceBuffer::GetInstance();
+	GLuint nInstanced = m_pShaderMngr->GetInstancedShaderID(nShader);
+	bool bStream = nInstanced > 0 && pInstanceBuffer->IsSupported();
+	if (bStream)
+		nShader = nInstanced;
 	// Use the buffer and shader
-	glUseProgram(nShader);
+	GLState* pState = GLState::GetInstance();
+	pState->UseProgram(nShader);
+	pState->BindVertexArray(m_VAO);
 
-	glBindVertexArray(m_VAO);
-
-	// Get the GPU variables by their name and hook them to CPU variables
-	GLuint VP = glGetUniformLocation(nShader, "VP");
-	GLuint m4ToWorld = glGetUniformLocation(nShader, "m4ToWorld");
-	GLuint vWireframe = glGetUniformLocation(nShader, "vWireframe");
+	// Get the GPU variables from the table resolved when the shader was linked
+	const GLint* pUniform = m_pShaderMngr->GetUniformTable(nShader);
+	GLint VP = pUniform[UNIFORM_VP];
+	GLint m4ToWorld = pUniform[UNIFORM_TOWORLD];
+	GLint vWireframe = pUniform[UNIFORM_WIREFRAME];
 
 	//Final Projection of the Camera
 	matrix4 m4VP = a_mProjection * a_mView;
 	glUniformMatrix4fv(VP, 1, GL_FALSE, glm::value_ptr(m4VP));
 	glUniform3f(vWireframe, m_v3Wireframe.x, m_v3Wireframe.y, m_v3Wireframe.z);
 
-	//Number of Instances
-	uint nSections = a_nInstances / 250;
-	uint nRemainders = a_nInstances - (250 * nSections);
-	uint nInstances = a_nInstances;
-	glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-	glEnable(GL_POLYGON_OFFSET_LINE);
-	glPolygonOffset(-1.f, -1.f);
-	for (uint n = 0; n < nSections; n++)
+	//the mode is left as is, the next draw sets what it needs
+	pState->PolygonMode(GL_LINE);
+	pState->PolygonOffsetLine(true, -1.f, -1.f);
+	if (bStream)
 	{
-		glUniformMatrix4fv(m4ToWorld, 250, GL_FALSE, &a_fMatrixArray[n * 250 * 16]);
-		//Draw
-		glDrawArraysInstanced(GL_TRIANGLES, 0, m_uVertexCount, 250);
-		m_uRenderCalls++;
+		//All the instances in a single call
+		int nFirst = pInstanceBuffer->Stream(a_fMatrixArray, nullptr, a_nInstances, vector4(m_v3Wireframe, 0.0f));
+		if (nFirst >= 0)
+		{
+			pInstanceBuffer->BindAttributes(nFirst);
+			glDrawElementsInstanced(GL_TRIANGLES, nIndexCount, m_eIndexType, pFirstIndex, a_nInstances);
+			m_uRenderCalls++;
+		}
 	}
+	else
+	{
+		//Number of Instances
+		uint nSections = a_nInstances / 250;
+		uint nRemainders = a_nInstances - (250 * nSections);
+		for (uint n = 0; n < nSections; n++)
+		{
+			glUniformMatrix4fv(m4ToWorld, 250, GL_FALSE, &a_fMatrixArray[n * 250 * 16]);
+			//Draw
+			glDrawElementsInstanced(GL_TRIANGLES, nIndexCount, m_eIndexType, pFirstIndex, 250);
+			m_uRenderCalls++;
+		}
 
-	glUniformMatrix4fv(m4ToWorld, nRemainders, GL_FALSE, &a_fMatrixArray[nSections * 250 * 16]);
-	glDrawArraysInstanced(GL_TRIANGLES, 0, m_uVertexCount, nRemainders);
-	m_uRenderCalls++;
-
-	glDisable(GL_POLYGON_OFFSET_LINE);
-	glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);//Set rendering mode back to fill
-
-	glBindVertexArray(0);
+		glUniformMatrix4fv(m4ToWorld, nRemainders, GL_FALSE, &a_fMatrixArray[nSections * 250 * 16]);
+		glDrawElementsInstanced(GL_TRIANGLES, nIndexCount, m_eIndexType, pFirstIndex, nRemainders);
+		m_uRenderCalls++;
+	}
 }
-void Mesh::RenderSolid(matrix4 a_mProjection, matrix4 a_mView, float* a_fMatrixArray, int a_nInstances, vector3 a_v3CameraPosition)
+void Mesh::RenderSolid(matrix4 a_mProjection, matrix4 a_mView, float* a_fMatrixArray, int a_nInstances, vector3 a_v3CameraPosition, uint a_uLOD,
+	vector4* a_v4ColorArray)
 {
+	//range of the index buffer holding the level of detail
+	if (a_uLOD >= m_uLODCount)
+		a_uLOD = m_uLODCount - 1;
+	GLsizei nIndexCount = m_uLODIndexCount[a_uLOD];
+	GLvoid* pFirstIndex = (GLvoid*)(size_t)(m_uLODFirst[a_uLOD] * (m_eIndexType == GL_UNSIGNED_SHORT ? sizeof(unsigned short) : sizeof(uint)));
 
 	GLuint nShader = GetShaderIndex();
+	//if the instances can be streamed use the variant that reads them from vertex attributes
+	InstanceBuffer* pInstanceBuffer = InstanceBuffer::GetInstance();
+	GLuint nInstanced = m_pShaderMngr->GetInstancedShaderID(nShader);
+	bool bStream = nInstanced > 0 && pInstanceBuffer->IsSupported();
+	if (bStream)
+		nShader = nInstanced;
 	// Use the buffer and shader
-	glUseProgram(nShader);
-
-	glBindVertexArray(m_VAO);
+	GLState* pState = GLState::GetInstance();
+	pState->UseProgram(nShader);
+	pState->BindVertexArray(m_VAO);
 	
-	// Get the GPU variables by their name and hook them to CPU variables
-	GLuint VP = glGetUniformLocation(nShader, "VP");
-	GLuint m4ModelToWorld = glGetUniformLocation(nShader, "m4ModelToWorld");
+	// Get the GPU variables from the table resolved when the shader was linked
+	const GLint* pUniform = m_pShaderMngr->GetUniformTable(nShader);
+	GLint VP = pUniform[UNIFORM_VP];
+	GLint m4ModelToWorld = pUniform[UNIFORM_MODELTOWORLD];
 
-	GLuint TextureID = glGetUniformLocation(nShader, "TextureID");
-	GLuint NormalID = glGetUniformLocation(nShader, "NormalID");
-	GLuint SpecularID = glGetUniformLocation(nShader, "SpecularID");
-	GLuint nTexture = glGetUniformLocation(nShader, "nTexture");
+	GLint TextureID = pUniform[UNIFORM_TEXTURE];
+	GLint NormalID = pUniform[UNIFORM_NORMALMAP];
+	GLint SpecularID = pUniform[UNIFORM_SPECULARMAP];
+	GLint nTexture = pUniform[UNIFORM_TEXTURECOUNT];
 
-	GLuint LightPosition_W = glGetUniformLocation(nShader, "LightPosition_W");
-	GLuint LightColor = glGetUniformLocation(nShader, "LightColor");
-	GLuint LightPower = glGetUniformLocation(nShader, "LightPower");
-	GLuint AmbientColor = glGetUniformLocation(nShader, "AmbientColor");
-	GLuint AmbientPower = glGetUniformLocation(nShader, "AmbientPower");
-	GLuint Tint = glGetUniformLocation(nShader, "Tint");
+	GLint LightPosition_W = pUniform[UNIFORM_LIGHTPOSITION];
+	GLint LightColor = pUniform[UNIFORM_LIGHTCOLOR];
+	GLint LightPower = pUniform[UNIFORM_LIGHTPOWER];
+	GLint AmbientColor = pUniform[UNIFORM_AMBIENTCOLOR];
+	GLint AmbientPower = pUniform[UNIFORM_AMBIENTPOWER];
+	GLint Tint = pUniform[UNIFORM_TINT];
 
-	GLuint CameraPosition_W = glGetUniformLocation(nShader, "CameraPosition_W");
+	GLint CameraPosition_W = pUniform[UNIFORM_CAMERAPOSITION];
 
-	GLuint gl_nInstances = glGetUniformLocation(nShader, "nElements");
+	GLint gl_nInstances = pUniform[UNIFORM_ELEMENTS];
 
-	GLuint m4ToWorld = glGetUniformLocation(nShader, "m4ToWorld");
-	GLuint m4CameraOnWorld = glGetUniformLocation(nShader, "m4CameraOnWorld");
+	GLint m4ToWorld = pUniform[UNIFORM_TOWORLD];
+	GLint m4CameraOnWorld = pUniform[UNIFORM_CAMERAONWORLD];
 
 	//ToWorld matrix
 	glUniformMatrix4fv(m4ModelToWorld, 1, GL_FALSE, glm::value_ptr(matrix4(1.0f)));
@@ -855,9 +1519,8 @@ void Mesh::RenderSolid(matrix4 a_mProjection, matrix4 a_mView, float* a_fMatrixA
 		//if (m_pMatMngr->m_lMaterial[nMaterialIndex]->GetDiffuseMapName() != "NULL")
 		if (index > 0)
 		{
-			glActiveTexture(GL_TEXTURE0);
 			//glBindTexture(GL_TEXTURE_2D, m_pMatMngr->m_lMaterial[nMaterialIndex]->GetDiffuseMap());
-			glBindTexture(GL_TEXTURE_2D, index);
+			pState->BindTexture(0, index);
 			glUniform1i(TextureID, 0);
 			nTextures += 1;
 		}
@@ -867,9 +1530,8 @@ void Mesh::RenderSolid(matrix4 a_mProjection, matrix4 a_mView, float* a_fMatrixA
 		//if (m_pMatMngr->m_lMaterial[nMaterialIndex]->GetNormalMapName() != "NULL")
 		if (index > 0)
 		{
-			glActiveTexture(GL_TEXTURE1);
 			//glBindTexture(GL_TEXTURE_2D, m_pMatMngr->m_lMaterial[nMaterialIndex]->GetNormalMap());
-			glBindTexture(GL_TEXTURE_2D, index);
+			pState->BindTexture(1, index);
 			glUniform1i(NormalID, 1);
 			nTextures += 2;
 		}
@@ -878,38 +1540,47 @@ void Mesh::RenderSolid(matrix4 a_mProjection, matrix4 a_mView, float* a_fMatrixA
 		index = m_pMatMngr->GetSpecularMap(nMaterialIndex);
 		//if (m_pMatMngr->m_lMaterial[nMaterialIndex]->GetSpecularMapName() != "NULL")
 		{
-			glActiveTexture(GL_TEXTURE2);
 			//glBindTexture(GL_TEXTURE_2D, m_pMatMngr->m_lMaterial[nMaterialIndex]->GetSpecularMap());
-			glBindTexture(GL_TEXTURE_2D, index);
+			pState->BindTexture(2, index);
 			glUniform1i(SpecularID, 2);
 			nTextures += 4;
 		}
 	}
 	glUniform1i(nTexture, nTextures);
 
-	//Number of Instances
-	uint nSections = a_nInstances / 250;
-	uint nRemainders = a_nInstances - (250 * nSections);
-	uint nInstances = a_nInstances;
-	glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-	for (uint n = 0; n < nSections; n++)
+	pState->PolygonMode(GL_FILL);
+	pState->PolygonOffsetLine(false);
+	if (bStream)
 	{
-		glUniform1i(gl_nInstances, 250);
-		glUniformMatrix4fv(m4ToWorld, 250, GL_FALSE, &a_fMatrixArray[n * 250 * 16]);
-		glUseProgram(nShader);
-		
-		glDrawArraysInstanced(GL_TRIANGLES, 0, m_uVertexCount, 250);
-		m_uRenderCalls++;
+		//All the instances in a single call, the tint replaces the vertex color when set
+		vector4 v4Tint(0.0f);
+		if (m_v3Tint != DEFAULT_V3NEG)
+			v4Tint = vector4(m_v3Tint, 1.0f);
+		int nFirst = pInstanceBuffer->Stream(a_fMatrixArray, a_v4ColorArray, a_nInstances, v4Tint);
+		if (nFirst >= 0)
+		{
+			glUniform1i(gl_nInstances, a_nInstances);
+			pInstanceBuffer->BindAttributes(nFirst);
+			glDrawElementsInstanced(GL_TRIANGLES, nIndexCount, m_eIndexType, pFirstIndex, a_nInstances);
+			m_uRenderCalls++;
+		}
 	}
+	else
+	{
+		//Number of Instances
+		uint nSections = a_nInstances / 250;
+		uint nRemainders = a_nInstances - (250 * nSections);
+		for (uint n = 0; n < nSections; n++)
+		{
+			glUniform1i(gl_nInstances, 250);
+			glUniformMatrix4fv(m4ToWorld, 250, GL_FALSE, &a_fMatrixArray[n * 250 * 16]);
+			glDrawElementsInstanced(GL_TRIANGLES, nIndexCount, m_eIndexType, pFirstIndex, 250);
+			m_uRenderCalls++;
+		}
 
-	glUniform1i(gl_nInstances, nRemainders);
-	glUniformMatrix4fv(m4ToWorld, nRemainders, GL_FALSE, &a_fMatrixArray[nSections * 250 * 16]);
-	glDrawArraysInstanced(GL_TRIANGLES, 0, m_uVertexCount, nRemainders);
-	m_uRenderCalls++;
-	//For the remainder
-	glDisable(GL_TEXTURE2);
-	glDisable(GL_TEXTURE1);
-	glDisable(GL_TEXTURE0);
-
-	glBindVertexArray(0);
+		glUniform1i(gl_nInstances, nRemainders);
+		glUniformMatrix4fv(m4ToWorld, nRemainders, GL_FALSE, &a_fMatrixArray[nSections * 250 * 16]);
+		glDrawElementsInstanced(GL_TRIANGLES, nIndexCount, m_eIndexType, pFirstIndex, nRemainders);
+		m_uRenderCalls++;
+	}
 }
\ No newline at end of file
@@ -9,6 +9,17 @@ Date: 2017/05
 #include "ShaderManager.h"
 #include "MaterialManager.h"
 #include "LightManager.h"
+#include "InstanceBuffer.h"
+#include "GLState.h"
+
+//Layout of one vertex attribute in the interleaved buffer of a mesh
+struct VertexAttribute
+{
+	GLint m_nSize; //number of components
+	GLenum m_eType; //type of each component
+	GLboolean m_bNormalized; //integers are read as [0, 1] or [-1, 1]
+	uint m_uOffset; //bytes from the start of the vertex
+};
 
 /*
 A Mesh is the most basic container of a model or mesh.
@@ -25,17 +36,28 @@ protected:
 
 	uint m_uMaterialIndex = 0; //Material index of this mesh
 	uint m_uVertexCount = 0; //Number of vertices in this Mesh
+	uint m_uIndexCount = 0; //Number of indices drawn (3 per triangle)
+	static const uint m_uLODMax = 4; //Levels of detail a mesh can have
+	uint m_uLODCount = 1; //Levels of detail generated, the first one is the full mesh
+	uint m_uLODFirst[m_uLODMax]; //First index of each level of detail in m_lIndex
+	uint m_uLODIndexCount[m_uLODMax]; //Number of indices of each level of detail
+	float m_fRadius = 0.0f; //Distance from the origin to the furthest vertex
 	uint m_uID = 0; //Identifier of the mesh (each mesh has a unique UID)
 
 	GLuint m_VAO = 0;			//OpenGL Vertex Array Object
 	GLuint m_VBO = 0;			//OpenGL Vertex Array Object
+	GLuint m_EBO = 0;			//OpenGL Element (index) Buffer Object
+	GLenum m_eIndexType = GL_UNSIGNED_INT; //GL_UNSIGNED_SHORT when the welded vertices fit in 16 bits
+	int m_nVertexFormat = VERTEXFORMAT_COMPACT; //BTO_VERTEXFORMAT flags of the vertex buffer
 
 	GLuint m_nShader = 0;	//Index of the shader
+	GLuint m_nShaderWire = 0;	//Index of the wireframe shader
 
 	vector3 m_v3Tint = vector3(1, 1, 1); //Color modifier
 	vector3 m_v3Wireframe = vector3(0, 1, 0); //color of the wireframe
 
-	std::vector<vector3> m_lVertex; //Composed vertex array
+	std::vector<vector3> m_lVertex; //Composed vertex array (welded, 6 entries per vertex)
+	std::vector<uint> m_lIndex; //Triangle lists of all the levels of detail indexing m_lVertex, in vertex cache order
 	std::vector<vector3> m_lVertexPos;	//List of Vertices
 	std::vector<vector3> m_lVertexCol;	//List of Colors
 	std::vector<vector3> m_lVertexNor;	//List of Normals
@@ -75,6 +97,52 @@ protected:
 	OUTPUT: ---
 	*/
 	void DisconnectOpenGL3X(void);
+	/*
+	USAGE: Composes m_lVertex with one entry per distinct vertex and fills m_lIndex
+	with the triangle list that rebuilds the original vertices
+	ARGUMENTS: ---
+	OUTPUT: number of distinct vertices
+	*/
+	uint WeldVertices(void);
+	/*
+	USAGE: Reorders the triangles for the post transform vertex cache (Forsyth's
+	linear speed optimizer)
+	ARGUMENTS:
+	- std::vector<uint>& a_lIndex -> triangle list to reorder
+	- uint a_uUniqueCount -> number of vertices it indexes
+	OUTPUT: ---
+	*/
+	static void OptimizeVertexCache(std::vector<uint>& a_lIndex, uint a_uUniqueCount);
+	/*
+	USAGE: Renumbers the vertices in order of first use in m_lIndex
+	ARGUMENTS: ---
+	OUTPUT: ---
+	*/
+	void OptimizeVertexFetch(void);
+	/*
+	USAGE: Appends to m_lIndex simplified versions of the first level of detail made by quadric
+	edge collapses, each with about half the triangles of the previous one, stops early
+	when a level would move the surface too much
+	ARGUMENTS:
+	- uint a_uUniqueCount -> number of vertices in m_lVertex
+	OUTPUT: ---
+	*/
+	void GenerateLOD(uint a_uUniqueCount);
+	/*
+	USAGE: Encodes m_lVertex in the vertex format, uploads it to the VBO and points the
+	attributes of the VAO to it
+	ARGUMENTS: ---
+	OUTPUT: ---
+	*/
+	void UploadVertices(void);
+	/*
+	USAGE: Describes the interleaved layout of a vertex format
+	ARGUMENTS:
+	- int a_nFormat -> BTO_VERTEXFORMAT flags
+	- VertexAttribute* a_pAttribute -> ATTRIBUTE_COUNT entries, filled in BTO_ATTRIBUTE order
+	OUTPUT: size of a vertex in bytes
+	*/
+	static uint GetVertexLayout(int a_nFormat, VertexAttribute* a_pAttribute);
 #pragma endregion
 #pragma region Mesh Initialization
 	/*
@@ -112,9 +180,10 @@ protected:
 	matrix4 a_mView -> View matrix
 	float* a_fMatrixArray -> Array of matrices that represent positions
 	int a_nInstances -> Number of instances to display
+	uint a_uLOD -> level of detail to draw
 	OUTPUT: ---
 	*/
-	virtual void RenderWire(matrix4 a_mProjection, matrix4 a_mView, float* a_fMatrixArray, int a_nInstances);
+	virtual void RenderWire(matrix4 a_mProjection, matrix4 a_mView, float* a_fMatrixArray, int a_nInstances, uint a_uLOD);
 	/*
 	USAGE: Renders the mesh a_nInstances number of times on the specified positions by the a_fMatrixArray and by the
 	provided camera view and projection
@@ -124,9 +193,12 @@ protected:
 	float* a_fMatrixArray -> Array of matrices that represent positions
 	int a_nInstances -> Number of instances to display
 	vector3 a_v3CameraPosition -> Position of the camera in world space
+	uint a_uLOD -> level of detail to draw
+	vector4* a_v4ColorArray -> color of each instance, nullptr (or the uniform path) keeps the vertex colors
 	OUTPUT: ---
 	*/
-	virtual void RenderSolid(matrix4 a_mProjection, matrix4 a_mView, float* a_fMatrixArray, int a_nInstances, vector3 a_v3CameraPosition);
+	virtual void RenderSolid(matrix4 a_mProjection, matrix4 a_mView, float* a_fMatrixArray, int a_nInstances, vector3 a_v3CameraPosition, uint a_uLOD,
+		vector4* a_v4ColorArray = nullptr);
 #pragma endregion
 public:
 	/*
@@ -176,14 +248,17 @@ public:
 	*/
 	void CompileOpenGL3X(void);
 	/*
-	USAGE: Completes the triangle information
+	USAGE: Completes the triangle information, missing normals are the face normals and
+	missing tangents and binormals are calculated from the UVs
 	ARGUMENTS:
 	- bool a_bAverageNormals = false -> soften the edges of the model
+	- float a_fCreaseAngle = 180.0f -> degrees between faces sharing a vertex above which the
+	edge is kept hard when averaging
 	OUTPUT: ---
 	*/
-	void CompleteTriangleInfo(bool a_bAverageNormals = false);
+	void CompleteTriangleInfo(bool a_bAverageNormals = false, float a_fCreaseAngle = 180.0f);
 	/*
-	USAGE: Calculates the missing tangents
+	USAGE: Calculates the tangents and binormals again
 	ARGUMENTS: ---
 	OUTPUT: ---
 	*/
@@ -198,10 +273,14 @@ public:
 	int a_nInstances -> Number of instances to display
 	vector3 a_v3CameraPosition -> Position of the camera in world space
 	int a_RenderOption = BTO_RENDER::SOLID -> Render options SOLID | WIRE
+	uint a_uLOD = 0 -> level of detail to draw, clamped to the ones generated
+	vector4* a_v4ColorArray = nullptr -> color of each instance for the solid pass, alpha is how much of it
+	replaces the vertex color, only read when the instances are streamed
 	OUTPUT: ---
 	*/
 	virtual void Render(matrix4 a_mProjection, matrix4 a_mView, float* a_fMatrixArray, int a_nInstances,
-		vector3 a_v3CameraPosition = vector3(0), int a_RenderOption = BTO_RENDER::RENDER_SOLID);
+		vector3 a_v3CameraPosition = vector3(0), int a_RenderOption = BTO_RENDER::RENDER_SOLID, uint a_uLOD = 0,
+		vector4* a_v4ColorArray = nullptr);
 	/*
 	USAGE: Renders the mesh a_nInstances number of times on the specified positions by the a_fMatrixArray and by the
 	provided camera view and projection
@@ -498,6 +577,44 @@ public:
 	*/
 	GLuint GetVBO(void);
 	/*
+	USAGE: returns the index buffer of the mesh
+	ARGUMENTS: ---
+	OUTPUT: EBO
+	*/
+	GLuint GetEBO(void);
+	/*
+	USAGE: Returns the number of indices drawn, 3 per triangle
+	ARGUMENTS: ---
+	OUTPUT: number of indices
+	*/
+	uint GetIndexCount(void);
+	/*
+	USAGE: Returns the number of levels of detail, the first one is the full mesh
+	ARGUMENTS: ---
+	OUTPUT: levels of detail
+	*/
+	uint GetLODCount(void);
+	/*
+	USAGE: Returns the distance from the origin of the mesh to its furthest vertex
+	ARGUMENTS: ---
+	OUTPUT: radius
+	*/
+	float GetRadius(void);
+	/*
+	USAGE: Returns the encoding of the vertex buffer
+	ARGUMENTS: ---
+	OUTPUT: BTO_VERTEXFORMAT flags
+	*/
+	int GetVertexFormat(void);
+	/*
+	USAGE: Sets the encoding of the vertex buffer, a compiled mesh is uploaded again,
+	copies of a mesh share its buffer and cannot change it
+	ARGUMENTS:
+	- int a_nFormat -> BTO_VERTEXFORMAT flags
+	OUTPUT: ---
+	*/
+	void SetVertexFormat(int a_nFormat);
+	/*
 	USAGE: Returns the unique identifier of the mesh
 	ARGUMENTS: ---
 	OUTPUT: ---
@@ -35,17 +35,18 @@ void MeshManager::Release(void)
 			pMesh = nullptr;
 		}
 	}
-	for (uint i = 0; i < uMeshCount; ++i)
-	{
-		std::vector<MeshOptions>* meshOptions = m_renderOptionsList[i];
-		if (meshOptions)
-		{
-			delete meshOptions;
-			meshOptions = nullptr;
-		}
-	}
-	m_renderOptionsList.clear();
+	m_meshList.clear();
+	m_lRenderQueue.clear();
+	m_lRenderQueueScratch.clear();
+	m_lTransform.clear();
+	m_lTransformSorted.clear();
+	m_lColor.clear();
+	m_lColorSorted.clear();
+	m_mInstanceLOD.clear();
+	m_mInstanceLODNext.clear();
 	m_meshNames.clear();
+	InstanceBuffer::ReleaseInstance();
+	GLState::ReleaseInstance();
 }
 MeshManager* MeshManager::GetInstance()
 {
@@ -413,8 +414,6 @@ int MeshManager::AddMesh(Mesh* a_pMesh)
 	}
 	a_pMesh->SetName(sName);
 	m_meshList.push_back(a_pMesh);
-	std::vector<MeshOptions>* meshOptions = new std::vector<MeshOptions>();
-	m_renderOptionsList.push_back(meshOptions);
 	m_meshNames[a_pMesh->GetName()] = m_meshList.size() - 1;
 	return m_meshList.size() - 1;
 }
@@ -469,10 +468,10 @@ int MeshManager::GetMeshIndex(String a_sName)
 }
 void MeshManager::ClearRenderList(void)
 {
-	for (auto it = m_renderOptionsList.begin(); it != m_renderOptionsList.end(); ++it)
-	{
-		(*it)->clear();
-	}
+	//clear keeps the capacity so a steady frame does not allocate
+	m_lRenderQueue.clear();
+	m_lTransform.clear();
+	m_lColor.clear();
 	Mesh::ResetRenderCallCount();
 }
 void MeshManager::CompileMesh(uint a_nMeshIndex)
@@ -481,50 +480,38 @@ void MeshManager::CompileMesh(uint a_nMeshIndex)
 		return;
 	m_meshList[a_nMeshIndex]->CompileOpenGL3X();
 }
-void MeshManager::AddMeshToRenderList(uint a_nIndex, matrix4 a_m4Transform, int a_Render)
+void MeshManager::AddMeshToRenderList(uint a_nIndex, matrix4 a_m4Transform, int a_Render, vector4 a_v4Color, uint a_uInstanceID)
 {
 	//Id the index is larger than the number of meshes we know about return
 	if (a_nIndex >= m_meshList.size())
 		return;
 
-	//we create a new options object and store the information provided
-	MeshOptions options(a_m4Transform, a_Render);
+	//nothing to draw
+	if (a_Render == RENDER_NONE)
+		return;
 
-	//Get the list of options for this mesh
-	//std::vector<MeshOptions>* optionsList = m_MeshOptionsList[a_nIndex];
-	//optionsList->push_back(options);
-	(m_renderOptionsList[a_nIndex])->push_back(options);
-	/*
-	//look the map to see if we have options for the specified mesh
-	auto var = m_mRender.find(a_sMeshName);
-	//if we found the mesh in the map
-	if (var != m_mRender.end())
-	{
-	lOptions = var->second; //we get the existing options for that mesh
-	}
-	else //this entry on the map was not allocated yet
-	{
-	lOptions = new std::vector<MeshOptions>(); //so we allocate new space for it
-	}
-	//we add the new options to the list (if it was empty this will be the first entry)
-	lOptions->push_back(options);
-	//we assign the transform to the place in the map
-	m_mRender[a_sMeshName] = lOptions;
-	*/
+	//store the transform and color and queue an item pointing to them
+	RenderItem item;
+	item.m_uKey = MakeRenderKey(a_nIndex, a_Render);
+	item.m_uTransform = static_cast<uint>(m_lTransform.size());
+	item.m_uInstanceID = a_uInstanceID;
+	m_lTransform.push_back(a_m4Transform);
+	m_lColor.push_back(a_v4Color);
+	m_lRenderQueue.push_back(item);
 }
-void MeshManager::AddMeshToRenderList(String a_sMeshName, matrix4 a_m4Transform, int a_Render)
+void MeshManager::AddMeshToRenderList(String a_sMeshName, matrix4 a_m4Transform, int a_Render, vector4 a_v4Color, uint a_uInstanceID)
 {
 	int nMeshIndex = GetMeshIndex(a_sMeshName);
 	if (nMeshIndex < 0)
 		return;
 
-	AddMeshToRenderList(nMeshIndex, a_m4Transform, a_Render);
+	AddMeshToRenderList(nMeshIndex, a_m4Transform, a_Render, a_v4Color, a_uInstanceID);
 }
-void MeshManager::AddMeshToRenderList(Mesh* a_pMesh, matrix4 a_m4Transform, int a_Render)
+void MeshManager::AddMeshToRenderList(Mesh* a_pMesh, matrix4 a_m4Transform, int a_Render, vector4 a_v4Color, uint a_uInstanceID)
 {
 	if (!a_pMesh)
 		return;
-	AddMeshToRenderList(a_pMesh->GetName(), a_m4Transform, a_Render);
+	AddMeshToRenderList(a_pMesh->GetName(), a_m4Transform, a_Render, a_v4Color, a_uInstanceID);
 
 	/*
 	//we create a new options object and store the information provided
@@ -551,106 +538,166 @@ void MeshManager::AddMeshToRenderList(Mesh* a_pMesh, matrix4 a_m4Transform, int
 	m_mRender[a_pMesh->GetName()] = lOptions;
 	*/
 }
-uint MeshManager::Render(void)
+uint64_t MeshManager::MakeRenderKey(uint a_uMeshIndex, int a_nRender)
 {
-	//for each element in map check the rendering type
-	uint nMeshCount = m_meshList.size();
-	std::vector<matrix4> solidList;
-	std::vector<matrix4> wireList;
-	std::vector<matrix4> bothList;
-	std::vector<MeshOptions>* optionList;
-	for (uint nMesh = 0; nMesh < nMeshCount; ++nMesh)
+	Mesh* pMesh = m_meshList[a_uMeshIndex];
+	uint64_t uShader = pMesh->GetShaderIndex() & 0xFFFF;
+	uint64_t uMaterial = static_cast<uint>(pMesh->GetMaterialIndex()) & 0xFFFF;
+	uint64_t uMesh = a_uMeshIndex & 0xFFFFFF;
+	uint64_t uRender = a_nRender & 0x0F;
+	return (uShader << 48) | (uMaterial << 32) | (uMesh << 8) | uRender;
+}
+void MeshManager::SelectLOD(matrix4 a_m4Projection, vector3 a_v3CameraPosition)
+{
+	m_mInstanceLODNext.clear();
+
+	//an orthographic projection does not shrink with distance
+	bool bPerspective = a_m4Projection[3][3] == 0.0f;
+	float fFocal = a_m4Projection[1][1];
+
+	uint uCount = static_cast<uint>(m_lRenderQueue.size());
+	for (uint i = 0; i < uCount; ++i)
 	{
-		optionList = m_renderOptionsList[nMesh];
-		if (optionList->size() > 0)
+		RenderItem& item = m_lRenderQueue[i];
+		uint uMesh = static_cast<uint>((item.m_uKey >> 8) & 0xFFFFFF);
+		Mesh* pMesh = m_meshList[uMesh];
+		uint uLODCount = pMesh->GetLODCount();
+		if (uLODCount < 2)
+			continue;
+
+		//radius of the mesh on screen, as a fraction of half the screen height
+		const matrix4& m4Transform = m_lTransform[item.m_uTransform];
+		float fScale = std::max(glm::length(vector3(m4Transform[0])),
+			std::max(glm::length(vector3(m4Transform[1])), glm::length(vector3(m4Transform[2]))));
+		float fRadius = pMesh->GetRadius() * fScale;
+		float fSize = fRadius * fFocal;
+		if (bPerspective)
 		{
-			//The idea is to know what each mesh will be rendered as and store the matrix in a list
-			//that way we will have 3 separate calls each for a render mode
-			for (uint nOpt = 0; nOpt < optionList->size(); ++nOpt)
-			{
-				switch ((*optionList)[nOpt].m_nRender)
-				{
-				case RENDER_NONE:
-					break;
-				case RENDER_SOLID:
-					solidList.push_back((*optionList)[nOpt].m_m4Transform);
-					break;
-				case RENDER_WIRE:
-					wireList.push_back((*optionList)[nOpt].m_m4Transform);
-					break;
-				default:
-					bothList.push_back((*optionList)[nOpt].m_m4Transform);
-					break;
-				}
-			}
-			//For Solids ---------------------------------------------------------------------------
-			int nSolids = solidList.size();//count elements
-			if (nSolids > 0)
-			{
-				float* fSolidArray = new float[16 * nSolids];//reserve memory
-															 //memcpy the translated values to the array (way faster than copy element by element)
-				for (int nSolid = 0; nSolid < nSolids; ++nSolid)
-				{
-					const float* m4MVP = glm::value_ptr(solidList[nSolid]);
-					memcpy(&fSolidArray[nSolid * 16], m4MVP, 16 * sizeof(float));
-				}
-				//render
-				m_meshList[nMesh]->Render(m_pCameraMngr->GetProjectionMatrix(), m_pCameraMngr->GetViewMatrix(),
-					fSolidArray, solidList.size(), m_pCameraMngr->GetPosition(), RENDER_SOLID);
-				//deallocate memory
-				if (fSolidArray)
-				{
-					delete[] fSolidArray;
-					fSolidArray = nullptr;
-				}
-				solidList.clear();
-			}
-			//For Wires ---------------------------------------------------------------------------
-			int nWires = wireList.size();//count elements
-			if (nWires > 0)
-			{
-				float* fWireArray = new float[16 * nWires];//reserve memory
-														   //memcpy the translated values to the array (way faster than copy element by element)
-				for (int nWire = 0; nWire < nWires; ++nWire)
-				{
-					const float* m4MVP = glm::value_ptr(wireList[nWire]);
-					memcpy(&fWireArray[nWire * 16], m4MVP, 16 * sizeof(float));
-				}
-				//render
-				m_meshList[nMesh]->Render(m_pCameraMngr->GetProjectionMatrix(), m_pCameraMngr->GetViewMatrix(),
-					fWireArray, wireList.size(), m_pCameraMngr->GetPosition(), RENDER_WIRE);
-				//deallocate memory
-				if (fWireArray)
-				{
-					delete[] fWireArray;
-					fWireArray = nullptr;
-				}
-				wireList.clear();
-			}
-			//For Both ---------------------------------------------------------------------------
-			int nBoths = bothList.size();//count elements
-			if (nBoths > 0)
+			float fDistance = glm::distance(vector3(m4Transform[3]), a_v3CameraPosition);
+			fSize = fDistance > fRadius ? fSize / fDistance : fFocal;
+		}
+
+		//only an identified instance remembers its level, the rest pick it fresh every frame
+		bool bIdentified = item.m_uInstanceID != m_uNoInstanceID;
+		uint64_t uInstance = (static_cast<uint64_t>(uMesh) << 32) | item.m_uInstanceID;
+		uint uLOD = 0;
+		float fHysteresis = 0.0f;
+		if (bIdentified)
+		{
+			auto previous = m_mInstanceLOD.find(uInstance);
+			if (previous != m_mInstanceLOD.end())
 			{
-				float* fBothArray = new float[16 * nBoths];//reserve memory
-														   //memcpy the translated values to the array (way faster than copy element by element)
-				for (int nBoth = 0; nBoth < nBoths; ++nBoth)
-				{
-					const float* m4MVP = glm::value_ptr(bothList[nBoth]);
-					memcpy(&fBothArray[nBoth * 16], m4MVP, 16 * sizeof(float));
-				}
-				//render
-				m_meshList[nMesh]->Render(m_pCameraMngr->GetProjectionMatrix(), m_pCameraMngr->GetViewMatrix(),
-					fBothArray, bothList.size(), m_pCameraMngr->GetPosition(), RENDER_SOLID | RENDER_WIRE);
-				//deallocate memory
-				if (fBothArray)
-				{
-					delete[] fBothArray;
-					fBothArray = nullptr;
-				}
-				bothList.clear();
+				uLOD = std::min(previous->second, uLODCount - 1);
+				fHysteresis = m_fLODHysteresis;
 			}
 		}
+		while (uLOD + 1 < uLODCount && fSize < m_fLODSize[uLOD] * (1.0f - fHysteresis))
+			++uLOD;
+		while (uLOD > 0 && fSize > m_fLODSize[uLOD - 1] * (1.0f + fHysteresis))
+			--uLOD;
+		if (bIdentified)
+			m_mInstanceLODNext[uInstance] = uLOD;
+		item.m_uKey |= static_cast<uint64_t>(uLOD) << 4;
 	}
+
+	//instances that were not submitted this frame are forgotten
+	std::swap(m_mInstanceLOD, m_mInstanceLODNext);
+}
+void MeshManager::SortRenderQueue(void)
+{
+	uint uCount = static_cast<uint>(m_lRenderQueue.size());
+	if (uCount < 2)
+		return;
+	m_lRenderQueueScratch.resize(uCount);
+
+	//one histogram per byte of the key, all built in a single pass
+	uint uHistogram[8][256] = {};
+	for (uint i = 0; i < uCount; ++i)
+	{
+		uint64_t uKey = m_lRenderQueue[i].m_uKey;
+		for (uint uByte = 0; uByte < 8; ++uByte)
+			++uHistogram[uByte][(uKey >> (uByte * 8)) & 0xFF];
+	}
+
+	//least significant byte first, each pass is stable
+	RenderItem* pSource = m_lRenderQueue.data();
+	RenderItem* pTarget = m_lRenderQueueScratch.data();
+	for (uint uByte = 0; uByte < 8; ++uByte)
+	{
+		uint uShift = uByte * 8;
+		uint* pCount = uHistogram[uByte];
+		//if every key has the same value in this byte the pass would not move anything
+		if (pCount[(pSource[0].m_uKey >> uShift) & 0xFF] == uCount)
+			continue;
+		uint uOffset = 0;
+		for (uint i = 0; i < 256; ++i)
+		{
+			uint uBucket = pCount[i];
+			pCount[i] = uOffset;
+			uOffset += uBucket;
+		}
+		for (uint i = 0; i < uCount; ++i)
+			pTarget[pCount[(pSource[i].m_uKey >> uShift) & 0xFF]++] = pSource[i];
+		std::swap(pSource, pTarget);
+	}
+	//the result ended in the scratch storage, swap the buffers (no copy, no allocation)
+	if (pSource != m_lRenderQueue.data())
+		m_lRenderQueue.swap(m_lRenderQueueScratch);
+}
+uint MeshManager::Render(void)
+{
+	//the application may have changed the state since the last frame
+	GLState* pState = GLState::GetInstance();
+	pState->NextFrame();
+
+	matrix4 m4Projection = m_pCameraMngr->GetProjectionMatrix();
+	matrix4 m4View = m_pCameraMngr->GetViewMatrix();
+	vector3 v3CameraPosition = m_pCameraMngr->GetPosition();
+
+	SelectLOD(m4Projection, v3CameraPosition);
+	SortRenderQueue();
+
+	//gather the transforms and colors in draw order so each run is contiguous, counting the instances
+	//the solid and wire passes will stream
+	uint uCount = static_cast<uint>(m_lRenderQueue.size());
+	m_lTransformSorted.resize(uCount);
+	m_lColorSorted.resize(uCount);
+	uint uStreamed = 0;
+	for (uint i = 0; i < uCount; ++i)
+	{
+		const RenderItem& item = m_lRenderQueue[i];
+		m_lTransformSorted[i] = m_lTransform[item.m_uTransform];
+		m_lColorSorted[i] = m_lColor[item.m_uTransform];
+		uStreamed += ((item.m_uKey & RENDER_SOLID) ? 1 : 0) + ((item.m_uKey & RENDER_WIRE) ? 1 : 0);
+	}
+
+	//make room for the whole frame now, growing the instance buffer in between draws would restart its ring
+	InstanceBuffer::GetInstance()->Reserve(uStreamed);
+
+	//each run of equal keys is the same mesh with the same level of detail and render mode
+	uint uStart = 0;
+	while (uStart < uCount)
+	{
+		uint64_t uKey = m_lRenderQueue[uStart].m_uKey;
+		uint uEnd = uStart + 1;
+		while (uEnd < uCount && m_lRenderQueue[uEnd].m_uKey == uKey)
+			++uEnd;
+
+		uint uMesh = static_cast<uint>((uKey >> 8) & 0xFFFFFF);
+		uint uLOD = static_cast<uint>((uKey >> 4) & 0x0F);
+		int nRender = static_cast<int>(uKey & 0x0F);
+		m_meshList[uMesh]->Render(m4Projection, m4View, glm::value_ptr(m_lTransformSorted[uStart]),
+			uEnd - uStart, v3CameraPosition, nRender, uLOD, &m_lColorSorted[uStart]);
+		uStart = uEnd;
+	}
+
+	//the instances of this frame are streamed, move to the next region of the instance buffer
+	InstanceBuffer::GetInstance()->NextFrame();
 	m_pText->Render();
+
+	//leave the defaults the application expects
+	pState->PolygonMode(GL_FILL);
+	pState->PolygonOffsetLine(false);
+	pState->BindVertexArray(0);
 	return Mesh::GetRenderCallCount();
 }
\ No newline at end of file
@@ -7,13 +7,32 @@ Date: 2015/06
 #include "Mesh.h"
 #include "CameraManager.h"
 #include "Text.h"
+#include <cstdint>
+#include <unordered_map>
+
+//Entry of the render queue, sorted by key so meshes sharing state are drawn together
+struct RenderItem
+{
+	uint64_t m_uKey; //shader (16 bits) | material (16 bits) | mesh (24 bits) | level of detail (4 bits) | render mode (4 bits)
+	uint m_uTransform; //index of the transform (and color) in the lists of submitted ones
+	uint m_uInstanceID; //identifier the caller gave the instance, keeps its level of detail between frames
+};
 
 //MeshManager
 class  MeshManager
 {
 	std::vector<Mesh*> m_meshList; //Lit of all the meshes added to the system
 	std::map<String, uint> m_meshNames; //map of Meshes names and corresponding indices
-	std::vector<std::vector<MeshOptions>*> m_renderOptionsList; //list of options, one for each mesh -> one for each render call
+	std::vector<RenderItem> m_lRenderQueue; //items submitted this frame, sorted in place by Render
+	std::vector<RenderItem> m_lRenderQueueScratch; //ping-pong storage for the radix sort
+	std::vector<matrix4> m_lTransform; //transforms submitted this frame
+	std::vector<matrix4> m_lTransformSorted; //transforms in draw order, handed to the meshes
+	std::vector<vector4> m_lColor; //color of each submitted transform, alpha 0 keeps the vertex colors
+	std::vector<vector4> m_lColorSorted; //colors in draw order, handed to the meshes
+	std::unordered_map<uint64_t, uint> m_mInstanceLOD; //level of detail of each identified instance last frame, by mesh and instance ID
+	std::unordered_map<uint64_t, uint> m_mInstanceLODNext; //levels picked this frame, only for the instances still submitted
+	float m_fLODSize[3] = { 0.25f, 0.12f, 0.05f }; //projected radius (fraction of half the screen height) below which the next level is used
+	float m_fLODHysteresis = 0.15f; //fraction around each size in which an instance keeps its level
 
 	static MeshManager* m_pInstance; // Singleton pointer
 	ShaderManager* m_pShaderMngr = nullptr;	//Shader Manager
@@ -22,6 +41,7 @@ class  MeshManager
 	CameraManager* m_pCameraMngr = nullptr;	//Camera Manager
 	Text* m_pText; //Text Singleton
 public:
+	static const uint m_uNoInstanceID = 0xFFFFFFFF; //instance without an identifier, picks its level of detail every frame
 	//Singleton Methods
 	/*
 	USAGE: Gets/Constructs the singleton pointer
@@ -221,9 +241,13 @@ public:
 	uint a_nIndex -> index of the mesh to apply transform to
 	matrix4 a_m4Transform -> transform to apply
 	int a_Render = SOLID -> render options SOLID | WIRE
+	vector4 a_v4Color = vector4(0.0f) -> color of this instance, alpha is how much of it replaces the
+	vertex color, only drawn when the instances are streamed
+	uint a_uInstanceID = m_uNoInstanceID -> identifier that stays with the instance from frame to frame,
+	only identified instances keep their level of detail near the switching distance
 	OUTPUT: returns the name of the mesh that will render
 	*/
-	void AddMeshToRenderList(uint a_nIndex, matrix4 a_m4Transform, int a_Render = RENDER_SOLID);
+	void AddMeshToRenderList(uint a_nIndex, matrix4 a_m4Transform, int a_Render = RENDER_SOLID, vector4 a_v4Color = vector4(0.0f), uint a_uInstanceID = m_uNoInstanceID);
 	/*
 	USAGE: Applies a transform to display to the specified mesh by name, the mesh will be
 	lookout	for in the map of meshes, using the mesh index if know will result in faster
@@ -232,9 +256,11 @@ public:
 	Strin a_sMeshName -> mesh to apply transform to
 	matrix4 a_m4Transform -> transform to apply
 	int a_Render = SOLID -> render options SOLID | WIRE
+	vector4 a_v4Color = vector4(0.0f) -> color of this instance, see the index version
+	uint a_uInstanceID = m_uNoInstanceID -> identifier of this instance, see the index version
 	OUTPUT: returns the name of the mesh that will render
 	*/
-	void AddMeshToRenderList(String a_sMeshName, matrix4 a_m4Transform, int a_Render = RENDER_SOLID);
+	void AddMeshToRenderList(String a_sMeshName, matrix4 a_m4Transform, int a_Render = RENDER_SOLID, vector4 a_v4Color = vector4(0.0f), uint a_uInstanceID = m_uNoInstanceID);
 	/*
 	USAGE: Applies a transform to display to the specified mesh, the mesh will be lookout
 	for in the map of meshes, using the mesh index if know will result in faster additions
@@ -242,17 +268,20 @@ public:
 	Mesh* a_pMesh -> mesh to apply transform to
 	matrix4 a_m4Transform -> transform to apply
 	int a_Render = SOLID -> render options SOLID | WIRE
+	vector4 a_v4Color = vector4(0.0f) -> color of this instance, see the index version
+	uint a_uInstanceID = m_uNoInstanceID -> identifier of this instance, see the index version
 	OUTPUT: returns the name of the mesh that will render
 	*/
-	void AddMeshToRenderList(Mesh* a_pMesh, matrix4 a_m4Transform, int a_Render = RENDER_SOLID);
+	void AddMeshToRenderList(Mesh* a_pMesh, matrix4 a_m4Transform, int a_Render = RENDER_SOLID, vector4 a_v4Color = vector4(0.0f), uint a_uInstanceID = m_uNoInstanceID);
 	/*
-	USAGE: Clears the map of transforms
+	USAGE: Clears the render queue, the storage is kept for the next frame
 	ARGUMENTS: ---
 	OUTPUT: ---
 	*/
 	void ClearRenderList(void);
 	/*
-	USAGE: Draws all the meshes in the transform map
+	USAGE: Sorts the render queue and draws each run of instances that share mesh and
+	render mode with a single mesh render call
 	ARGUMENTS: ---
 	OUTPUT: number of render calls
 	*/
@@ -340,6 +369,29 @@ private:
 	OUTPUT: ---
 	*/
 	void Release(void);
+	/*
+	USAGE: Builds the sort key of a render queue item
+	ARGUMENTS:
+	uint a_uMeshIndex -> index of the mesh to render
+	int a_nRender -> render options SOLID | WIRE
+	OUTPUT: sort key
+	*/
+	uint64_t MakeRenderKey(uint a_uMeshIndex, int a_nRender);
+	/*
+	USAGE: Picks the level of detail of every item in the render queue from its projected size,
+	an identified instance only changes level when its size is clearly past the threshold so it does not pop
+	ARGUMENTS:
+	matrix4 a_m4Projection -> projection of the camera
+	vector3 a_v3CameraPosition -> position of the camera
+	OUTPUT: ---
+	*/
+	void SelectLOD(matrix4 a_m4Projection, vector3 a_v3CameraPosition);
+	/*
+	USAGE: Radix sorts the render queue by key, items with the same key keep their submission order
+	ARGUMENTS: ---
+	OUTPUT: ---
+	*/
+	void SortRenderQueue(void);
 };
 /*
 USAGE:
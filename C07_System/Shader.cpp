@@ -1,4 +1,16 @@
 #include "Shader.h"
+//Names of the BTO_UNIFORM and BTO_ATTRIBUTE entries, in the same order
+static const char* s_sUniformName[UNIFORM_COUNT] =
+{
+	"VP", "MVP", "m4ModelToWorld", "m4ToWorld", "m4CameraOnWorld",
+	"TextureID", "NormalID", "SpecularID", "nTexture",
+	"LightPosition_W", "LightColor", "LightPower", "AmbientColor", "AmbientPower",
+	"Tint", "CameraPosition_W", "nElements", "vWireframe", "SolidColor",
+};
+static const char* s_sAttributeName[ATTRIBUTE_COUNT] =
+{
+	"Position_b", "Color_b", "UV_b", "Normal_b", "Binormal_b", "Tangent_b",
+};
 void Shader::Init(void)
 {
 	//m_sProgramName;
@@ -10,6 +22,11 @@ void Shader::Init(void)
 	m_sVertexShaderName = "";
 	m_sFragmentShaderName = "";
 	m_nProgram = -1;
+
+	m_mUniform.clear();
+	m_mAttribute.clear();
+	m_lUniform.assign(UNIFORM_COUNT, -1);
+	m_lAttribute.assign(ATTRIBUTE_COUNT, -1);
 }
 void Shader::Swap(Shader& other)
 {
@@ -17,6 +34,10 @@ void Shader::Swap(Shader& other)
 	std::swap( m_sVertexShaderName, other.m_sVertexShaderName);
 	std::swap( m_sFragmentShaderName, other.m_sFragmentShaderName);
 	std::swap( m_nProgram, other.m_nProgram);
+	std::swap( m_mUniform, other.m_mUniform);
+	std::swap( m_mAttribute, other.m_mAttribute);
+	std::swap( m_lUniform, other.m_lUniform);
+	std::swap( m_lAttribute, other.m_lAttribute);
 }
 void Shader::Release(void)
 {
@@ -35,6 +56,10 @@ Shader::Shader(const Shader& other)
 	m_sVertexShaderName = other.m_sVertexShaderName;
 	m_sFragmentShaderName = other.m_sFragmentShaderName;
 	m_nProgram = other.m_nProgram;
+	m_mUniform = other.m_mUniform;
+	m_mAttribute = other.m_mAttribute;
+	m_lUniform = other.m_lUniform;
+	m_lAttribute = other.m_lAttribute;
 }
 Shader& Shader::operator=(const Shader& other)
 {
@@ -61,12 +86,81 @@ GLuint Shader::CompileShader(String a_sVertexShader, String a_sFragmentShader, S
 	m_sVertexShaderName = a_sVertexShader;
 	m_sFragmentShaderName = a_sFragmentShader;
 	m_nProgram = LoadShaders( m_sVertexShaderName.c_str(), m_sFragmentShaderName.c_str() );
+	Reflect();
 
 	return m_nProgram;
 }
+void Shader::Reflect(void)
+{
+	m_mUniform.clear();
+	m_mAttribute.clear();
+	m_lUniform.assign(UNIFORM_COUNT, -1);
+	m_lAttribute.assign(ATTRIBUTE_COUNT, -1);
+
+	if (glIsProgram(m_nProgram) != GL_TRUE)
+		return;
+	GLint nLinked = GL_FALSE;
+	glGetProgramiv(m_nProgram, GL_LINK_STATUS, &nLinked);
+	if (nLinked != GL_TRUE)
+		return;
+
+	GLint nMaxLength = 0;
+	GLint nLength = 0;
+	glGetProgramiv(m_nProgram, GL_ACTIVE_UNIFORM_MAX_LENGTH, &nMaxLength);
+	glGetProgramiv(m_nProgram, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &nLength);
+	if (nLength > nMaxLength)
+		nMaxLength = nLength;
+	std::vector<GLchar> sName(nMaxLength + 1);
+
+	GLint nCount = 0;
+	glGetProgramiv(m_nProgram, GL_ACTIVE_UNIFORMS, &nCount);
+	for (GLint i = 0; i < nCount; ++i)
+	{
+		GLint nSize = 0;
+		GLenum eType = 0;
+		glGetActiveUniform(m_nProgram, i, nMaxLength + 1, &nLength, &nSize, &eType, &sName[0]);
+		String sUniform(&sName[0], nLength);
+		//arrays are reported as "name[0]", the location of the first element is the location of the array
+		size_t uBracket = sUniform.find('[');
+		if (uBracket != String::npos)
+			sUniform = sUniform.substr(0, uBracket);
+		m_mUniform[sUniform] = glGetUniformLocation(m_nProgram, &sName[0]);
+	}
+
+	glGetProgramiv(m_nProgram, GL_ACTIVE_ATTRIBUTES, &nCount);
+	for (GLint i = 0; i < nCount; ++i)
+	{
+		GLint nSize = 0;
+		GLenum eType = 0;
+		glGetActiveAttrib(m_nProgram, i, nMaxLength + 1, &nLength, &nSize, &eType, &sName[0]);
+		String sAttribute(&sName[0], nLength);
+		m_mAttribute[sAttribute] = glGetAttribLocation(m_nProgram, &sName[0]);
+	}
+
+	for (uint i = 0; i < UNIFORM_COUNT; ++i)
+		m_lUniform[i] = GetUniformLocation(s_sUniformName[i]);
+	for (uint i = 0; i < ATTRIBUTE_COUNT; ++i)
+		m_lAttribute[i] = GetAttributeLocation(s_sAttributeName[i]);
+}
 
 //Attributes
 String Shader::GetProgramName() { return m_sProgramName; }
 String Shader::GetVertexShaderName() { return m_sVertexShaderName; }
 String Shader::GetFragmentShaderName() { return m_sFragmentShaderName; }
 int Shader::GetProgramID() { return m_nProgram; }
+const GLint* Shader::GetUniformTable(void) { return &m_lUniform[0]; }
+const GLint* Shader::GetAttributeTable(void) { return &m_lAttribute[0]; }
+GLint Shader::GetUniformLocation(String a_sName)
+{
+	auto var = m_mUniform.find(a_sName);
+	if (var != m_mUniform.end())
+		return var->second;
+	return -1;
+}
+GLint Shader::GetAttributeLocation(String a_sName)
+{
+	auto var = m_mAttribute.find(a_sName);
+	if (var != m_mAttribute.end())
+		return var->second;
+	return -1;
+}
@@ -14,6 +14,11 @@ class Shader
 	String m_sVertexShaderName = "NULL";
 	String m_sFragmentShaderName = "NULL";
 	GLuint m_nProgram = 0;
+
+	std::map<String, GLint> m_mUniform; //location of every active uniform by name
+	std::map<String, GLint> m_mAttribute; //location of every active attribute by name
+	std::vector<GLint> m_lUniform; //location of each BTO_UNIFORM, -1 if the program does not use it
+	std::vector<GLint> m_lAttribute; //location of each BTO_ATTRIBUTE, -1 if the program does not use it
 public:
 	/*
 	USAGE:
@@ -76,6 +81,32 @@ public:
 	*/
 	int GetProgramID(void);
 	/*
+	USAGE: Returns the table of engine uniform locations, index it with BTO_UNIFORM
+	ARGUMENTS: ---
+	OUTPUT: UNIFORM_COUNT locations, -1 for the ones not used by the program
+	*/
+	const GLint* GetUniformTable(void);
+	/*
+	USAGE: Returns the table of attribute locations, index it with BTO_ATTRIBUTE
+	ARGUMENTS: ---
+	OUTPUT: ATTRIBUTE_COUNT locations, -1 for the ones not used by the program
+	*/
+	const GLint* GetAttributeTable(void);
+	/*
+	USAGE: Looks for the location of an active uniform without asking the driver
+	ARGUMENTS:
+	-	String a_sName -> name of the uniform (arrays without "[0]")
+	OUTPUT: location, -1 if not active
+	*/
+	GLint GetUniformLocation(String a_sName);
+	/*
+	USAGE: Looks for the location of an active attribute without asking the driver
+	ARGUMENTS:
+	-	String a_sName -> name of the attribute
+	OUTPUT: location, -1 if not active
+	*/
+	GLint GetAttributeLocation(String a_sName);
+	/*
 	USAGE:
 	ARGUMENTS: ---
 	OUTPUT: ---
@@ -89,6 +120,13 @@ protected:
 	OUTPUT: ---
 	*/
 	void Init(void);
+	/*
+	USAGE: Enumerates the active uniforms and attributes of the linked program and
+	fills the location tables
+	ARGUMENTS: ---
+	OUTPUT: ---
+	*/
+	void Reflect(void);
 
 };
 
@@ -24,6 +24,15 @@ void ShaderManager::Init(void)
 	//Compile Simplex shader
 	CompileShader(pFolder->GetFolderShaders() + "Simplex.vs", pFolder->GetFolderShaders() + "Simplex.fs", "Simplex");
 
+	//Compile BasicColor shader (used by the generated shapes)
+	CompileShader(pFolder->GetFolderShaders() + "Basic-Instanced.vs", pFolder->GetFolderShaders() + "BasicColor.fs", "BasicColor");
+
+	//Compile the variants that read the instances from the instance buffer instead of uniform arrays
+	CompileShader(pFolder->GetFolderShaders() + "Simplex-InstancedVBO.vs", pFolder->GetFolderShaders() + "Wireframe.fs", "Wireframe_VBO");
+	CompileShader(pFolder->GetFolderShaders() + "Simplex-InstancedVBO.vs", pFolder->GetFolderShaders() + "Simplex.fs", "Simplex_VBO");
+	CompileShader(pFolder->GetFolderShaders() + "Basic-InstancedVBO.vs", pFolder->GetFolderShaders() + "BasicColor.fs", "BasicColor_VBO");
+	CompileShader(pFolder->GetFolderShaders() + "Text-InstancedVBO.vs", pFolder->GetFolderShaders() + "Text.fs", "Text_VBO");
+
 	printf("\n");
 }
 void ShaderManager::Release(void)
@@ -35,6 +44,8 @@ void ShaderManager::Release(void)
 	}
 
 	m_vShader.clear();
+	m_mInstanced.clear();
+	m_lProgramIndex.clear();
 }
 ShaderManager* ShaderManager::GetInstance()
 {
@@ -68,6 +79,13 @@ GLuint ShaderManager::CompileShader(String a_sVertexShader, String a_sFragmentSh
 	printf("Compiling shader: %s\n", a_sName.c_str());
 	nShader = vShader.CompileShader(a_sVertexShader, a_sFragmentShader, a_sName);
 	m_vShader.push_back(vShader);
+	if (vShader.GetProgramID() > 0)
+	{
+		uint uProgram = static_cast<uint>(vShader.GetProgramID());
+		if (uProgram >= m_lProgramIndex.size())
+			m_lProgramIndex.resize(uProgram + 1, -1);
+		m_lProgramIndex[uProgram] = m_uShaderCount;
+	}
 	m_map[vShader.GetProgramName()] = m_uShaderCount;
 	m_uShaderCount++;
 
@@ -95,4 +113,40 @@ GLuint ShaderManager::GetShaderID(uint a_uIndex)
 		return 0;
 
 	return m_vShader[a_uIndex].GetProgramID();
+}
+GLuint ShaderManager::GetInstancedShaderID(GLuint a_uShaderID)
+{
+	if (a_uShaderID == 0)
+		return 0;
+
+	//look in the cache first
+	auto var = m_mInstanced.find(a_uShaderID);
+	if (var != m_mInstanced.end())
+		return var->second;
+
+	GLuint uVariant = 0;
+	if (a_uShaderID < m_lProgramIndex.size() && m_lProgramIndex[a_uShaderID] >= 0)
+		uVariant = GetShaderID(m_vShader[m_lProgramIndex[a_uShaderID]].GetProgramName() + "_VBO");
+	m_mInstanced[a_uShaderID] = uVariant;
+	return uVariant;
+}
+const GLint* ShaderManager::GetUniformTable(GLuint a_uShaderID)
+{
+	static std::vector<GLint> lNone(UNIFORM_COUNT, -1);
+	if (a_uShaderID >= m_lProgramIndex.size() || m_lProgramIndex[a_uShaderID] < 0)
+		return &lNone[0];
+	return m_vShader[m_lProgramIndex[a_uShaderID]].GetUniformTable();
+}
+const GLint* ShaderManager::GetAttributeTable(GLuint a_uShaderID)
+{
+	static std::vector<GLint> lNone(ATTRIBUTE_COUNT, -1);
+	if (a_uShaderID >= m_lProgramIndex.size() || m_lProgramIndex[a_uShaderID] < 0)
+		return &lNone[0];
+	return m_vShader[m_lProgramIndex[a_uShaderID]].GetAttributeTable();
+}
+GLint ShaderManager::GetUniformLocation(GLuint a_uShaderID, String a_sName)
+{
+	if (a_uShaderID >= m_lProgramIndex.size() || m_lProgramIndex[a_uShaderID] < 0)
+		return -1;
+	return m_vShader[m_lProgramIndex[a_uShaderID]].GetUniformLocation(a_sName);
 }
\ No newline at end of file
@@ -18,6 +18,8 @@ class  ShaderManager
 
 	std::vector<Shader> m_vShader; //vector of shaders
 	std::map<String, int> m_map;//Indexer of Shaders
+	std::map<GLuint, GLuint> m_mInstanced;//program identifier -> identifier of its instance attribute variant
+	std::vector<int> m_lProgramIndex;//program identifier -> index in the vector of shaders, -1 if unknown
 
 public:
 	/* Singleton accessor */
@@ -73,6 +75,39 @@ public:
 	OUTPUT:
 	*/
 	int IdentifyShader(String a_sName);
+	/* Asks for the variant of a program that reads the instances from vertex attributes */
+	/*
+	USAGE: The variant is compiled under the same name followed by "_VBO"
+	ARGUMENTS:
+	-	GLuint a_uShaderID -> OpenGL identifier of the uniform array program
+	OUTPUT: OpenGL identifier of the variant, 0 if there is none
+	*/
+	GLuint GetInstancedShaderID(GLuint a_uShaderID);
+	/* Asks for the uniform locations of a program, resolved when it was linked */
+	/*
+	USAGE: Index the result with BTO_UNIFORM, the pointer is valid until another shader is compiled
+	ARGUMENTS:
+	-	GLuint a_uShaderID -> OpenGL identifier of the program
+	OUTPUT: UNIFORM_COUNT locations, all -1 if the program is unknown
+	*/
+	const GLint* GetUniformTable(GLuint a_uShaderID);
+	/* Asks for the attribute locations of a program, resolved when it was linked */
+	/*
+	USAGE: Index the result with BTO_ATTRIBUTE, the pointer is valid until another shader is compiled
+	ARGUMENTS:
+	-	GLuint a_uShaderID -> OpenGL identifier of the program
+	OUTPUT: ATTRIBUTE_COUNT locations, all -1 if the program is unknown
+	*/
+	const GLint* GetAttributeTable(GLuint a_uShaderID);
+	/* Asks for the location of any active uniform of a program by name */
+	/*
+	USAGE: Reads the reflected table instead of asking the driver, not meant for every draw
+	ARGUMENTS:
+	-	GLuint a_uShaderID -> OpenGL identifier of the program
+	-	String a_sName -> name of the uniform
+	OUTPUT: location, -1 if not active or the program is unknown
+	*/
+	GLint GetUniformLocation(GLuint a_uShaderID, String a_sName);
 
 private:
 	/* Constructor */
@@ -9,18 +9,34 @@ void Text::Init(void)
 	m_sFont;
 
 	m_bBinded = false;
-	m_uVertexCount = 0;
 	m_uMaterialIndex = -1;
 
 	m_vao = 0;
 	m_VBO = 0;
-	
-	m_nShader = 0;
+	m_GlyphVBO = 0;
+
+	m_bPersistent = false;
+	m_pData = nullptr;
+	m_uCapacity = 0;
+	m_uRegion = 0;
+	m_uBoundRegion = -1;
+	m_uUploadCount = 0;
+	for (uint i = 0; i < m_uRegionCount; ++i)
+		m_pFence[i] = nullptr;
+
+	//the font is a 10x10 grid starting at the space, top row first
+	for (uint uGlyph = 0; uGlyph < m_uGlyphCount; ++uGlyph)
+	{
+		float fColumn = static_cast<float>(uGlyph % 10);
+		float fRow = static_cast<float>(uGlyph / 10);
+		m_v4GlyphUV[uGlyph] = vector4(0.1f * fColumn, 0.9f - 0.1f * fRow, 0.1f + 0.1f * fColumn, 1.0f - 0.1f * fRow);
+	}
 
 	m_pSystem = SystemSingleton::GetInstance();
 	m_pMatMngr = MaterialManager::GetInstance();
 	m_pShaderMngr = ShaderManager::GetInstance();
-	m_nShader = m_pShaderMngr->GetShaderID("Text");//Compile Text shader
+	m_nShader = m_pShaderMngr->GetInstancedShaderID(m_pShaderMngr->GetShaderID("Text"));//Text shader reading the glyph records
+	m_nTextureID = m_pShaderMngr->GetUniformTable(m_nShader)[UNIFORM_TEXTURE];
 	m_v3Head = ZERO_V3;
 	SetFont("Font.png");	
 	CompileOpenGL3X();
@@ -30,15 +46,45 @@ void Text::Release(void)
 	m_pMatMngr = nullptr;
 	m_pShaderMngr = nullptr;
 
+	ReleaseRing();
+
 	if (m_VBO > 0)
 		glDeleteBuffers(1, &m_VBO);
 
 	if (m_vao > 0)
 		glDeleteVertexArrays(1, &m_vao);
 
-	m_lVertexPos.clear();
-	m_lVertexCol.clear();
-	m_lVertexUV.clear();
+	//the deleted names could be cached as bound
+	GLState::GetInstance()->Invalidate();
+
+	m_lGlyph.clear();
+}
+void Text::ReleaseRing(void)
+{
+	for (uint i = 0; i < m_uRegionCount; ++i)
+	{
+		if (m_pFence[i])
+		{
+			glDeleteSync(m_pFence[i]);
+			m_pFence[i] = nullptr;
+		}
+		m_lRegionGlyph[i].clear();
+	}
+	if (m_GlyphVBO > 0)
+	{
+		GLState* pState = GLState::GetInstance();
+		if (m_pData)
+		{
+			pState->BindArrayBuffer(m_GlyphVBO);
+			glUnmapBuffer(GL_ARRAY_BUFFER);
+		}
+		pState->BindArrayBuffer(0);
+		glDeleteBuffers(1, &m_GlyphVBO);
+		m_GlyphVBO = 0;
+	}
+	m_pData = nullptr;
+	m_uCapacity = 0;
+	m_uBoundRegion = -1;
 }
 void Text::SetFont(String a_sTextureName)
 {
@@ -76,124 +122,213 @@ Text::Text(){	Init(); }
 Text::Text(Text const& other){ }
 Text& Text::operator=(Text const& other){ return *this; }
 Text::~Text(){ Release(); };
+//Accessors
+uint Text::GetUploadCount(void) { return m_uUploadCount; }
 //Methods
 void Text::CompileOpenGL3X(void)
 {
-	if (m_bBinded)
+	if (m_bBinded || m_nShader == 0)
 		return;
 
+	GLState* pState = GLState::GetInstance();
+
 	// Create a vertex array object
 	glGenVertexArrays(1, &m_vao);
-	glBindVertexArray(m_vao);
+	pState->BindVertexArray(m_vao);
 
-	// Create and initialize a buffer object for each shape.
+	// Every glyph is the same quad, drawn as a strip and stretched to its rectangle by the shader
+	const float fCorner[8] = { 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f };
 	glGenBuffers(1, &m_VBO);
+	pState->BindArrayBuffer(m_VBO);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(fCorner), fCorner, GL_STATIC_DRAW);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, (void*)0);
+
+	for (GLuint i = 0; i < 3; ++i)
+	{
+		glEnableVertexAttribArray(m_uFirstAttribute + i);
+		glVertexAttribDivisor(m_uFirstAttribute + i, 1);
+	}
+
+	// The projection never changes, set it once
+	float fSize = 7.0f;
+	matrix4 mProjection = glm::ortho(-fSize, fSize, -fSize, fSize, 0.1f, 1.1f);
+	matrix4 mView = glm::lookAt(vector3(0.0f, 0.0f, 1.0f), ZERO_V3, AXIS_Y);
+	pState->UseProgram(m_nShader);
+	glUniformMatrix4fv(m_pShaderMngr->GetUniformTable(m_nShader)[UNIFORM_MVP], 1, GL_FALSE, glm::value_ptr(mProjection * mView));
+	glUniform1i(m_nTextureID, 0);
+
+	m_bPersistent = (GLEW_ARB_buffer_storage != 0);
+	Reserve(256);
 
 	m_bBinded = true;
 
 	return;
 }
+void Text::Reserve(uint a_uCapacity)
+{
+	//the old buffer can still be read by draws already issued, GL keeps it alive until they are done
+	ReleaseRing();
+
+	m_uCapacity = a_uCapacity;
+	m_uRegion = 0;
+
+	GLState* pState = GLState::GetInstance();
+	GLsizeiptr uSize = static_cast<GLsizeiptr>(m_uCapacity) * m_uRegionCount * sizeof(GlyphRecord);
+	glGenBuffers(1, &m_GlyphVBO);
+	pState->BindArrayBuffer(m_GlyphVBO);
+	if (m_bPersistent)
+	{
+		GLbitfield uFlags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(GL_ARRAY_BUFFER, uSize, nullptr, uFlags);
+		m_pData = static_cast<GlyphRecord*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, uSize, uFlags));
+		//could not map the storage, write the runs with glBufferSubData instead
+		if (m_pData == nullptr)
+		{
+			m_bPersistent = false;
+			Reserve(a_uCapacity);
+		}
+	}
+	else
+	{
+		glBufferData(GL_ARRAY_BUFFER, uSize, nullptr, GL_DYNAMIC_DRAW);
+	}
+}
+void Text::WaitRegion(uint a_uRegion)
+{
+	GLsync pFence = m_pFence[a_uRegion];
+	if (pFence == nullptr)
+		return;
+	//flush once so the fence is guaranteed to signal, then keep waiting
+	GLbitfield uFlags = GL_SYNC_FLUSH_COMMANDS_BIT;
+	while (true)
+	{
+		GLenum eResult = glClientWaitSync(pFence, uFlags, 1000000);
+		if (eResult == GL_ALREADY_SIGNALED || eResult == GL_CONDITION_SATISFIED || eResult == GL_WAIT_FAILED)
+			break;
+		uFlags = 0;
+	}
+	glDeleteSync(pFence);
+	m_pFence[a_uRegion] = nullptr;
+}
+void Text::Upload(void)
+{
+	uint uCount = static_cast<uint>(m_lGlyph.size());
+	if (uCount > m_uCapacity)
+	{
+		uint uCapacity = m_uCapacity * 2;
+		if (uCapacity < uCount)
+			uCapacity = uCount;
+		Reserve(uCapacity); //starts over on the first region
+	}
+	else
+	{
+		m_uRegion = (m_uRegion + 1) % m_uRegionCount;
+	}
+	if (m_bPersistent)
+		WaitRegion(m_uRegion);
+
+	//the region holds the text of a few frames ago, only the runs that changed since then are written
+	std::vector<GlyphRecord>& lRegion = m_lRegionGlyph[m_uRegion];
+	uint uOldCount = static_cast<uint>(lRegion.size());
+	uint uFirst = m_uRegion * m_uCapacity;
+	m_uUploadCount = 0;
+	uint uStart = 0;
+	while (uStart < uCount)
+	{
+		//skip the records that are already there
+		while (uStart < uCount && uStart < uOldCount && memcmp(&lRegion[uStart], &m_lGlyph[uStart], sizeof(GlyphRecord)) == 0)
+			++uStart;
+		if (uStart == uCount)
+			break;
+		//the run ends on the first record that matches again
+		uint uEnd = uStart + 1;
+		while (uEnd < uCount && (uEnd >= uOldCount || memcmp(&lRegion[uEnd], &m_lGlyph[uEnd], sizeof(GlyphRecord)) != 0))
+			++uEnd;
+
+		size_t uSize = (uEnd - uStart) * sizeof(GlyphRecord);
+		if (m_bPersistent)
+		{
+			memcpy(m_pData + uFirst + uStart, &m_lGlyph[uStart], uSize);
+		}
+		else
+		{
+			GLState::GetInstance()->BindArrayBuffer(m_GlyphVBO);
+			glBufferSubData(GL_ARRAY_BUFFER, (uFirst + uStart) * sizeof(GlyphRecord), uSize, &m_lGlyph[uStart]);
+		}
+		m_uUploadCount += uEnd - uStart;
+		uStart = uEnd;
+	}
+	lRegion = m_lGlyph;
+}
 void Text::Render(void)
 {
-	float fSize = 7.0f;
 	bool bChange = false;
 	if (m_sText != m_sTextPrev || m_lColor != m_lColorPrev)
 	{
 		bChange = true;
 		m_v3Head = vector3(-36.0f, 7.77f, 0);
 
-		m_lVertexPos.clear();
-		m_lVertexUV.clear();
-		m_lVertexCol.clear();
-
+		m_lGlyph.clear();
 		for (uint n = 0; n < m_sText.size(); n++)
 		{
-			AddCharacter(m_sText[n], m_lColor[n]);
+			vector3 v3Color = glm::clamp(m_lColor[n], 0.0f, 1.0f) * 255.0f + 0.5f;
+			uint uColor = static_cast<uint>(v3Color.r) | (static_cast<uint>(v3Color.g) << 8) | (static_cast<uint>(v3Color.b) << 16) | (255u << 24);
+			AddCharacter(m_sText[n], uColor);
 		}
-
-		m_lVertex.clear();
-		m_lVertex = m_lVertexPos;
-		m_lVertex.insert(m_lVertex.end(), m_lVertexCol.begin(), m_lVertexCol.end());
-		m_lVertex.insert(m_lVertex.end(), m_lVertexUV.begin(), m_lVertexUV.end());
 	}
 
-	m_uVertexCount = m_lVertexPos.size();
-
-	if (m_uVertexCount == 0)
-		return;
+	m_sTextPrev = m_sText;
+	m_sText = "";
+	m_lColorPrev = m_lColor;
+	m_lColor.clear();
+	m_uUploadCount = 0;
 
-	if (!m_bBinded)
+	uint uCount = static_cast<uint>(m_lGlyph.size());
+	if (uCount == 0 || !m_bBinded)
 		return;
 
-	GLuint nShader = m_nShader;
-	// Use the buffer and shader
-	glUseProgram(nShader);
-	glBindVertexArray(m_vao);
-	// Get the GPU variables by their name and hook them to CPU variables
-
-	GLuint Position_b = glGetAttribLocation(nShader, "Position_b");
-	GLuint UV_b = glGetAttribLocation(nShader, "UV_b");
-	GLuint Color_b = glGetAttribLocation(nShader, "Color_b");
+	//the same text is drawn again from the region that already holds it
+	if (bChange)
+		Upload();
 
-	GLuint MVP = glGetUniformLocation(nShader, "MVP");
-	GLuint TextureID = glGetUniformLocation(nShader, "TextureID");
-	
-	float fRatio = static_cast<float>(m_pSystem->GetWindowWidth()) / static_cast<float>(m_pSystem->GetWindowHeight());
-	
-	//matrix4 mProjection = glm::ortho(-fSize, fSize, -fSize + fSize / 10.0f, fSize / 10.0f, 0.1f, 1.1f);
-	matrix4 mProjection = glm::ortho(-fSize, fSize, -fSize, fSize, 0.1f, 1.1f);
-	matrix4 mView = glm::lookAt(vector3(0.0f, 0.0f, 1.0f), ZERO_V3, AXIS_Y);
+	// Use the buffer and shader, the uniforms were set when the shader was bound the first time
+	GLState* pState = GLState::GetInstance();
+	pState->UseProgram(m_nShader);
+	pState->BindVertexArray(m_vao);
+	pState->PolygonMode(GL_FILL);
 
-	//Final Projection of the Camera
-	glUniformMatrix4fv(MVP, 1, GL_FALSE, glm::value_ptr(mProjection * mView));
-	
 	// Bind our texture in Texture Unit 0
 	int nMaterialIndex = m_uMaterialIndex;
 	if (m_pMatMngr->m_materialList[nMaterialIndex]->GetDiffuseMapName() != "NULL")
-	{
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, m_pMatMngr->m_materialList[nMaterialIndex]->GetDiffuseMap());
-		glUniform1i(TextureID, 0);
-	}
+		pState->BindTexture(0, m_pMatMngr->m_materialList[nMaterialIndex]->GetDiffuseMap());
 
-	//vertex
-	glEnableVertexAttribArray(Position_b);
-	glEnableVertexAttribArray(UV_b);
-	glEnableVertexAttribArray(Color_b);
-	glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
-	if (bChange)
+	//point the instance attributes to the region drawn
+	if (m_uBoundRegion != m_uRegion)
 	{
-		glBufferData(GL_ARRAY_BUFFER, 3 * m_uVertexCount * sizeof(vector3), &m_lVertex[0], GL_DYNAMIC_DRAW);
+		pState->BindArrayBuffer(m_GlyphVBO);
+		size_t uOffset = m_uRegion * m_uCapacity * sizeof(GlyphRecord);
+		glVertexAttribPointer(m_uFirstAttribute, 4, GL_FLOAT, GL_FALSE, sizeof(GlyphRecord), BUFFER_OFFSET(uOffset));
+		glVertexAttribPointer(m_uFirstAttribute + 1, 4, GL_FLOAT, GL_FALSE, sizeof(GlyphRecord), BUFFER_OFFSET(uOffset + sizeof(vector4)));
+		glVertexAttribPointer(m_uFirstAttribute + 2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(GlyphRecord), BUFFER_OFFSET(uOffset + 2 * sizeof(vector4)));
+		m_uBoundRegion = m_uRegion;
 	}
-	glVertexAttribPointer(Position_b, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
-	glVertexAttribPointer(Color_b, 3, GL_FLOAT, GL_FALSE, 0, BUFFER_OFFSET(m_uVertexCount * sizeof(vector3)));
-	glVertexAttribPointer(UV_b, 3, GL_FLOAT, GL_FALSE, 0, BUFFER_OFFSET(2 * m_uVertexCount * sizeof(vector3)));
-
-	//Color and draw
-	glDrawArrays(GL_TRIANGLES, 0, m_uVertexCount);
-
-	glDisable(GL_TEXTURE0);
 
-	glDisableVertexAttribArray(Position_b);
-	glDisableVertexAttribArray(UV_b);
-	glDisableVertexAttribArray(Color_b);
-
-	m_sTextPrev = m_sText;
-	m_sText = "";
-	m_lColorPrev = m_lColor;
-	m_lColor.clear();
+	glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, uCount);
 
-	glBindVertexArray(0);
+	//the region cannot be written again until this draw is done with it
+	if (m_bPersistent)
+	{
+		if (m_pFence[m_uRegion])
+			glDeleteSync(m_pFence[m_uRegion]);
+		m_pFence[m_uRegion] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	}
 }
 void Text::Reset(void)
 {
 	m_v3Head = vector3(-26, 0, 0);
 
-	m_lVertexPos.clear();
-	m_lVertexUV.clear();
-	m_lVertexCol.clear();
-
-	m_uVertexCount = 0;
+	m_lGlyph.clear();
 
 	m_lColor.clear();
 	m_sText = "";
@@ -207,7 +342,7 @@ void Text::AddString(String a_sString, vector3 a_v3Color)
 		m_lColor.push_back(a_v3Color);
 	}
 }
-void Text::AddCharacter(char a_cInput, vector3 a_v3Color)
+void Text::AddCharacter(char a_cInput, uint a_uColor)
 {
 	vector3 vOffset = vector3(0.19f, 0.75f, 0.0f);
 	//vector3 vOffset = vector3(0.525f / 2.0f, 0.820f, 0.0f);
@@ -225,7 +360,7 @@ void Text::AddCharacter(char a_cInput, vector3 a_v3Color)
 		uint tabToSpace = 5;
 		for (uint i = 0; i < tabToSpace; ++i)
 		{
-			AddCharacter(' ', a_v3Color);
+			AddCharacter(' ', a_uColor);
 		}
 		return;
 	}
@@ -233,34 +368,12 @@ void Text::AddCharacter(char a_cInput, vector3 a_v3Color)
 	if (nIndex < 0 || nIndex > 94)
 		nIndex = 0;
 
-	int nColumn = nIndex % 10;
-	int nRow = static_cast<int>(nIndex / 10);
-
-	m_lVertexPos.push_back(vector3(0.0f + (vOffset.x * m_v3Head.x), 0.0f + (vOffset.y * m_v3Head.y), 0.0f));
-	m_lVertexPos.push_back(vector3(vOffset.x + (vOffset.x * m_v3Head.x), 0.0f + (vOffset.y * m_v3Head.y), 0.0f));
-	m_lVertexPos.push_back(vector3(0.0f + (vOffset.x * m_v3Head.x), vOffset.y + (vOffset.y * m_v3Head.y), 0.0f));
-
-	m_lVertexPos.push_back(vector3(0.0f + (vOffset.x * m_v3Head.x), vOffset.y + (vOffset.y * m_v3Head.y), 0.0f));
-	m_lVertexPos.push_back(vector3(vOffset.x + (vOffset.x * m_v3Head.x), 0.0f + (vOffset.y * m_v3Head.y), 0.0f));
-	m_lVertexPos.push_back(vector3(vOffset.x + (vOffset.x * m_v3Head.x), vOffset.y + (vOffset.y * m_v3Head.y), 0.0f));
-
-	vector3 vUV = vector3(0.1f, 0.1f, 0.0f);
-
-	m_lVertexUV.push_back(vector3(0.0f + vUV.x * nColumn, 0.9f - vUV.y * nRow, 0.0f));
-	m_lVertexUV.push_back(vector3(0.1f + vUV.x * nColumn, 0.9f - vUV.y * nRow, 0.0f));
-	m_lVertexUV.push_back(vector3(0.0f + vUV.x * nColumn, 1.0f - vUV.y * nRow, 0.0f));
-
-	m_lVertexUV.push_back(vector3(0.0f + vUV.x * nColumn, 1.0f - vUV.y * nRow, 0.0f));
-	m_lVertexUV.push_back(vector3(0.1f + vUV.x * nColumn, 0.9f - vUV.y * nRow, 0.0f));
-	m_lVertexUV.push_back(vector3(0.1f + vUV.x * nColumn, 1.0f - vUV.y * nRow, 0.0f));
-
-	m_lVertexCol.push_back(a_v3Color);
-	m_lVertexCol.push_back(a_v3Color);
-	m_lVertexCol.push_back(a_v3Color);
-
-	m_lVertexCol.push_back(a_v3Color);
-	m_lVertexCol.push_back(a_v3Color);
-	m_lVertexCol.push_back(a_v3Color);
+	GlyphRecord glyph;
+	vector2 v2Corner = vector2(vOffset.x * m_v3Head.x, vOffset.y * m_v3Head.y);
+	glyph.m_v4Rect = vector4(v2Corner.x, v2Corner.y, v2Corner.x + vOffset.x, v2Corner.y + vOffset.y);
+	glyph.m_v4UV = m_v4GlyphUV[nIndex];
+	glyph.m_uColor = a_uColor;
+	m_lGlyph.push_back(glyph);
 
 	m_v3Head.x += 1.0f;
 
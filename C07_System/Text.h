@@ -8,28 +8,48 @@ Date: 2017/05
 #include "SystemSingleton.h"
 #include "ShaderManager.h"
 #include "MaterialManager.h"
+#include "GLState.h"
+
+//Per instance record read by Text-InstancedVBO.vs, one per character
+struct GlyphRecord
+{
+	vector4 m_v4Rect; //left, bottom, right and top of the quad in text space (attribute 6)
+	vector4 m_v4UV; //left, bottom, right and top of the glyph in the font texture (attribute 7)
+	uint m_uColor; //RGBA color, one byte per channel (attribute 8)
+};
 
 //System Class
 class Text
 {
 protected:
+	static const uint m_uGlyphCount = 95; //printable ASCII characters in the font, from the space on
+	static const uint m_uRegionCount = 3; //regions in the ring, the GPU reads one while the CPU writes another
+	static const GLuint m_uFirstAttribute = 6; //first attribute location used by the glyph records
+
 	bool m_bBinded = false; //Binded flag
 
 	uint m_uMaterialIndex = 0; //Material index of this mesh
-	uint m_uVertexCount = 0; //Number of vertices in this Mesh
 
 	GLuint m_vao = 0;	//OpenGL Vertex Array Object
-	GLuint m_VBO = 0;	//OpenGL Buffer (Will hold the vertex buffer pointer)
+	GLuint m_VBO = 0;	//OpenGL Buffer with the corners of the quad every glyph is drawn with
+	GLuint m_GlyphVBO = 0;	//OpenGL Buffer with the ring of glyph records
 	GLuint m_nShader = 0;	//Index of the shader
+	GLint m_nTextureID = -1; //location of the texture sampler, resolved once
 
 	ShaderManager* m_pShaderMngr = nullptr;	//Shader Manager
 	MaterialManager* m_pMatMngr = nullptr;		//Material Manager
 
-	std::vector<vector3> m_lVertex; //List of vertices
+	vector4 m_v4GlyphUV[m_uGlyphCount]; //texture rectangle of each glyph, computed once
+	std::vector<GlyphRecord> m_lGlyph; //records of the text shown
 
-	std::vector<vector3> m_lVertexPos;	//List of Vertices
-	std::vector<vector3> m_lVertexCol;	//List of Colors
-	std::vector<vector3> m_lVertexUV;	//List of UVS
+	bool m_bPersistent = false; //is the ring persistently mapped (GL_ARB_buffer_storage)?
+	GlyphRecord* m_pData = nullptr; //persistent mapping of the ring
+	uint m_uCapacity = 0; //records per region
+	uint m_uRegion = 0; //region drawn from
+	uint m_uBoundRegion = -1; //region the VAO points to
+	std::vector<GlyphRecord> m_lRegionGlyph[m_uRegionCount]; //records each region holds
+	GLsync m_pFence[m_uRegionCount]; //fence placed after the last draw that read each region
+	uint m_uUploadCount = 0; //records written on the last frame
 
 	vector3 m_v3Head = ZERO_V3;
 
@@ -63,11 +83,18 @@ public:
 	void CompileOpenGL3X(void);
 
 	/*
-	USAGE:
+	USAGE: Draws the text added this frame, the records are only laid out again if the text
+	changed and only the ones that differ from what the region held are written
 	ARGUMENTS: ---
 	OUTPUT: ---
 	*/
 	void Render(void);
+	/*
+	USAGE: Number of glyph records written to the ring on the last frame
+	ARGUMENTS: ---
+	OUTPUT: written records, 0 if the text did not change
+	*/
+	uint GetUploadCount(void);
 
 	/*
 	USAGE:
@@ -129,11 +156,39 @@ protected:
 	void Reset(void);
 
 	/*
-	USAGE:
+	USAGE: Lays out a character at the head, adding its record to the list
+	ARGUMENTS:
+	-	char a_cInput -> character, new lines and tabs move the head
+	-	uint a_uColor -> packed RGBA color
+	OUTPUT: ---
+	*/
+	void AddCharacter(char a_cInput, uint a_uColor);
+	/*
+	USAGE: Moves to the next region of the ring and writes the runs of records that differ from it
+	ARGUMENTS: ---
+	OUTPUT: ---
+	*/
+	void Upload(void);
+	/*
+	USAGE: Reallocates the ring so each region fits at least the specified records
+	ARGUMENTS:
+	-	uint a_uCapacity -> minimum records per region
+	OUTPUT: ---
+	*/
+	void Reserve(uint a_uCapacity);
+	/*
+	USAGE: Deletes the ring, its mapping and its fences
+	ARGUMENTS: ---
+	OUTPUT: ---
+	*/
+	void ReleaseRing(void);
+	/*
+	USAGE: Waits until the GPU is done with the specified region
 	ARGUMENTS:
+	-	uint a_uRegion -> region to wait for
 	OUTPUT: ---
 	*/
-	void AddCharacter(char a_cInput, vector3 a_v3Color = C_WHITE);
+	void WaitRegion(uint a_uRegion);
 };
 
 #endif //__TEXTSINGLETON_H_
\ No newline at end of file
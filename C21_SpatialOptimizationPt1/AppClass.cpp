@@ -1,4 +1,5 @@
 #include "AppClass.h"
+#include <chrono>
 using namespace Simplex;
 void Application::InitVariables(void)
 {
@@ -20,6 +21,8 @@ void Application::InitVariables(void)
 	int nSquare = static_cast<int>(std::sqrt(uInstances));
 	uInstances = nSquare * nSquare;
 	uint uIndex = 0;
+	//every cube after the first one is an instance of the same model, time how long they take
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
 	for (int i = 0; i < nSquare; i++)
 	{
 		for (int j = 0; j < nSquare; j++)
@@ -48,6 +51,7 @@ void Application::InitVariables(void)
 			
 		}
 	}
+	m_fLoadTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
 	m_pEntityMngr->Update();
 	//steve
 	//m_pEntityMngr->AddEntity("Minecraft\\Steve.obj", "Steve");
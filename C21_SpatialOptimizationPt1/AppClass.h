@@ -29,6 +29,7 @@ private:
 	bool m_bGUI_Controller = false; //show Controller GUI window?
 
 	uint m_uRenderCallCount = 0; //count of render calls per frame
+	float m_fLoadTime = 0.0f; //milliseconds it took to add the entities
 	uint m_uControllerCount = 0; //count of controllers connected
 
 	bool m_bFocused = true; //is the window focused?
@@ -19,6 +19,10 @@ void Application::DrawGUI(void)
 	//m_pMeshMngr->Print("						");
 	m_pMeshMngr->Print("FPS:");
 	m_pMeshMngr->PrintLine(std::to_string(m_pSystem->GetFPS()), C_RED);
+
+	//m_pMeshMngr->Print("						");
+	m_pMeshMngr->Print("Load time:");
+	m_pMeshMngr->PrintLine(std::to_string(m_fLoadTime) + " ms", C_YELLOW);
 #pragma endregion
 
 	//Calculate the window size to know how to draw
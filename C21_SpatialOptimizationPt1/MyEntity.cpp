@@ -1,6 +1,7 @@
 #include "MyEntity.h"
 using namespace Simplex;
 std::map<String, MyEntity*> MyEntity::m_IDMap;
+std::unordered_map<String, Model*> MyEntity::m_ModelCache;
 //  Accessors
 matrix4 Simplex::MyEntity::GetModelMatrix(void){ return m_m4ToWorld; }
 void Simplex::MyEntity::SetModelMatrix(matrix4 a_m4ToWorld)
@@ -47,9 +48,8 @@ void Simplex::MyEntity::Swap(MyEntity& other)
 void Simplex::MyEntity::Release(void)
 {
 	m_pMeshMngr = nullptr;
-	//it is not the job of the entity to release the model, 
-	//it is for the mesh manager to do so.
-	m_pModel = nullptr; 
+	//the model is an instance only this entity uses, the source stays in the cache
+	SafeDelete(m_pModel);
 	SafeDelete(m_pRigidBody);
 	m_IDMap.erase(m_sUniqueID);
 }
@@ -57,22 +57,33 @@ void Simplex::MyEntity::Release(void)
 Simplex::MyEntity::MyEntity(String a_sFileName, String a_sUniqueID)
 {
 	Init();
-	m_pModel = new Model();
-	m_pModel->Load(a_sFileName);
+	//the file is loaded once, every entity of it is an instance with only its own transform
+	Model* pSource = GetSourceModel(a_sFileName);
+	if (pSource)
+	{
+		m_pModel = new Model();
+		m_pModel->Instance(pSource, a_sUniqueID);
+	}
 	//if the model is loaded
-	if (m_pModel->GetName() != "")
+	if (m_pModel && m_pModel->GetName() != "")
 	{
 		GenUniqueID(a_sUniqueID);
 		m_sUniqueID = a_sUniqueID;
 		m_IDMap[a_sUniqueID] = this;
-		m_pRigidBody = new MyRigidBody(m_pModel->GetVertexList()); //generate a rigid body
+		m_pRigidBody = new MyRigidBody(pSource->GetVertexList()); //generate a rigid body
 		m_bInMemory = true; //mark this entity as viable
 	}
 }
 Simplex::MyEntity::MyEntity(MyEntity const& other)
 {
 	m_bInMemory = other.m_bInMemory;
-	m_pModel = other.m_pModel;
+	//the copy gets its own instance of the model so each one can release it
+	m_pModel = nullptr;
+	if (other.m_pModel)
+	{
+		m_pModel = new Model();
+		m_pModel->Instance(other.m_pModel, other.m_sUniqueID);
+	}
 	//generate a new rigid body we do not share the same rigid body as we do the model
 	m_pRigidBody = new MyRigidBody(m_pModel->GetVertexList());
 	m_m4ToWorld = other.m_m4ToWorld;
@@ -119,6 +130,29 @@ MyEntity* Simplex::MyEntity::GetEntity(String a_sUniqueID)
 	//if not found return nullptr, if found return it
 	return entity == m_IDMap.end() ? nullptr : entity->second;
 }
+Model* Simplex::MyEntity::GetSourceModel(String a_sFileName)
+{
+	//look for the file in the ones already loaded
+	auto cached = m_ModelCache.find(a_sFileName);
+	if (cached != m_ModelCache.end())
+		return cached->second;
+
+	//load it, if it cannot be loaded remember it so it is not tried again
+	Model* pModel = new Model();
+	pModel->Load(a_sFileName);
+	if (pModel->GetName() == "")
+		SafeDelete(pModel);
+	m_ModelCache[a_sFileName] = pModel;
+	return pModel;
+}
+void Simplex::MyEntity::ReleaseModelCache(void)
+{
+	for (auto& cached : m_ModelCache)
+	{
+		SafeDelete(cached.second);
+	}
+	m_ModelCache.clear();
+}
 void Simplex::MyEntity::GenUniqueID(String& a_sUniqueID)
 {
 	static uint index = 0;
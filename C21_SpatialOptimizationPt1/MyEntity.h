@@ -6,6 +6,7 @@ Date: 2017/07
 #define __MYENTITY_H_
 
 #include "MyRigidBody.h"
+#include <unordered_map>
 
 namespace Simplex
 {
@@ -28,6 +29,7 @@ class MyEntity
 	MeshManager* m_pMeshMngr = nullptr; //For rendering shapes
 
 	static std::map<String, MyEntity*> m_IDMap; //a map of the unique ID's
+	static std::unordered_map<String, Model*> m_ModelCache; //model loaded once per file, entities get an instance of it
 
 public:
 	/*
@@ -117,6 +119,19 @@ public:
 	*/
 	void GenUniqueID(String& a_sUniqueID);
 	/*
+	USAGE: Gets the model loaded from a file, the file is only loaded the first time it is asked for;
+	entities do not draw this model, they make an instance of it sharing its groups, meshes and materials
+	ARGUMENTS: String a_sFileName -> name of the model to load
+	OUTPUT: loaded model, nullptr if it could not be loaded
+	*/
+	static Model* GetSourceModel(String a_sFileName);
+	/*
+	USAGE: Frees the models loaded by GetSourceModel, only once no entity holds an instance of them
+	ARGUMENTS: ---
+	OUTPUT: ---
+	*/
+	static void ReleaseModelCache(void);
+	/*
 	USAGE: Gets the Unique ID name of this model
 	ARGUMENTS: ---
 	OUTPUT: ---
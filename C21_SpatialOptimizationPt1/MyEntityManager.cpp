@@ -18,6 +18,9 @@ void MyEntityManager::Release(void)
 	m_uEntityCount = 0;
 	m_EntityList.clear();
 	m_mEntityArray = nullptr;
+
+	//no instance of the loaded models is left
+	MyEntity::ReleaseModelCache();
 }
 MyEntityManager* MyEntityManager::GetInstance()
 {
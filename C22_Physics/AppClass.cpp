@@ -10,42 +10,71 @@ void Application::InitVariables(void)
 
 	m_pLightMngr->SetPosition(vector3(0.0f, 3.0f, 13.0f), 1); //set the position of first light (0 is reserved for ambient light)
 
-	m_pEntityMngr->AddEntity("Minecraft\\Steve.obj", "Steve");
+	m_hSteve = m_pEntityMngr->AddEntity("Minecraft\\Steve.obj", "Steve");
 	m_pEntityMngr->UsePhysicsSolver();
+	m_pEntityMngr->UseContinuousCollision(); //Steve can be pushed fast enough to go through the cubes
 	
+	//the cubes all use the same model, add them at once
+	std::vector<matrix4> m4CubeList;
 	for (int i = 0; i < 100; i++)
 	{
-		m_pEntityMngr->AddEntity("Minecraft\\Cube.obj", "Cube_" + std::to_string(i));
 		vector3 v3Position = vector3(glm::sphericalRand(12.0f));
 		v3Position.y = 0.0f;
 		matrix4 m4Position = glm::translate(v3Position);
-		m_pEntityMngr->SetModelMatrix(m4Position * glm::scale(vector3(2.0f)));
-		m_pEntityMngr->UsePhysicsSolver();
-		//m_pEntityMngr->SetMass(2);
-
-		//m_pEntityMngr->SetMass(i+1);
+		m4CubeList.push_back(m4Position * glm::scale(vector3(2.0f)));
+	}
+	uint uFirstCube = m_pEntityMngr->GetEntityCount();
+	m_pEntityMngr->AddEntities("Minecraft\\Cube.obj", 100, m4CubeList, "Cube");
+	for (uint i = uFirstCube; i < m_pEntityMngr->GetEntityCount(); i++)
+	{
+		m_pEntityMngr->UsePhysicsSolver(true, i);
+		m_pEntityMngr->SetOccluder(true, i); //the cubes fill their box, the ones in front hide the ones behind
+		//m_pEntityMngr->SetMass(2, i);
 	}
+	m_pEntityMngr->UseOcclusionCulling();
 }
 void Application::Update(void)
 {
 	//Update the system so it knows how much time has passed since the last call
 	m_pSystem->Update();
 
+	//Start a new frame on the job timeline, nothing is running between frames
+	MyJobSystem* pJobSystem = MyJobSystem::GetInstance();
+	pJobSystem->BeginFrame();
+
+	//the physics steps (collisions included), the placement of the models and their bounds, the culling
+	//of the entities hidden from the camera and the render list, in that order on the workers
+	matrix4 m4ViewProjection;
+	MyJob* pSimulationJob = pJobSystem->CreateJob([this]() { m_pEntityMngr->Simulate(); }, "Simulation");
+	MyJob* pTransformJob = pJobSystem->CreateJob([this]() { m_pEntityMngr->Interpolate(); }, "Transforms");
+	MyJob* pCullingJob = pJobSystem->CreateJob([this, &m4ViewProjection]()
+	{
+		m_pEntityMngr->CullOccludedEntities(m4ViewProjection);
+	}, "Culling");
+	MyJob* pRenderListJob = pJobSystem->CreateJob([this]() { m_pEntityMngr->AddEntityToRenderList(-1, true); }, "Render List");
+	pJobSystem->AddDependency(pTransformJob, pSimulationJob);
+	pJobSystem->AddDependency(pCullingJob, pTransformJob);
+	pJobSystem->AddDependency(pRenderListJob, pCullingJob);
+	pJobSystem->Run(pRenderListJob);
+	pJobSystem->Run(pTransformJob);
+	pJobSystem->Run(pSimulationJob);
+
+	//the camera does not touch the entities, move it on this thread while the workers simulate
 	//Is the ArcBall active?
 	ArcBall();
 
 	//Is the first person camera active?
 	CameraRotation();
 
-	//Update Entity Manager
-	m_pEntityMngr->Update();
+	//the camera is done moving for this frame, the culling can start once the models are placed
+	m4ViewProjection = m_pCameraMngr->GetProjectionMatrix() * m_pCameraMngr->GetViewMatrix();
+	pJobSystem->Run(pCullingJob);
 
 	//Set the model matrix for the main object
 	//m_pEntityMngr->SetModelMatrix(m_m4Steve, "Steve");
 
-	//Add objects to render list
-	m_pEntityMngr->AddEntityToRenderList(-1, true);
-	//m_pEntityMngr->AddEntityToRenderList(-1, true);
+	//help the workers until the render list is ready
+	pJobSystem->Wait(pRenderListJob);
 }
 void Application::Display(void)
 {
@@ -72,6 +101,12 @@ void Application::Release(void)
 	//Release MyEntityManager
 	MyEntityManager::ReleaseInstance();
 
+	//Release the physics solver, after the entities gave their bodies back
+	MySolver::ReleaseInstance();
+
+	//Release the worker threads
+	MyJobSystem::ReleaseInstance();
+
 	//release GUI
 	ShutdownGUI();
 }
\ No newline at end of file
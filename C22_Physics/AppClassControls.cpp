@@ -73,7 +73,7 @@ void Application::ProcessKeyPressed(sf::Event a_event)
 	default: break;
 	case sf::Keyboard::Space:
 		m_sound.play();
-		m_pEntityMngr->ApplyForce(vector3(0.0f, 1.0f, 0.0f), "Steve");
+		m_pEntityMngr->ApplyForce(vector3(0.0f, 1.0f, 0.0f), m_hSteve);
 		break;
 	case sf::Keyboard::LShift:
 	case sf::Keyboard::RShift:
@@ -112,6 +112,16 @@ void Application::ProcessKeyReleased(sf::Event a_event)
 		bFPSControl = !bFPSControl;
 		m_pCameraMngr->SetFPS(bFPSControl);
 		break;
+	case sf::Keyboard::O:
+		m_pEntityMngr->UseOcclusionCulling(!m_pEntityMngr->IsUsingOcclusionCulling());
+		break;
+	case sf::Keyboard::R:
+		//log from here on so it can be timed again with C22_PhysicsHeadless --replay C22_Physics.rec
+		if (m_pEntityMngr->IsRecording())
+			m_pEntityMngr->StopRecording();
+		else
+			m_pEntityMngr->StartRecording("C22_Physics.rec");
+		break;
 	case sf::Keyboard::PageUp:
 		break;
 	case sf::Keyboard::PageDown:
@@ -416,22 +426,22 @@ void Application::ProcessKeyboard(void)
 	float fDelta = m_pSystem->GetDeltaTime(0);
 	if (sf::Keyboard::isKeyPressed(sf::Keyboard::Left))
 	{
-		m_pEntityMngr->ApplyForce(vector3(-2.0f * fDelta, 0.0f, 0.0f), "Steve");
+		m_pEntityMngr->ApplyForce(vector3(-2.0f * fDelta, 0.0f, 0.0f), m_hSteve);
 	}
 
 	if (sf::Keyboard::isKeyPressed(sf::Keyboard::Right))
 	{
-		m_pEntityMngr->ApplyForce(vector3(2.0f * fDelta, 0.0f, 0.0f), "Steve");
+		m_pEntityMngr->ApplyForce(vector3(2.0f * fDelta, 0.0f, 0.0f), m_hSteve);
 	}
 
 	if (sf::Keyboard::isKeyPressed(sf::Keyboard::Up))
 	{
-		m_pEntityMngr->ApplyForce(vector3(0.0f, 0.0f, -2.0f * fDelta), "Steve");
+		m_pEntityMngr->ApplyForce(vector3(0.0f, 0.0f, -2.0f * fDelta), m_hSteve);
 	}
 
 	if (sf::Keyboard::isKeyPressed(sf::Keyboard::Down))
 	{
-		m_pEntityMngr->ApplyForce(vector3(0.0f, 0.0f, 2.0f * fDelta), "Steve");
+		m_pEntityMngr->ApplyForce(vector3(0.0f, 0.0f, 2.0f * fDelta), m_hSteve);
 	}
 #pragma endregion
 }
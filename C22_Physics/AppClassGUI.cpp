@@ -19,6 +19,21 @@ void Application::DrawGUI(void)
 	//m_pMeshMngr->Print("						");
 	m_pMeshMngr->Print("FPS:");
 	m_pMeshMngr->PrintLine(std::to_string(m_pSystem->GetFPS()), C_RED);
+
+	//m_pMeshMngr->Print("						");
+	m_pMeshMngr->Print("Physics Steps:");
+	m_pMeshMngr->PrintLine(std::to_string(m_pEntityMngr->GetSubstepCount()), C_YELLOW);
+
+	//m_pMeshMngr->Print("						");
+	m_pMeshMngr->Print("Awake Bodies:");
+	m_pMeshMngr->PrintLine(std::to_string(MySolver::GetInstance()->GetAwakeCount()), C_YELLOW);
+
+	//m_pMeshMngr->Print("						");
+	m_pMeshMngr->Print("Occluded:");
+	m_pMeshMngr->PrintLine(std::to_string(m_pEntityMngr->GetOccludedCount()), C_YELLOW);
+
+	if (m_pEntityMngr->IsRecording())
+		m_pMeshMngr->PrintLine("Recording", C_RED);
 #pragma endregion
 
 	//Calculate the window size to know how to draw
@@ -47,6 +62,49 @@ void Application::DrawGUI(void)
 			ImGui::Text("	 F4: Orthographic Z\n");
 			ImGui::Separator();
 			ImGui::Text("Arrows: Apply force to Steve\n");
+			ImGui::Text("     O: Occlusion culling\n");
+			ImGui::Text("     R: Record to C22_Physics.rec\n");
+		}
+		ImGui::End();
+	}
+
+	//Job timeline, one row per thread over the length of the last frame
+	if (m_bGUI_Jobs)
+	{
+		MyJobSystem* pJobSystem = MyJobSystem::GetInstance();
+		uint uThreadCount = pJobSystem->GetThreadCount();
+		float fRowHeight = 14.0f;
+		float fWindowHeight = 40.0f + uThreadCount * (fRowHeight + 4.0f);
+		ImGui::SetNextWindowPos(ImVec2(1, ImGui::GetIO().DisplaySize.y - fWindowHeight - 1), ImGuiSetCond_FirstUseEver);
+		ImGui::SetNextWindowSize(ImVec2(340, fWindowHeight), ImGuiSetCond_FirstUseEver);
+		ImGui::Begin("Jobs", (bool*)0, window_flags);
+		{
+			float fFrameLength = pJobSystem->GetFrameLength();
+			ImGui::Text("Frame: %.3f [ms] on %u threads\n", fFrameLength, uThreadCount);
+			ImDrawList* pDrawList = ImGui::GetWindowDrawList();
+			for (uint uThread = 0; uThread < uThreadCount; ++uThread)
+			{
+				ImGui::Text("%2u %5.1f%%", uThread, pJobSystem->GetUtilization(uThread) * 100.0f);
+				ImGui::SameLine();
+				ImVec2 v2Start = ImGui::GetCursorScreenPos();
+				float fWidth = ImGui::GetContentRegionAvailWidth();
+				pDrawList->AddRectFilled(v2Start, ImVec2(v2Start.x + fWidth, v2Start.y + fRowHeight), ImColor(40, 40, 40));
+
+				//jobs waiting on others end after them, drawing backwards puts the nested ones on top
+				std::vector<MyJobSpan> spanList = pJobSystem->GetFrameTimeline(uThread);
+				for (int i = static_cast<int>(spanList.size()) - 1; i >= 0 && fFrameLength > 0.0f; --i)
+				{
+					ImVec2 v2Min(v2Start.x + fWidth * std::min(spanList[i].fStart / fFrameLength, 1.0f), v2Start.y);
+					ImVec2 v2Max(v2Start.x + fWidth * std::min(spanList[i].fEnd / fFrameLength, 1.0f), v2Start.y + fRowHeight);
+					v2Max.x = std::max(v2Max.x, v2Min.x + 1.0f);
+					//same job name same color
+					float fHue = static_cast<float>(std::hash<String>()(spanList[i].sName) % 360) / 360.0f;
+					pDrawList->AddRectFilled(v2Min, v2Max, ImColor::HSV(fHue, 0.6f, 0.9f));
+					if (ImGui::IsMouseHoveringRect(v2Min, v2Max))
+						ImGui::SetTooltip("%s: %.3f [ms]", spanList[i].sName, spanList[i].fEnd - spanList[i].fStart);
+				}
+				ImGui::Dummy(ImVec2(fWidth, fRowHeight));
+			}
 		}
 		ImGui::End();
 	}
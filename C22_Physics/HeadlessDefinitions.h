@@ -0,0 +1,66 @@
+/*----------------------------------------------
+Programmer: Alberto Bobadilla (labigm@gmail.com)
+Date: 2017/07
+----------------------------------------------*/
+#ifndef __HEADLESSDEFINITIONS_H_
+#define __HEADLESSDEFINITIONS_H_
+
+//Subset of the Simplex definitions used by the entity and physics layer, included instead of the Simplex
+//headers when SIMPLEX_HEADLESS is defined so that layer builds without a window, OpenGL or the Simplex library
+
+// Include standard headers
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <algorithm>
+#include <assert.h>
+#include <math.h>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <random>
+#include <map>
+
+// Include GLM
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <glm/gtx/transform.hpp>
+#include <glm/ext.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtx/matrix_decompose.hpp>
+
+namespace Simplex
+{
+	typedef unsigned int uint;
+	typedef std::string String;
+	typedef glm::vec2 vector2;
+	typedef glm::vec3 vector3;
+	typedef glm::vec4 vector4;
+	typedef glm::mat3 matrix3;
+	typedef glm::mat4 matrix4;
+	typedef glm::quat quaternion;
+
+	//only referenced through pointers, never created without a window
+	class MeshManager;
+	class Model;
+/*
+USAGE: will safely delete the input pointer and initialize it to nullptr, DOES NOT WORK WITH POINTER ARRAY
+*/
+#define SafeDelete(p){ if(p) { delete p; p = nullptr; } }
+
+#define IDENTITY_M4 matrix4(1.0f)
+#define ZERO_V3 vector3(0.0f, 0.0f, 0.0f)
+
+#define C_WHITE vector3(1.0f, 1.0f, 1.0f)
+#define C_RED vector3(1.0f, 0.0f, 0.0f)
+#define C_YELLOW vector3(1.0f, 1.0f, 0.0f)
+#define C_BLUE_CORNFLOWER vector3(0.4f, 0.6f, 0.9f)
+
+#define AXIS_X vector3(1.0f, 0.0f, 0.0f)
+#define AXIS_Y vector3(0.0f, 1.0f, 0.0f)
+#define AXIS_Z vector3(0.0f, 0.0f, 1.0f)
+} //namespace Simplex
+
+#endif //__HEADLESSDEFINITIONS_H_
@@ -1,19 +1,38 @@
 #include "MyEntity.h"
+#include "MyEntityManager.h"
 using namespace Simplex;
-std::map<String, MyEntity*> MyEntity::m_IDMap;
+std::unordered_map<String, uint> MyEntity::m_NameCounterMap;
+String MyEntity::m_sModelFolder = "Data/MOBJ/";
+#ifndef SIMPLEX_HEADLESS
+std::unordered_map<String, Model*> MyEntity::m_ModelCache;
+#endif
+std::unordered_map<String, PRigidBodyShape> MyEntity::m_ShapeCache;
 //  Accessors
-Simplex::MySolver* Simplex::MyEntity::GetSolver(void) { return m_pSolver; }
+Simplex::uint Simplex::MyEntity::GetSolverIndex(void) { return m_uSolverIndex; }
 bool Simplex::MyEntity::HasThisRigidBody(MyRigidBody* a_pRigidBody) { return m_pRigidBody == a_pRigidBody; }
 Simplex::MyRigidBody::PRigidBody* Simplex::MyEntity::GetColliderArray(void) { return m_pRigidBody->GetColliderArray(); }
 uint Simplex::MyEntity::GetCollidingCount(void) { return m_pRigidBody->GetCollidingCount(); }
 matrix4 Simplex::MyEntity::GetModelMatrix(void){ return m_m4ToWorld; }
 void Simplex::MyEntity::SetModelMatrix(matrix4 a_m4ToWorld)
+{
+	if (!m_bInMemory)
+		return;
+
+	PlaceModel(a_m4ToWorld);
+	//a teleport, interpolating or sweeping from the old place would smear it across the way
+	m_pSolver->ResetPreviousPosition(m_uSolverIndex);
+}
+void Simplex::MyEntity::PlaceModel(matrix4 a_m4ToWorld)
 {
 	if (!m_bInMemory)
 		return;
 
 	m_m4ToWorld = a_m4ToWorld;
-	m_pModel->SetModelMatrix(m_m4ToWorld);
+	m_m4Render = a_m4ToWorld;
+#ifndef SIMPLEX_HEADLESS
+	if (m_pModel)
+		m_pModel->SetModelMatrix(m_m4ToWorld);
+#endif
 	m_pRigidBody->SetModelMatrix(m_m4ToWorld);
 
 	//experimental way of calculating a matrix components
@@ -24,8 +43,8 @@ void Simplex::MyEntity::SetModelMatrix(matrix4 a_m4ToWorld)
 	glm::vec4 perspective;
 	glm::decompose(m_m4ToWorld, scale, rotation, translation, skew, perspective);
 
-	m_pSolver->SetPosition(translation);
-	m_pSolver->SetSize(scale);
+	m_pSolver->SetPosition(m_uSolverIndex, translation);
+	m_pSolver->SetSize(m_uSolverIndex, scale);
 
 	//m_pSolver->SetPosition(vector3(m_m4ToWorld[3]));
 
@@ -35,33 +54,46 @@ MyRigidBody* Simplex::MyEntity::GetRigidBody(void){	return m_pRigidBody; }
 bool Simplex::MyEntity::IsInitialized(void){ return m_bInMemory; }
 String Simplex::MyEntity::GetUniqueID(void) { return m_sUniqueID; }
 void Simplex::MyEntity::SetAxisVisible(bool a_bSetAxis) { m_bSetAxis = a_bSetAxis; }
-void Simplex::MyEntity::SetPosition(vector3 a_v3Position) { if(m_pSolver) m_pSolver->SetPosition(a_v3Position); }
+void Simplex::MyEntity::SetOccluder(bool a_bOccluder) { m_bOccluder = a_bOccluder; }
+bool Simplex::MyEntity::IsOccluder(void) { return m_bOccluder; }
+void Simplex::MyEntity::SetOccluded(bool a_bOccluded) { m_bOccluded = a_bOccluded; }
+bool Simplex::MyEntity::IsOccluded(void) { return m_bOccluded; }
+void Simplex::MyEntity::SetPosition(vector3 a_v3Position)
+{
+	if (m_pSolver == nullptr)
+		return;
+
+	m_pSolver->SetPosition(m_uSolverIndex, a_v3Position);
+	m_pSolver->ResetPreviousPosition(m_uSolverIndex);
+}
 Simplex::vector3 Simplex::MyEntity::GetPosition(void)
 {
 	if (m_pSolver != nullptr)
-		return m_pSolver->GetPosition();
+		return m_pSolver->GetPosition(m_uSolverIndex);
 	return vector3();
 }
 
-void Simplex::MyEntity::SetVelocity(vector3 a_v3Velocity) { if (m_pSolver) m_pSolver->SetVelocity(a_v3Velocity); }
+void Simplex::MyEntity::SetVelocity(vector3 a_v3Velocity) { if (m_pSolver) m_pSolver->SetVelocity(m_uSolverIndex, a_v3Velocity); }
 Simplex::vector3 Simplex::MyEntity::GetVelocity(void)
 {
 	if (m_pSolver != nullptr)
-		return m_pSolver->GetVelocity();
+		return m_pSolver->GetVelocity(m_uSolverIndex);
 	return vector3();
 }
 
-void Simplex::MyEntity::SetMass(float a_fMass) { if (m_pSolver) m_pSolver->SetMass(a_fMass); }
+void Simplex::MyEntity::SetMass(float a_fMass) { if (m_pSolver) m_pSolver->SetMass(m_uSolverIndex, a_fMass); }
 float Simplex::MyEntity::GetMass(void)
 {
 	if (m_pSolver != nullptr)
-		return m_pSolver->GetMass();
+		return m_pSolver->GetMass(m_uSolverIndex);
 	return 1.0f;
 }
 //  MyEntity
 void Simplex::MyEntity::Init(void)
 {
+#ifndef SIMPLEX_HEADLESS
 	m_pMeshMngr = MeshManager::GetInstance();
+#endif
 	m_bInMemory = false;
 	m_bSetAxis = false;
 	m_pModel = nullptr;
@@ -71,7 +103,11 @@ void Simplex::MyEntity::Init(void)
 	m_sUniqueID = "";
 	m_nDimensionCount = 0;
 	m_bUsePhysicsSolver = false;
-	m_pSolver = nullptr;
+	m_pSolver = MySolver::GetInstance();
+	m_uSolverIndex = NO_BODY;
+	m_bSleeping = false;
+	m_bOccluder = false;
+	m_bOccluded = false;
 }
 void Simplex::MyEntity::Swap(MyEntity& other)
 {
@@ -85,53 +121,72 @@ void Simplex::MyEntity::Swap(MyEntity& other)
 	std::swap(m_bSetAxis, other.m_bSetAxis);
 	std::swap(m_nDimensionCount, other.m_nDimensionCount);
 	std::swap(m_DimensionArray, other.m_DimensionArray);
+	std::swap(m_bUsePhysicsSolver, other.m_bUsePhysicsSolver);
 	std::swap(m_pSolver, other.m_pSolver);
+	std::swap(m_uSolverIndex, other.m_uSolverIndex);
+	std::swap(m_bSleeping, other.m_bSleeping);
+	std::swap(m_bOccluder, other.m_bOccluder);
+	std::swap(m_bOccluded, other.m_bOccluded);
 }
 void Simplex::MyEntity::Release(void)
 {
 	m_pMeshMngr = nullptr;
-	//it is not the job of the entity to release the model, 
-	//it is for the mesh manager to do so.
-	m_pModel = nullptr;
+#ifndef SIMPLEX_HEADLESS
+	//the model is an instance only this entity uses, the source stays in the cache
+	SafeDelete(m_pModel);
+#endif
 	if (m_DimensionArray)
 	{
 		delete[] m_DimensionArray;
 		m_DimensionArray = nullptr;
 	}
 	SafeDelete(m_pRigidBody);
-	SafeDelete(m_pSolver);
-	m_IDMap.erase(m_sUniqueID);
+	//the body belongs to the solver, we just give our slot back
+	if (m_pSolver && m_uSolverIndex != NO_BODY)
+		m_pSolver->RemoveBody(m_uSolverIndex);
+	m_uSolverIndex = NO_BODY;
+	m_pSolver = nullptr;
 }
 //The big 3
+Simplex::MyEntity::MyEntity(void) { Init(); }
 Simplex::MyEntity::MyEntity(String a_sFileName, String a_sUniqueID)
 {
 	Init();
-	m_pModel = new Model();
-	m_pModel->Load(a_sFileName);
-	//if the model is loaded
-	if (m_pModel->GetName() != "")
-	{
-		GenUniqueID(a_sUniqueID);
-		m_sUniqueID = a_sUniqueID;
-		m_IDMap[a_sUniqueID] = this;
-		m_pRigidBody = new MyRigidBody(m_pModel->GetVertexList()); //generate a rigid body
-		m_bInMemory = true; //mark this entity as viable
-	}
-	m_pSolver = new MySolver();
+	Load(a_sFileName, a_sUniqueID);
+}
+Simplex::MyEntity::MyEntity(std::vector<vector3> a_VertexList, String a_sUniqueID)
+{
+	Init();
+	Load(a_VertexList, a_sUniqueID);
 }
 Simplex::MyEntity::MyEntity(MyEntity const& other)
 {
 	m_bInMemory = other.m_bInMemory;
-	m_pModel = other.m_pModel;
-	//generate a new rigid body we do not share the same rigid body as we do the model
-	m_pRigidBody = new MyRigidBody(m_pModel->GetVertexList()); 
+	m_pModel = nullptr;
+#ifndef SIMPLEX_HEADLESS
+	//the copy gets its own instance of the model so each one can release it
+	if (other.m_pModel)
+	{
+		m_pModel = new Model();
+		m_pModel->Instance(other.m_pModel, other.m_sUniqueID);
+	}
+#endif
+	//generate a new rigid body we do not share the same rigid body as we do the model,
+	//only its local shape
+	if (other.m_pRigidBody)
+		m_pRigidBody = new MyRigidBody(other.m_pRigidBody->GetShape());
 	m_m4ToWorld = other.m_m4ToWorld;
 	m_pMeshMngr = other.m_pMeshMngr;
 	m_sUniqueID = other.m_sUniqueID;
 	m_bSetAxis = other.m_bSetAxis;
 	m_nDimensionCount = other.m_nDimensionCount;
 	m_DimensionArray = other.m_DimensionArray;
-	m_pSolver = new MySolver(*other.m_pSolver);
+	m_bUsePhysicsSolver = other.m_bUsePhysicsSolver;
+	m_pSolver = other.m_pSolver;
+	m_uSolverIndex = m_pSolver->AddBody(other.m_uSolverIndex);
+	m_bSleeping = other.m_bSleeping;
+	m_bOccluder = other.m_bOccluder;
+	m_bOccluded = other.m_bOccluded;
 }
 MyEntity& Simplex::MyEntity::operator=(MyEntity const& other)
 {
@@ -146,14 +201,71 @@ MyEntity& Simplex::MyEntity::operator=(MyEntity const& other)
 }
 MyEntity::~MyEntity(){Release();}
 //--- Methods
+bool Simplex::MyEntity::Load(String a_sFileName, String a_sUniqueID)
+{
+	//start from an empty entity, it could be a reused one
+	Unload();
+#ifdef SIMPLEX_HEADLESS
+	//without a window there is no model to load, only its vertices are read to shape the rigid body
+	PRigidBodyShape pShape = GetSourceShape(a_sFileName);
+	//if the vertices are loaded
+	if (pShape)
+	{
+		GenUniqueID(a_sUniqueID);
+		m_sUniqueID = a_sUniqueID;
+		m_pRigidBody = new MyRigidBody(pShape); //generate a rigid body
+		m_bInMemory = true; //mark this entity as viable
+	}
+#else
+	//the file is loaded once, every entity of it is an instance with only its own transform
+	Model* pSource = GetSourceModel(a_sFileName);
+	if (pSource)
+	{
+		m_pModel = new Model();
+		m_pModel->Instance(pSource, a_sUniqueID);
+	}
+	//if the model is loaded
+	if (m_pModel && m_pModel->GetName() != "")
+	{
+		GenUniqueID(a_sUniqueID);
+		m_sUniqueID = a_sUniqueID;
+		m_pRigidBody = new MyRigidBody(GetSourceShape(a_sFileName)); //generate a rigid body
+		m_bInMemory = true; //mark this entity as viable
+	}
+#endif
+	m_uSolverIndex = m_pSolver->AddBody();
+	return m_bInMemory;
+}
+bool Simplex::MyEntity::Load(std::vector<vector3> a_VertexList, String a_sUniqueID)
+{
+	//start from an empty entity, it could be a reused one
+	Unload();
+	//there is no model, the vertices are only used for the rigid body
+	if (!a_VertexList.empty())
+	{
+		GenUniqueID(a_sUniqueID);
+		m_sUniqueID = a_sUniqueID;
+		m_pRigidBody = new MyRigidBody(a_VertexList); //generate a rigid body
+		m_bInMemory = true; //mark this entity as viable
+	}
+	m_uSolverIndex = m_pSolver->AddBody();
+	return m_bInMemory;
+}
+void Simplex::MyEntity::Unload(void)
+{
+	Release();
+	Init();
+}
 void Simplex::MyEntity::AddToRenderList(bool a_bDrawRigidBody)
 {
 	//if not in memory return
 	if (!m_bInMemory)
 		return;
 
+#ifndef SIMPLEX_HEADLESS
 	//draw model
-	m_pModel->AddToRenderList();
+	if (m_pModel)
+		m_pModel->AddToRenderList();
 	
 	//draw rigid body
 	if(a_bDrawRigidBody)
@@ -161,26 +273,112 @@ void Simplex::MyEntity::AddToRenderList(bool a_bDrawRigidBody)
 
 	if (m_bSetAxis)
 		m_pMeshMngr->AddAxisToRenderList(m_m4ToWorld);
+#else
+	//nothing is drawn without a window
+	(void)a_bDrawRigidBody;
+#endif
+}
+void Simplex::MyEntity::SetModelFolder(String a_sFolder)
+{
+	m_sModelFolder = a_sFolder;
+#ifdef SIMPLEX_HEADLESS
+	//the files read so far came from the old folder
+	m_ShapeCache.clear();
+#endif
+}
+Simplex::PRigidBodyShape Simplex::MyEntity::GetSourceShape(String a_sFileName)
+{
+	//look for the file in the ones already shaped
+	auto cached = m_ShapeCache.find(a_sFileName);
+	if (cached != m_ShapeCache.end())
+		return cached->second;
+
+	PRigidBodyShape pShape = nullptr;
+#ifdef SIMPLEX_HEADLESS
+	//names are given as in the windowed build, relative to the model folder and with Windows separators
+	String sPath = m_sModelFolder + a_sFileName;
+	std::replace(sPath.begin(), sPath.end(), '\\', '/');
+	std::vector<vector3> vertexList = LoadVertexList(sPath);
+	if (!vertexList.empty())
+		pShape = MyRigidBody::MakeShape(vertexList);
+#else
+	Model* pSource = GetSourceModel(a_sFileName);
+	if (pSource)
+		pShape = MyRigidBody::MakeShape(pSource->GetVertexList());
+#endif
+	//files that cannot be loaded are cached too, so they are not tried again
+	m_ShapeCache[a_sFileName] = pShape;
+	return pShape;
+}
+#ifndef SIMPLEX_HEADLESS
+Model* Simplex::MyEntity::GetSourceModel(String a_sFileName)
+{
+	//look for the file in the ones already loaded
+	auto cached = m_ModelCache.find(a_sFileName);
+	if (cached != m_ModelCache.end())
+		return cached->second;
+
+	//load it, if it cannot be loaded remember it so it is not tried again
+	Model* pModel = new Model();
+	pModel->Load(a_sFileName);
+	if (pModel->GetName() == "")
+		SafeDelete(pModel);
+	m_ModelCache[a_sFileName] = pModel;
+	return pModel;
+}
+#endif
+void Simplex::MyEntity::ReleaseModelCache(void)
+{
+#ifndef SIMPLEX_HEADLESS
+	for (auto& cached : m_ModelCache)
+	{
+		SafeDelete(cached.second);
+	}
+	m_ModelCache.clear();
+#endif
+	m_ShapeCache.clear();
+}
+std::vector<Simplex::vector3> Simplex::MyEntity::LoadVertexList(String a_sFileName)
+{
+	std::vector<vector3> vertexList;
+	std::ifstream file(a_sFileName);
+	if (!file.is_open())
+		return vertexList;
+
+	//only the positions are needed, every other line of the OBJ is skipped
+	String sLine;
+	while (std::getline(file, sLine))
+	{
+		if (sLine.size() < 2 || sLine[0] != 'v' || (sLine[1] != ' ' && sLine[1] != '\t'))
+			continue;
+
+		vector3 v3Position;
+		std::istringstream stream(sLine.substr(2));
+		if (stream >> v3Position.x >> v3Position.y >> v3Position.z)
+			vertexList.push_back(v3Position);
+	}
+	return vertexList;
 }
 MyEntity* Simplex::MyEntity::GetEntity(String a_sUniqueID)
 {
-	//look the entity based on the unique id
-	auto entity = m_IDMap.find(a_sUniqueID);
-	//if not found return nullptr, if found return it
-	return entity == m_IDMap.end() ? nullptr : entity->second;
+	//the manager keeps the only table of the unique ids in use
+	return MyEntityManager::GetInstance()->GetEntity(a_sUniqueID);
 }
 void Simplex::MyEntity::GenUniqueID(String& a_sUniqueID)
 {
-	static uint index = 0;
+	//the name is used as is when nobody has it
+	if (!GetEntity(a_sUniqueID))
+		return;
+	//otherwise continue from the last suffix given to this name, so adding many
+	//entities with the same name does not test every suffix used before
 	String sName = a_sUniqueID;
-	MyEntity* pEntity = GetEntity(a_sUniqueID);
-	//while MyEntity exists keep changing name
-	while (pEntity)
+	uint& uIndex = m_NameCounterMap[sName];
+	//the loop only repeats when a suffixed name was taken explicitly
+	do
 	{
-		a_sUniqueID = sName + "_" + std::to_string(index);
-		index++;
-		pEntity = GetEntity(a_sUniqueID);
-	}
+		a_sUniqueID = sName + "_" + std::to_string(uIndex);
+		++uIndex;
+	} while (GetEntity(a_sUniqueID));
 	return;
 }
 void Simplex::MyEntity::AddDimension(uint a_uDimension)
@@ -292,6 +490,17 @@ bool Simplex::MyEntity::IsColliding(MyEntity* const other)
 
 	return m_pRigidBody->IsColliding(other->GetRigidBody());
 }
+bool Simplex::MyEntity::IsOverlapping(MyEntity* const other)
+{
+	//same rules as IsColliding
+	if (!m_bInMemory || !other->m_bInMemory)
+		return true;
+
+	if (!SharesDimension(other))
+		return false;
+
+	return m_pRigidBody->IsOverlapping(other->GetRigidBody());
+}
 void Simplex::MyEntity::ClearCollisionList(void)
 {
 	m_pRigidBody->ClearCollidingList();
@@ -302,24 +511,115 @@ void Simplex::MyEntity::SortDimensions(void)
 }
 void Simplex::MyEntity::ApplyForce(vector3 a_v3Force)
 {
-	m_pSolver->ApplyForce(a_v3Force);
+	m_pSolver->ApplyForce(m_uSolverIndex, a_v3Force);
 }
 void Simplex::MyEntity::Update(void)
 {
+	//the solver already integrated the body, place the entity where it ended
 	if (m_bUsePhysicsSolver)
 	{
-		m_pSolver->Update();
-		SetModelMatrix(glm::translate(m_pSolver->GetPosition()) * glm::scale(m_pSolver->GetSize()));
+		//a sleeping body has not moved, but the one that just fell asleep still needs to be placed
+		bool bSleeping = IsSleeping();
+		if (!bSleeping || !m_bSleeping)
+			PlaceModel(glm::translate(m_pSolver->GetPosition(m_uSolverIndex)) * glm::scale(m_pSolver->GetSize(m_uSolverIndex)));
+		m_bSleeping = bSleeping;
 	}
 }
-void Simplex::MyEntity::ResolveCollision(MyEntity* a_pOther)
+void Simplex::MyEntity::Interpolate(float a_fAlpha)
+{
+#ifndef SIMPLEX_HEADLESS
+	//if not in memory, not moved by the solver, sleeping or without a model it is already where it should be
+	if (!m_bInMemory || !m_bUsePhysicsSolver || m_bSleeping || !m_pModel)
+		return;
+
+	vector3 v3Position = glm::mix(m_pSolver->GetPreviousPosition(m_uSolverIndex), m_pSolver->GetPosition(m_uSolverIndex), a_fAlpha);
+	SetRenderMatrix(glm::translate(v3Position) * glm::scale(m_pSolver->GetSize(m_uSolverIndex)));
+#else
+	//without a model there is nothing to place between steps
+	(void)a_fAlpha;
+#endif
+}
+Simplex::matrix4 Simplex::MyEntity::GetRenderMatrix(void) { return m_m4Render; }
+void Simplex::MyEntity::SetRenderMatrix(matrix4 a_m4ToWorld)
+{
+	if (!m_bInMemory)
+		return;
+
+	m_m4Render = a_m4ToWorld;
+#ifndef SIMPLEX_HEADLESS
+	if (m_pModel)
+		m_pModel->SetModelMatrix(m_m4Render);
+#endif
+}
+void Simplex::MyEntity::ResolveCollision(MyEntity* a_pOther, vector3 a_v3Normal)
 {
 	if (m_bUsePhysicsSolver)
-	{
-		m_pSolver->ResolveCollision(a_pOther->GetSolver());
-	}
+		m_pSolver->ResolveCollision(m_uSolverIndex, a_pOther->GetSolverIndex(), a_v3Normal);
 }
 void Simplex::MyEntity::UsePhysicsSolver(bool a_bUse)
 {
 	m_bUsePhysicsSolver = a_bUse;
+	if (m_pSolver)
+		m_pSolver->SetSimulated(m_uSolverIndex, a_bUse);
+}
+bool Simplex::MyEntity::IsUsingPhysicsSolver(void) { return m_bUsePhysicsSolver; }
+bool Simplex::MyEntity::IsSleeping(void)
+{
+	if (m_pSolver != nullptr && m_bUsePhysicsSolver)
+		return !m_pSolver->IsAwake(m_uSolverIndex);
+	return false;
+}
+void Simplex::MyEntity::UseContinuousCollision(bool a_bUse)
+{
+	if (m_pSolver)
+		m_pSolver->SetContinuous(m_uSolverIndex, a_bUse);
+}
+bool Simplex::MyEntity::IsContinuous(void)
+{
+	if (m_pSolver != nullptr)
+		return m_bUsePhysicsSolver && m_pSolver->IsContinuous(m_uSolverIndex);
+	return false;
+}
+bool Simplex::MyEntity::IsOverlappingSwept(MyEntity* const a_pOther)
+{
+	//same rules as IsColliding
+	if (!m_bInMemory || !a_pOther->m_bInMemory)
+		return true;
+
+	if (!SharesDimension(a_pOther))
+		return false;
+
+	//only bodies moved by the solver will move during the step, friction only makes the motion shorter
+	vector3 v3Motion = m_bUsePhysicsSolver ? m_pSolver->GetVelocity(m_uSolverIndex) : ZERO_V3;
+	vector3 v3OtherMotion = a_pOther->m_bUsePhysicsSolver ? m_pSolver->GetVelocity(a_pOther->m_uSolverIndex) : ZERO_V3;
+
+	return m_pRigidBody->IsOverlappingSwept(a_pOther->GetRigidBody(), v3Motion, v3OtherMotion);
+}
+bool Simplex::MyEntity::IsCollidingSwept(MyEntity* const a_pOther, float& a_fTimeOfImpact, vector3& a_v3Normal)
+{
+	a_fTimeOfImpact = 1.0f;
+	a_v3Normal = ZERO_V3;
+
+	//if not in memory return
+	if (!m_bInMemory || !a_pOther->m_bInMemory)
+		return false;
+
+	//if the entities are not living in the same dimension
+	//they are not colliding
+	if (!SharesDimension(a_pOther))
+		return false;
+
+	//only bodies moved by the solver have motion in this frame
+	vector3 v3Motion = m_bUsePhysicsSolver ? m_pSolver->GetDisplacement(m_uSolverIndex) : ZERO_V3;
+	vector3 v3OtherMotion = a_pOther->m_bUsePhysicsSolver ? m_pSolver->GetDisplacement(a_pOther->m_uSolverIndex) : ZERO_V3;
+
+	return m_pRigidBody->IsCollidingSwept(a_pOther->GetRigidBody(), v3Motion, v3OtherMotion, a_fTimeOfImpact, a_v3Normal);
+}
+void Simplex::MyEntity::AdvanceTo(float a_fTime)
+{
+	if (!m_bUsePhysicsSolver)
+		return;
+
+	m_pSolver->AdvanceTo(m_uSolverIndex, a_fTime);
+	PlaceModel(glm::translate(m_pSolver->GetPosition(m_uSolverIndex)) * glm::scale(m_pSolver->GetSize(m_uSolverIndex)));
 }
\ No newline at end of file
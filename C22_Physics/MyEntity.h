@@ -6,6 +6,7 @@ Date: 2017/07
 #define __MYENTITY_H_
 
 #include "MySolver.h"
+#include <unordered_map>
 
 namespace Simplex
 {
@@ -24,15 +25,33 @@ class MyEntity
 	MyRigidBody* m_pRigidBody = nullptr; //Rigid Body associated with this MyEntity
 
 	matrix4 m_m4ToWorld = IDENTITY_M4; //Model matrix associated with this MyEntity
+	matrix4 m_m4Render = IDENTITY_M4; //Model matrix the model is drawn with, in between physics states
 	MeshManager* m_pMeshMngr = nullptr; //For rendering shapes
 
-	static std::map<String, MyEntity*> m_IDMap; //a map of the unique ID's
+	static std::unordered_map<String, uint> m_NameCounterMap; //next suffix to try for each name asked for
+	static String m_sModelFolder; //folder the model files are read from when there is no window to load them
+#ifndef SIMPLEX_HEADLESS
+	static std::unordered_map<String, Model*> m_ModelCache; //model loaded once per file, entities get an instance of it
+#endif
+	static std::unordered_map<String, PRigidBodyShape> m_ShapeCache; //rigid body shape of each model file, computed once
 
 	bool m_bUsePhysicsSolver = false; //Indicates if we will use a physics solver 
 
-	MySolver* m_pSolver = nullptr; //Physics MySolver
+	MySolver* m_pSolver = nullptr; //Physics MySolver, owns the state of the body
+	static const uint NO_BODY = ~0u; //solver index of an entity that has no body
+	uint m_uSolverIndex = NO_BODY; //index of the body of this entity in the solver
+	bool m_bSleeping = false; //was the body sleeping the last time the entity was updated?
+
+	bool m_bOccluder = false; //is its box rasterized for occlusion culling?
+	bool m_bOccluded = false; //was it behind the occluders the last time they were culled?
 
 public:
+	/*
+	Usage: Constructor of an empty entity, not initialized until something is loaded into it
+	Arguments: ---
+	Output: class object instance
+	*/
+	MyEntity(void);
 	/*
 	Usage: Constructor that specifies the name attached to the MyEntity
 	Arguments:
@@ -42,6 +61,14 @@ public:
 	*/
 	MyEntity(String a_sFileName, String a_sUniqueID = "NA");
 	/*
+	Usage: Constructor of an entity without a model, only its rigid body is generated
+	Arguments:
+	-	std::vector<vector3> a_VertexList -> vertices of the collision shape
+	-	String a_sUniqueID -> Name wanted as identifier, if not available will generate one
+	Output: class object instance
+	*/
+	MyEntity(std::vector<vector3> a_VertexList, String a_sUniqueID = "NA");
+	/*
 	Usage: Copy Constructor
 	Arguments: class object to copy
 	Output: class object instance
@@ -54,6 +81,29 @@ public:
 	*/
 	MyEntity& operator=(MyEntity const& other);
 	/*
+	USAGE: Loads a model into the entity, releasing whatever it had before so it can be reused
+	ARGUMENTS:
+	-	String a_sFileName -> name of the model to load
+	-	String a_sUniqueID -> name wanted as identifier, if not available will generate one
+	OUTPUT: was it loaded?
+	*/
+	bool Load(String a_sFileName, String a_sUniqueID = "NA");
+	/*
+	USAGE: Generates the rigid body of the entity from a vertex list, releasing whatever it had before so it can be reused
+	ARGUMENTS:
+	-	std::vector<vector3> a_VertexList -> vertices of the collision shape
+	-	String a_sUniqueID -> name wanted as identifier, if not available will generate one
+	OUTPUT: was it generated?
+	*/
+	bool Load(std::vector<vector3> a_VertexList, String a_sUniqueID = "NA");
+	/*
+	USAGE: Releases the model, rigid body, solver body and identifier of the entity, leaving it as newly
+	constructed so it can be kept in a pool and loaded again
+	ARGUMENTS: ---
+	OUTPUT: ---
+	*/
+	void Unload(void);
+	/*
 	Usage: Destructor
 	Arguments: ---
 	Output: ---
@@ -72,7 +122,8 @@ public:
 	*/
 	matrix4 GetModelMatrix(void);
 	/*
-	USAGE: Sets the model matrix associated with this entity
+	USAGE: Sets the model matrix associated with this entity, the entity is placed there from outside the solver
+	so it does not travel from where it was
 	ARGUMENTS: matrix4 a_m4ToWorld -> model matrix to set
 	OUTPUT: ---
 	*/
@@ -108,13 +159,56 @@ public:
 	*/
 	bool IsColliding(MyEntity* const other);
 	/*
-	USAGE: Gets the MyEntity specified by unique ID, nullptr if not exists
+	USAGE: Tells if this entity is colliding with the incoming one without storing the collision,
+	so it can be asked from several threads at once
+	ARGUMENTS: MyEntity* const other -> inspected entity
+	OUTPUT: are they colliding?
+	*/
+	bool IsOverlapping(MyEntity* const other);
+	/*
+	USAGE: Gets the MyEntity specified by unique ID, nullptr if not exists, looked up in the entity manager
 	ARGUMENTS: String a_sUniqueID -> unique ID if the queried entity
 	OUTPUT: MyEntity specified by unique ID, nullptr if not exists
 	*/
 	static MyEntity* GetEntity(String a_sUniqueID);
 	/*
-	USAGE: Will generate a unique id based on the name provided
+	USAGE: Reads the vertex positions of an OBJ file without loading it as a model
+	ARGUMENTS: String a_sFileName -> path of the file
+	OUTPUT: vertex positions, empty if the file could not be read
+	*/
+	static std::vector<vector3> LoadVertexList(String a_sFileName);
+	/*
+	USAGE: Sets the folder the model files are read from when there is no window, the windowed build
+	loads them from the folder of the Simplex system instead
+	ARGUMENTS: String a_sFolder -> folder, ending in a separator
+	OUTPUT: ---
+	*/
+	static void SetModelFolder(String a_sFolder);
+	/*
+	USAGE: Gets the local space shape of the rigid bodies of a model file, it is only computed the
+	first time it is asked for and then shared by every entity of that file
+	ARGUMENTS: String a_sFileName -> name of the model
+	OUTPUT: shape, nullptr if the model could not be loaded
+	*/
+	static PRigidBodyShape GetSourceShape(String a_sFileName);
+#ifndef SIMPLEX_HEADLESS
+	/*
+	USAGE: Gets the model loaded from a file, the file is only loaded the first time it is asked for;
+	entities do not draw this model, they make an instance of it sharing its groups, meshes and materials
+	ARGUMENTS: String a_sFileName -> name of the model to load
+	OUTPUT: loaded model, nullptr if it could not be loaded
+	*/
+	static Model* GetSourceModel(String a_sFileName);
+#endif
+	/*
+	USAGE: Frees the models loaded by GetSourceModel and the shapes made from them, only once no entity
+	holds an instance of them
+	ARGUMENTS: ---
+	OUTPUT: ---
+	*/
+	static void ReleaseModelCache(void);
+	/*
+	USAGE: Will generate a unique id based on the name provided, not used by any entity of the manager
 	ARGUMENTS: String& a_sUniqueID -> desired name
 	OUTPUT: will output though the argument
 	*/
@@ -198,18 +292,20 @@ public:
 	bool HasThisRigidBody(MyRigidBody* a_pRigidBody);
 
 	/*
-	USAGE: Asks the entity to resolve the collision with the incoming one
-	ARGUMENTS: MyEntity* a_pOther -> Queried entity
+	USAGE: Asks the entity to resolve the collision with the incoming one, stopping them from approaching each other
+	ARGUMENTS:
+	-	MyEntity* a_pOther -> Queried entity
+	-	vector3 a_v3Normal -> axis of the contact pointing from this entity to the queried one
 	OUTPUT: ---
 	*/
-	void ResolveCollision(MyEntity* a_pOther);
+	void ResolveCollision(MyEntity* a_pOther, vector3 a_v3Normal);
 
 	/*
-	USAGE: Gets the solver applied to this MyEntity
+	USAGE: Gets the index of the body of this MyEntity in the solver
 	ARGUMENTS: ---
-	OUTPUT: MySolver applied
+	OUTPUT: index of the body
 	*/
-	MySolver* GetSolver(void);
+	uint GetSolverIndex(void);
 	/*
 	USAGE: Applies a force to the solver
 	ARGUMENTS: vector3 a_v3Force -> force to apply
@@ -217,7 +313,8 @@ public:
 	*/
 	void ApplyForce(vector3 a_v3Force);
 	/*
-	USAGE: Sets the position of the solver
+	USAGE: Sets the position of the solver, the body is placed there from outside the solver so it does not
+	travel from where it was
 	ARGUMENTS: vector3 a_v3Position -> position to set
 	OUTPUT: ---
 	*/
@@ -262,11 +359,103 @@ public:
 	*/
 	void Update(void);
 	/*
+	USAGE: Places the model in between the last two physics states for rendering, the rigid body
+	stays on the last physics state
+	ARGUMENTS: float a_fAlpha -> fraction of a step, 0 previous state, 1 current state
+	OUTPUT: ---
+	*/
+	void Interpolate(float a_fAlpha);
+	/*
+	USAGE: Gets the matrix the model is drawn with, the model matrix unless it is interpolated
+	ARGUMENTS: ---
+	OUTPUT: model to world matrix for rendering
+	*/
+	matrix4 GetRenderMatrix(void);
+	/*
+	USAGE: Draws the model with a matrix other than the model matrix until the entity is placed again, the
+	rigid body stays where it is
+	ARGUMENTS: matrix4 a_m4ToWorld -> model matrix for rendering
+	OUTPUT: ---
+	*/
+	void SetRenderMatrix(matrix4 a_m4ToWorld);
+	/*
 	USAGE: Resolves using physics solver or not in the update
 	ARGUMENTS: bool a_bUse = true -> using physics solver?
 	OUTPUT: ---
 	*/
 	void UsePhysicsSolver(bool a_bUse = true);
+	/*
+	USAGE: Asks if this entity is using the physics solver
+	ARGUMENTS: ---
+	OUTPUT: using physics solver?
+	*/
+	bool IsUsingPhysicsSolver(void);
+	/*
+	USAGE: Asks if the body of this entity is sleeping, entities not using the physics solver never sleep
+	ARGUMENTS: ---
+	OUTPUT: sleeping?
+	*/
+	bool IsSleeping(void);
+	/*
+	USAGE: Marks this entity as a fast mover that uses continuous collision detection
+	ARGUMENTS: bool a_bUse = true -> use continuous collision detection?
+	OUTPUT: ---
+	*/
+	void UseContinuousCollision(bool a_bUse = true);
+	/*
+	USAGE: Asks if this entity uses continuous collision detection
+	ARGUMENTS: ---
+	OUTPUT: is this a fast mover?
+	*/
+	bool IsContinuous(void);
+	/*
+	USAGE: Marks this entity as an occluder, its rigid body box is drawn into the occlusion buffer so it
+	hides the entities behind it, only for entities that fill their box (walls, floors, crates)
+	ARGUMENTS: bool a_bOccluder = true -> is it an occluder?
+	OUTPUT: ---
+	*/
+	void SetOccluder(bool a_bOccluder = true);
+	/*
+	USAGE: Asks if this entity is an occluder
+	ARGUMENTS: ---
+	OUTPUT: is it an occluder?
+	*/
+	bool IsOccluder(void);
+	/*
+	USAGE: Sets whether this entity was found behind the occluders, set by the entity manager when culling
+	ARGUMENTS: bool a_bOccluded -> is it hidden?
+	OUTPUT: ---
+	*/
+	void SetOccluded(bool a_bOccluded);
+	/*
+	USAGE: Asks if this entity was behind the occluders the last time they were culled
+	ARGUMENTS: ---
+	OUTPUT: is it hidden?
+	*/
+	bool IsOccluded(void);
+	/*
+	USAGE: Tells if the boxes swept along the motion both entities are about to make overlap, the motion is
+	their velocity once the forces of the step are applied, it does not store anything so it can be asked
+	from several threads at once
+	ARGUMENTS: MyEntity* const a_pOther -> inspected entity
+	OUTPUT: could they collide during the step?
+	*/
+	bool IsOverlappingSwept(MyEntity* const a_pOther);
+	/*
+	USAGE: Checks the motion of this frame against the incoming entity
+	ARGUMENTS:
+	-	MyEntity* const a_pOther -> inspected entity
+	-	float& a_fTimeOfImpact -> (output) time of the first contact, 0 start of the frame, 1 end of it
+	-	vector3& a_v3Normal -> (output) axis of the face they touch on, pointing from this entity to the inspected one
+	OUTPUT: are they colliding during the frame?
+	*/
+	bool IsCollidingSwept(MyEntity* const a_pOther, float& a_fTimeOfImpact, vector3& a_v3Normal);
+	/*
+	USAGE: Moves the entity back along the motion of this frame up to the time specified
+	ARGUMENTS: float a_fTime -> time in the frame to move to, 0 start of the frame, 1 end of it
+	OUTPUT: ---
+	*/
+	void AdvanceTo(float a_fTime);
 
 private:
 	/*
@@ -281,6 +470,13 @@ private:
 	Output: ---
 	*/
 	void Init(void);
+	/*
+	USAGE: Places the model, the rigid body and the body of the solver on the model matrix, the previous position
+	of the body is kept so the solver can move it there
+	ARGUMENTS: matrix4 a_m4ToWorld -> model matrix to set
+	OUTPUT: ---
+	*/
+	void PlaceModel(matrix4 a_m4ToWorld);
 };//class
 
 } //namespace Simplex
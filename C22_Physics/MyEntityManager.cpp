@@ -5,17 +5,68 @@ Simplex::MyEntityManager* Simplex::MyEntityManager::m_pInstance = nullptr;
 void Simplex::MyEntityManager::Init(void)
 {
 	m_uEntityCount = 0;
+	m_uEntityCapacity = 0;
 	m_mEntityArray = nullptr;
+	m_SlotList.clear();
+	m_FreeSlotList.clear();
+	m_EntitySlotList.clear();
+	m_EntityPool.clear();
+	m_IDSlotMap.clear();
+	m_TransformList.clear();
+	m_HierarchyList.clear();
+	m_bHierarchyChanged = false;
+	m_uHierarchyUpdateCount = 0;
+
+#ifndef SIMPLEX_HEADLESS
+	m_uClock = SystemSingleton::GetInstance()->GenClock();
+#endif
+	m_fFixedTimeStep = 1.0f / 60.0f;
+	m_uMaxSubsteps = 5;
+	m_fAccumulator = 0.0f;
+	m_fInterpolation = 0.0f;
+	m_uSubstepCount = 0;
+	m_uIslandCount = 0;
+	for (uint i = 0; i < PHASE_COUNT; i++)
+	{
+		m_fPhaseTime[i] = 0.0f;
+		m_fFramePhaseTime[i] = 0.0f;
+	}
+	m_pRecorder = nullptr;
+	m_bOcclusionCulling = false;
+	m_fOcclusionTime = 0.0f;
 }
 void Simplex::MyEntityManager::Release(void)
 {
+	StopRecording();
+
 	for (uint uEntity = 0; uEntity < m_uEntityCount; ++uEntity)
 	{
 		MyEntity* pEntity = m_mEntityArray[uEntity];
 		SafeDelete(pEntity);
 	}
+	if (m_mEntityArray)
+	{
+		delete[] m_mEntityArray;
+	}
 	m_uEntityCount = 0;
+	m_uEntityCapacity = 0;
 	m_mEntityArray = nullptr;
+
+	for (uint i = 0; i < m_EntityPool.size(); ++i)
+	{
+		SafeDelete(m_EntityPool[i]);
+	}
+	m_EntityPool.clear();
+
+	//no instance of the loaded models is left
+	MyEntity::ReleaseModelCache();
+
+	m_SlotList.clear();
+	m_FreeSlotList.clear();
+	m_EntitySlotList.clear();
+	m_IDSlotMap.clear();
+	m_TransformList.clear();
+	m_HierarchyList.clear();
 }
 Simplex::MyEntityManager* Simplex::MyEntityManager::GetInstance()
 {
@@ -35,17 +86,88 @@ void Simplex::MyEntityManager::ReleaseInstance()
 }
 int Simplex::MyEntityManager::GetEntityIndex(String a_sUniqueID)
 {
-	//look one by one for the specified unique id
-	for (uint uIndex = 0; uIndex < m_uEntityCount; ++uIndex)
-	{
-		if (a_sUniqueID == m_mEntityArray[uIndex]->GetUniqueID())
-			return uIndex;
-	}
+	//look for the slot of the unique id, then for where the slot points to
+	auto slot = m_IDSlotMap.find(a_sUniqueID);
 	//if not found return -1
-	return -1;
+	if (slot == m_IDSlotMap.end())
+		return -1;
+	return static_cast<int>(m_SlotList[slot->second].uIndex);
 }
 //Accessors
 Simplex::uint Simplex::MyEntityManager::GetEntityCount(void) {	return m_uEntityCount; }
+void Simplex::MyEntityManager::SetFixedTimeStep(float a_fTimeStep)
+{
+	//a step of zero would never consume the accumulated time
+	if (a_fTimeStep < 0.001f)
+		a_fTimeStep = 0.001f;
+	m_fFixedTimeStep = a_fTimeStep;
+
+	if (m_pRecorder)
+		m_pRecorder->RecordFixedTimeStep(m_fFixedTimeStep);
+}
+float Simplex::MyEntityManager::GetFixedTimeStep(void) { return m_fFixedTimeStep; }
+void Simplex::MyEntityManager::SetMaxSubsteps(uint a_uMaxSubsteps)
+{
+	m_uMaxSubsteps = a_uMaxSubsteps;
+
+	if (m_pRecorder)
+		m_pRecorder->RecordMaxSubsteps(m_uMaxSubsteps);
+}
+Simplex::uint Simplex::MyEntityManager::GetMaxSubsteps(void) { return m_uMaxSubsteps; }
+Simplex::uint Simplex::MyEntityManager::GetSubstepCount(void) { return m_uSubstepCount; }
+Simplex::uint Simplex::MyEntityManager::GetIslandCount(void) { return m_uIslandCount; }
+float Simplex::MyEntityManager::GetPhaseTime(uint a_uPhase)
+{
+	if (a_uPhase >= PHASE_COUNT)
+		return 0.0f;
+	return m_fPhaseTime[a_uPhase];
+}
+float Simplex::MyEntityManager::GetFramePhaseTime(uint a_uPhase)
+{
+	if (a_uPhase >= PHASE_COUNT)
+		return 0.0f;
+	return m_fFramePhaseTime[a_uPhase];
+}
+bool Simplex::MyEntityManager::StartRecording(String a_sFileName)
+{
+	StopRecording();
+	m_pRecorder = new MyRecorder();
+	if (!m_pRecorder->Open(a_sFileName))
+	{
+		SafeDelete(m_pRecorder);
+		return false;
+	}
+
+	//the settings and the entities that already exist are the starting point of the log
+	m_pRecorder->RecordFixedTimeStep(m_fFixedTimeStep);
+	m_pRecorder->RecordMaxSubsteps(m_uMaxSubsteps);
+	for (uint i = 0; i < m_uEntityCount; i++)
+	{
+		MyEntity* pEntity = m_mEntityArray[i];
+		MyRigidBody* pRigidBody = pEntity->GetRigidBody();
+		std::vector<vector3> box = { pRigidBody->GetMinLocal(), pRigidBody->GetMaxLocal() };
+		m_pRecorder->RecordAddEntity(box, pEntity->GetUniqueID());
+		m_pRecorder->RecordModelMatrix(i, pEntity->GetModelMatrix());
+		m_pRecorder->RecordMass(i, pEntity->GetMass());
+		m_pRecorder->RecordPhysicsSolver(i, pEntity->IsUsingPhysicsSolver());
+		m_pRecorder->RecordContinuous(i, pEntity->IsContinuous());
+	}
+	//then how they hang from each other, once all of them are in the list
+	for (uint i = 0; i < m_uEntityCount; i++)
+	{
+		MyTransformNode& node = m_TransformList[m_EntitySlotList[i]];
+		if (node.uParent != NO_SLOT)
+			m_pRecorder->RecordParent(i, static_cast<int>(m_SlotList[node.uParent].uIndex));
+		if (node.bLocal)
+			m_pRecorder->RecordLocalTransform(i, node.v3Position, node.qOrientation, node.v3Scale);
+	}
+	return true;
+}
+void Simplex::MyEntityManager::StopRecording(void)
+{
+	SafeDelete(m_pRecorder);
+}
+bool Simplex::MyEntityManager::IsRecording(void) { return m_pRecorder != nullptr; }
 Simplex::Model* Simplex::MyEntityManager::GetModel(uint a_uIndex)
 {
 	//if the list is empty return
@@ -61,7 +183,7 @@ Simplex::Model* Simplex::MyEntityManager::GetModel(uint a_uIndex)
 Simplex::Model* Simplex::MyEntityManager::GetModel(String a_sUniqueID)
 {
 	//Get the entity
-	MyEntity* pTemp = MyEntity::GetEntity(a_sUniqueID);
+	MyEntity* pTemp = GetEntity(a_sUniqueID);
 	//if the entity exists
 	if (pTemp)
 	{
@@ -84,7 +206,7 @@ Simplex::MyRigidBody* Simplex::MyEntityManager::GetRigidBody(uint a_uIndex)
 Simplex::MyRigidBody* Simplex::MyEntityManager::GetRigidBody(String a_sUniqueID)
 {
 	//Get the entity
-	MyEntity* pTemp = MyEntity::GetEntity(a_sUniqueID);
+	MyEntity* pTemp = GetEntity(a_sUniqueID);
 	//if the entity exists
 	if (pTemp)
 	{
@@ -107,7 +229,7 @@ Simplex::matrix4 Simplex::MyEntityManager::GetModelMatrix(uint a_uIndex)
 Simplex::matrix4 Simplex::MyEntityManager::GetModelMatrix(String a_sUniqueID)
 {
 	//Get the entity
-	MyEntity* pTemp = MyEntity::GetEntity(a_sUniqueID);
+	MyEntity* pTemp = GetEntity(a_sUniqueID);
 	//if the entity exists
 	if (pTemp)
 	{
@@ -117,13 +239,25 @@ Simplex::matrix4 Simplex::MyEntityManager::GetModelMatrix(String a_sUniqueID)
 }
 void Simplex::MyEntityManager::SetModelMatrix(matrix4 a_m4ToWorld, String a_sUniqueID)
 {
-	//Get the entity
-	MyEntity* pTemp = MyEntity::GetEntity(a_sUniqueID);
+	//Get the entity through the hashed id, the index overload records the call
+	int nIndex = GetEntityIndex(a_sUniqueID);
 	//if the entity exists
+	if (nIndex >= 0)
+		SetModelMatrix(a_m4ToWorld, static_cast<uint>(nIndex));
+}
+Simplex::matrix4 Simplex::MyEntityManager::GetModelMatrix(MyEntityHandle a_hEntity)
+{
+	MyEntity* pTemp = GetEntity(a_hEntity);
 	if (pTemp)
-	{
-		pTemp->SetModelMatrix(a_m4ToWorld);
-	}
+		return pTemp->GetModelMatrix();
+	return IDENTITY_M4;
+}
+void Simplex::MyEntityManager::SetModelMatrix(matrix4 a_m4ToWorld, MyEntityHandle a_hEntity)
+{
+	//resolve the handle and go through the index so it gets recorded
+	int nIndex = GetEntityIndex(a_hEntity);
+	if (nIndex >= 0)
+		SetModelMatrix(a_m4ToWorld, static_cast<uint>(nIndex));
 }
 void Simplex::MyEntityManager::SetAxisVisibility(bool a_bVisibility, uint a_uIndex)
 {
@@ -140,7 +274,7 @@ void Simplex::MyEntityManager::SetAxisVisibility(bool a_bVisibility, uint a_uInd
 void Simplex::MyEntityManager::SetAxisVisibility(bool a_bVisibility, String a_sUniqueID)
 {
 	//Get the entity
-	MyEntity* pTemp = MyEntity::GetEntity(a_sUniqueID);
+	MyEntity* pTemp = GetEntity(a_sUniqueID);
 	//if the entity exists
 	if (pTemp)
 	{
@@ -157,6 +291,9 @@ void Simplex::MyEntityManager::SetModelMatrix(matrix4 a_m4ToWorld, uint a_uIndex
 	if (a_uIndex >= m_uEntityCount)
 		a_uIndex = m_uEntityCount - 1;
 
+	if (m_pRecorder)
+		m_pRecorder->RecordModelMatrix(a_uIndex, a_m4ToWorld);
+
 	m_mEntityArray[a_uIndex]->SetModelMatrix(a_m4ToWorld);
 }
 //The big 3
@@ -165,78 +302,490 @@ Simplex::MyEntityManager::MyEntityManager(MyEntityManager const& a_pOther){ }
 Simplex::MyEntityManager& Simplex::MyEntityManager::operator=(MyEntityManager const& a_pOther) { return *this; }
 Simplex::MyEntityManager::~MyEntityManager(){Release();};
 // other methods
+#ifndef SIMPLEX_HEADLESS
 void Simplex::MyEntityManager::Update(void)
 {
+	Update(static_cast<float>(SystemSingleton::GetInstance()->GetDeltaTime(m_uClock)));
+}
+void Simplex::MyEntityManager::Simulate(void)
+{
+	Simulate(static_cast<float>(SystemSingleton::GetInstance()->GetDeltaTime(m_uClock)));
+}
+#endif
+void Simplex::MyEntityManager::Update(float a_fDeltaTime)
+{
+	Simulate(a_fDeltaTime);
+	Interpolate();
+}
+void Simplex::MyEntityManager::Simulate(float a_fDeltaTime)
+{
+	if (m_pRecorder)
+		m_pRecorder->RecordUpdate(a_fDeltaTime);
+
+	for (uint i = 0; i < PHASE_COUNT; i++)
+	{
+		m_fFramePhaseTime[i] = 0.0f;
+	}
+	m_uHierarchyUpdateCount = 0;
+
+	//accumulate the time that passed since the last update
+	m_fAccumulator += a_fDeltaTime;
+
+	//consume it in fixed steps
+	m_uSubstepCount = 0;
+	while (m_fAccumulator >= m_fFixedTimeStep && m_uSubstepCount < m_uMaxSubsteps)
+	{
+		SimulateStep();
+		m_fAccumulator -= m_fFixedTimeStep;
+		++m_uSubstepCount;
+	}
+
+	//if we could not keep up drop the time left instead of spiraling into more steps
+	if (m_fAccumulator >= m_fFixedTimeStep)
+		m_fAccumulator = 0.0f;
+}
+void Simplex::MyEntityManager::Interpolate(void)
+{
+	//the children follow the parents the steps moved
+	UpdateHierarchy();
+
+	//place the models in between the last two physics states
+	m_fInterpolation = m_fAccumulator / m_fFixedTimeStep;
+	MyJobSystem::GetInstance()->ParallelFor(m_uEntityCount, [this](uint i)
+	{
+		m_mEntityArray[i]->Interpolate(m_fInterpolation);
+	}, "Interpolation");
+
+	//the children are drawn from where their parents are drawn, not from the last physics state
+	for (uint i = 0; i < m_HierarchyList.size(); ++i)
+	{
+		uint uSlot = m_HierarchyList[i];
+		MyTransformNode& node = m_TransformList[uSlot];
+		MyEntity* pEntity = m_mEntityArray[m_SlotList[uSlot].uIndex];
+		if (!node.bLocal)
+		{
+			node.m4Render = pEntity->GetRenderMatrix();
+			continue;
+		}
+
+		matrix4 m4Render = node.m4World;
+		if (node.uParent != NO_SLOT)
+		{
+			MyTransformNode& parent = m_TransformList[node.uParent];
+			if (parent.m4Render != parent.m4World)
+				m4Render = parent.m4Render * glm::translate(node.v3Position) * glm::mat4_cast(node.qOrientation) * glm::scale(node.v3Scale);
+		}
+		if (m4Render == node.m4Render)
+			continue;
+		node.m4Render = m4Render;
+		pEntity->SetRenderMatrix(m4Render);
+	}
+}
+void Simplex::MyEntityManager::Step(void)
+{
+	if (m_pRecorder)
+		m_pRecorder->RecordStep();
+
+	for (uint i = 0; i < PHASE_COUNT; i++)
+	{
+		m_fFramePhaseTime[i] = 0.0f;
+	}
+	m_uHierarchyUpdateCount = 0;
+
+	SimulateStep();
+
+	//the children follow the parents the step moved
+	UpdateHierarchy();
+}
+void Simplex::MyEntityManager::SimulateStep(void)
+{
+	typedef std::chrono::high_resolution_clock Clock;
+	Clock::time_point start = Clock::now();
+	//stores the time since the last mark in the phase and starts the next one
+	auto markPhase = [this, &start](uint a_uPhase)
+	{
+		Clock::time_point end = Clock::now();
+		m_fPhaseTime[a_uPhase] = std::chrono::duration<float, std::milli>(end - start).count();
+		m_fFramePhaseTime[a_uPhase] += m_fPhaseTime[a_uPhase];
+		start = end;
+	};
+
+	//entities attached to others are placed before looking for collisions
+	UpdateHierarchy();
+
 	//Clear all collisions
 	for (uint i = 0; i < m_uEntityCount; i++)
 	{
 		m_mEntityArray[i]->ClearCollisionList();
 	}
 	
-	//check collisions
+	//forces and gravity first, they do not move anything yet but they give the velocity the fast movers are swept with
+	MySolver* pSolver = MySolver::GetInstance();
+	pSolver->IntegrateForces();
+	markPhase(PHASE_FORCES);
+
+	//only the entities that are awake look for collisions, each one on its own job, against every other entity
+	//except the ones awake before it in the list, so every pair with at least one of them awake is checked once and
+	//the pairs of sleeping bodies are never visited, the pairs with a fast mover are also checked along the motion of the step
+	MyJobSystem* pJobSystem = MyJobSystem::GetInstance();
+	m_ActiveList.clear();
+	m_Active.assign(m_uEntityCount, false);
 	for (uint i = 0; i < m_uEntityCount; i++)
 	{
-		for (uint j = i + 1; j < m_uEntityCount; j++)
+		if (m_mEntityArray[i]->IsSleeping())
+			continue;
+		m_Active[i] = true;
+		m_ActiveList.push_back(i);
+	}
+	uint uActiveCount = static_cast<uint>(m_ActiveList.size());
+	if (m_OverlapList.size() < uActiveCount)
+	{
+		m_OverlapList.resize(uActiveCount);
+		m_SweptOverlapList.resize(uActiveCount);
+	}
+	pJobSystem->ParallelFor(uActiveCount, [this](uint a_uActive)
+	{
+		m_OverlapList[a_uActive].clear();
+		m_SweptOverlapList[a_uActive].clear();
+		uint i = m_ActiveList[a_uActive];
+		bool bContinuous = m_mEntityArray[i]->IsContinuous();
+		for (uint j = 0; j < m_uEntityCount; j++)
 		{
-			//if objects are colliding resolve the collision
-			if (m_mEntityArray[i]->IsColliding(m_mEntityArray[j]))
-			{
-				m_mEntityArray[i]->ResolveCollision(m_mEntityArray[j]);
-			}
+			if (j == i || (j < i && m_Active[j]))
+				continue;
+
+			//pairs are stored with the smaller index first
+			std::pair<uint, uint> pair = j < i ? std::make_pair(j, i) : std::make_pair(i, j);
+			if (m_mEntityArray[pair.first]->IsOverlapping(m_mEntityArray[pair.second]))
+				m_OverlapList[a_uActive].push_back(pair);
+
+			if ((bContinuous || m_mEntityArray[j]->IsContinuous()) && m_mEntityArray[pair.first]->IsOverlappingSwept(m_mEntityArray[pair.second]))
+				m_SweptOverlapList[a_uActive].push_back(pair);
+		}
+	}, "Detection");
+
+	//gather the pairs in the order of the entity list, so the result does not depend on which ones are awake
+	m_OverlapPairList.clear();
+	m_SweptPairList.clear();
+	for (uint i = 0; i < uActiveCount; i++)
+	{
+		m_OverlapPairList.insert(m_OverlapPairList.end(), m_OverlapList[i].begin(), m_OverlapList[i].end());
+		m_SweptPairList.insert(m_SweptPairList.end(), m_SweptOverlapList[i].begin(), m_SweptOverlapList[i].end());
+	}
+	std::sort(m_OverlapPairList.begin(), m_OverlapPairList.end());
+	std::sort(m_SweptPairList.begin(), m_SweptPairList.end());
+
+	//hand each fast mover the entities it could hit
+	if (m_SweptList.size() < m_uEntityCount)
+		m_SweptList.resize(m_uEntityCount);
+	for (uint i = 0; i < m_uEntityCount; i++)
+	{
+		m_SweptList[i].clear();
+	}
+	for (std::pair<uint, uint> pair : m_SweptPairList)
+	{
+		if (m_mEntityArray[pair.first]->IsContinuous())
+			m_SweptList[pair.first].push_back(pair.second);
+		if (m_mEntityArray[pair.second]->IsContinuous())
+			m_SweptList[pair.second].push_back(pair.first);
+	}
+	for (uint i = 0; i < m_uEntityCount; i++)
+	{
+		if (m_SweptList[i].size() > 1)
+			std::sort(m_SweptList[i].begin(), m_SweptList[i].end());
+	}
+
+	//store the collisions in the same order the serial loop found them
+	m_ContactList.clear();
+	for (std::pair<uint, uint> pair : m_OverlapPairList)
+	{
+		//if objects are colliding store the contact to be resolved, unless neither of them can move
+		if (m_mEntityArray[pair.first]->IsColliding(m_mEntityArray[pair.second]) &&
+			(m_mEntityArray[pair.first]->IsUsingPhysicsSolver() || m_mEntityArray[pair.second]->IsUsingPhysicsSolver()))
+		{
+			m_ContactList.push_back(pair);
 		}
-		//Update each entity
+	}
+
+	markPhase(PHASE_DETECTION);
+
+	//resolve the collisions
+	ResolveContacts();
+	markPhase(PHASE_CONTACTS);
+
+	//move all the bodies at once
+	pSolver->IntegrateVelocities();
+	markPhase(PHASE_VELOCITIES);
+
+	//Update each entity, each one only places its own body
+	pJobSystem->ParallelFor(m_uEntityCount, [this](uint i)
+	{
 		m_mEntityArray[i]->Update();
+	}, "Entities");
+	markPhase(PHASE_ENTITIES);
+
+	//fast movers could have tunneled through something during their update
+	ResolveContinuousCollisions();
+	markPhase(PHASE_CONTINUOUS);
+}
+Simplex::uint Simplex::MyEntityManager::FindIsland(uint a_uIndex)
+{
+	//follow the parents up to the root, halving the path on the way
+	while (m_IslandParent[a_uIndex] != a_uIndex)
+	{
+		m_IslandParent[a_uIndex] = m_IslandParent[m_IslandParent[a_uIndex]];
+		a_uIndex = m_IslandParent[a_uIndex];
 	}
+	return a_uIndex;
 }
-void Simplex::MyEntityManager::AddEntity(String a_sFileName, String a_sUniqueID)
+void Simplex::MyEntityManager::ResolveContacts(void)
 {
-	//Create a temporal entity to store the object
-	MyEntity* pTemp = new MyEntity(a_sFileName, a_sUniqueID);
-	//if I was able to generate it add it to the list
-	if (pTemp->IsInitialized())
+	MySolver* pSolver = MySolver::GetInstance();
+	pSolver->ClearContacts();
+
+	m_uIslandCount = 0;
+	uint uContactCount = static_cast<uint>(m_ContactList.size());
+	if (uContactCount == 0)
 	{
-		//create a new temp array with one extra entry
-		PEntity* tempArray = new PEntity[m_uEntityCount + 1];
-		//start from 0 to the current count
-		uint uCount = 0;
-		for (uint i = 0; i < m_uEntityCount; ++i)
+		//nothing is touching, forget the impulses of the last step
+		pSolver->StoreContacts();
+		return;
+	}
+
+	//every entity starts on its own island
+	m_IslandParent.resize(m_uEntityCount);
+	for (uint i = 0; i < m_uEntityCount; i++)
+	{
+		m_IslandParent[i] = i;
+	}
+
+	//join the islands of every pair in contact, the smaller index is the root so the result does not depend on the order,
+	//entities that do not move are only read by the solver so they do not join the islands touching them
+	for (uint i = 0; i < uContactCount; i++)
+	{
+		if (!m_mEntityArray[m_ContactList[i].first]->IsUsingPhysicsSolver() ||
+			!m_mEntityArray[m_ContactList[i].second]->IsUsingPhysicsSolver())
+			continue;
+
+		uint uRootA = FindIsland(m_ContactList[i].first);
+		uint uRootB = FindIsland(m_ContactList[i].second);
+		if (uRootA < uRootB)
+			m_IslandParent[uRootB] = uRootA;
+		else if (uRootB < uRootA)
+			m_IslandParent[uRootA] = uRootB;
+	}
+
+	//number the islands in the order their first contact was found and count their contacts
+	std::vector<uint> islandIndex(m_uEntityCount, static_cast<uint>(-1));
+	std::vector<uint> contactIsland(uContactCount);
+	m_IslandStart.clear();
+	for (uint i = 0; i < uContactCount; i++)
+	{
+		//the contact belongs to the island of the entity that moves
+		uint uEntity = m_ContactList[i].first;
+		if (!m_mEntityArray[uEntity]->IsUsingPhysicsSolver())
+			uEntity = m_ContactList[i].second;
+
+		uint uRoot = FindIsland(uEntity);
+		if (islandIndex[uRoot] == static_cast<uint>(-1))
+		{
+			islandIndex[uRoot] = m_uIslandCount;
+			m_IslandStart.push_back(0);
+			++m_uIslandCount;
+		}
+		contactIsland[i] = islandIndex[uRoot];
+		++m_IslandStart[contactIsland[i]];
+	}
+
+	//turn the counts into starting points
+	uint uOffset = 0;
+	for (uint i = 0; i < m_uIslandCount; i++)
+	{
+		uint uCount = m_IslandStart[i];
+		m_IslandStart[i] = uOffset;
+		uOffset += uCount;
+	}
+	m_IslandStart.push_back(uOffset);
+
+	//place each contact in its island, keeping the order they were found in
+	m_IslandContactList.resize(uContactCount);
+	std::vector<uint> islandCursor(m_IslandStart.begin(), m_IslandStart.end() - 1);
+	for (uint i = 0; i < uContactCount; i++)
+	{
+		m_IslandContactList[islandCursor[contactIsland[i]]++] = m_ContactList[i];
+	}
+
+	//hand the contacts to the solver in island order so each island is a range of them
+	for (uint i = 0; i < uContactCount; i++)
+	{
+		MyEntity* pEntity = m_mEntityArray[m_IslandContactList[i].first];
+		MyEntity* pOther = m_mEntityArray[m_IslandContactList[i].second];
+		vector3 v3Normal;
+		float fPenetration = pEntity->GetRigidBody()->GetPenetration(pOther->GetRigidBody(), v3Normal);
+		pSolver->AddContact(pEntity->GetSolverIndex(), pOther->GetSolverIndex(), v3Normal, fPenetration);
+	}
+
+	//islands do not share moving bodies, so each one can be solved on its own thread
+	MyJobSystem::GetInstance()->ParallelFor(m_uIslandCount, [this, pSolver](uint a_uIsland)
+	{
+		pSolver->SolveContacts(m_IslandStart[a_uIsland], m_IslandStart[a_uIsland + 1]);
+	}, "Islands");
+
+	//keep the impulses to warm start the next step
+	pSolver->StoreContacts();
+}
+void Simplex::MyEntityManager::ResolveContinuousCollisions(void)
+{
+	for (uint i = 0; i < m_uEntityCount; i++)
+	{
+		MyEntity* pEntity = m_mEntityArray[i];
+		if (!pEntity->IsContinuous())
+			continue;
+
+		//look for the earliest contact along the motion, only the ones the detection found in its way can be hit
+		float fFirstImpact = 1.0f;
+		vector3 v3FirstNormal = ZERO_V3;
+		MyEntity* pFirstHit = nullptr;
+		for (uint j : m_SweptList[i])
 		{
-			tempArray[uCount] = m_mEntityArray[i];
-			++uCount;
+			float fTimeOfImpact = 1.0f;
+			vector3 v3Normal;
+			if (pEntity->IsCollidingSwept(m_mEntityArray[j], fTimeOfImpact, v3Normal))
+			{
+				//already touching at the start of the frame, the discrete test takes care of it
+				if (fTimeOfImpact <= 0.0f)
+					continue;
+				if (fTimeOfImpact < fFirstImpact)
+				{
+					fFirstImpact = fTimeOfImpact;
+					v3FirstNormal = v3Normal;
+					pFirstHit = m_mEntityArray[j];
+				}
+			}
 		}
-		tempArray[uCount] = pTemp;
-		//if there was an older array delete
-		if (m_mEntityArray)
+
+		//advance only up to the first contact and let them react to it, pushing along the face the sweep hit
+		if (pFirstHit)
 		{
-			delete[] m_mEntityArray;
+			pEntity->AdvanceTo(fFirstImpact);
+			pEntity->ResolveCollision(pFirstHit, v3FirstNormal);
 		}
-		//make the member pointer the temp pointer
-		m_mEntityArray = tempArray;
-		//add one entity to the count
-		++m_uEntityCount;
 	}
 }
-void Simplex::MyEntityManager::RemoveEntity(uint a_uIndex)
+Simplex::MyEntityHandle Simplex::MyEntityManager::AddEntity(String a_sFileName, String a_sUniqueID)
 {
-	//if the list is empty return
-	if (m_uEntityCount == 0)
-		return;
+	if (m_pRecorder)
+		m_pRecorder->RecordAddEntity(a_sFileName, a_sUniqueID);
 
-	// if out of bounds choose the last one
-	if (a_uIndex >= m_uEntityCount)
-		a_uIndex = m_uEntityCount - 1;
+	//Load the object on an entity of the pool
+	MyEntity* pEntity = TakeEntity();
+	pEntity->Load(a_sFileName, a_sUniqueID);
+	return AddEntity(pEntity);
+}
+Simplex::MyEntityHandle Simplex::MyEntityManager::AddEntity(std::vector<vector3> a_VertexList, String a_sUniqueID)
+{
+	if (m_pRecorder)
+		m_pRecorder->RecordAddEntity(a_VertexList, a_sUniqueID);
 
-	// if the entity is not the very last we swap it for the last one
-	if (a_uIndex != m_uEntityCount - 1)
+	//Generate the shape on an entity of the pool
+	MyEntity* pEntity = TakeEntity();
+	pEntity->Load(a_VertexList, a_sUniqueID);
+	return AddEntity(pEntity);
+}
+Simplex::MyEntityHandle Simplex::MyEntityManager::AddEntity(MyEntity* a_pEntity)
+{
+	//if it could not be generated there is nothing to add, or if there are no handles left for it
+	if (!a_pEntity->IsInitialized() ||
+		(m_FreeSlotList.empty() && m_SlotList.size() > MyEntityHandle::m_uSlotMask))
 	{
-		std::swap(m_mEntityArray[a_uIndex], m_mEntityArray[m_uEntityCount - 1]);
+		RecycleEntity(a_pEntity);
+		return MyEntityHandle();
 	}
-	
-	//and then pop the last one
-	//create a new temp array with one less entry
-	PEntity* tempArray = new PEntity[m_uEntityCount - 1];
+
+	//if the array is full double it, so adding n entities copies the list a logarithmic number of times
+	if (m_uEntityCount == m_uEntityCapacity)
+		Reserve(std::max(m_uEntityCapacity * 2, 16u));
+
+	m_mEntityArray[m_uEntityCount] = a_pEntity;
+	MyEntityHandle hEntity = AllocateSlot();
+	m_IDSlotMap[a_pEntity->GetUniqueID()] = hEntity.GetSlot();
+	//add one entity to the count
+	++m_uEntityCount;
+	return hEntity;
+}
+Simplex::MyEntity* Simplex::MyEntityManager::TakeEntity(void)
+{
+	if (m_EntityPool.empty())
+		return new MyEntity();
+
+	MyEntity* pEntity = m_EntityPool.back();
+	m_EntityPool.pop_back();
+	return pEntity;
+}
+void Simplex::MyEntityManager::RecycleEntity(MyEntity* a_pEntity)
+{
+	a_pEntity->Unload();
+	m_EntityPool.push_back(a_pEntity);
+}
+Simplex::MyEntityHandle Simplex::MyEntityManager::AllocateSlot(void)
+{
+	//reuse a free slot if there is one, its generation was already moved on when it was freed
+	uint uSlot;
+	if (!m_FreeSlotList.empty())
+	{
+		uSlot = m_FreeSlotList.back();
+		m_FreeSlotList.pop_back();
+	}
+	else
+	{
+		uSlot = static_cast<uint>(m_SlotList.size());
+		m_SlotList.push_back(MyEntitySlot());
+		m_TransformList.push_back(MyTransformNode());
+	}
+	m_SlotList[uSlot].uIndex = m_uEntityCount;
+	m_EntitySlotList.push_back(uSlot);
+	return MyEntityHandle(uSlot, m_SlotList[uSlot].uGeneration);
+}
+void Simplex::MyEntityManager::FreeSlot(uint a_uSlot)
+{
+	DetachSlot(a_uSlot);
+	//a new generation makes the handles to the old entity stale, 0 is skipped so no handle is ever null
+	uint uGeneration = (m_SlotList[a_uSlot].uGeneration + 1) & MyEntityHandle::m_uGenerationMask;
+	m_SlotList[a_uSlot].uGeneration = uGeneration == 0 ? 1 : uGeneration;
+	m_FreeSlotList.push_back(a_uSlot);
+}
+void Simplex::MyEntityManager::AddEntities(String a_sFileName, uint a_uCount, std::vector<matrix4> const& a_m4ToWorldList, String a_sUniqueID)
+{
+	//grow once for all of them
+	Reserve(m_uEntityCount + a_uCount);
+	for (uint i = 0; i < a_uCount; ++i)
+	{
+		if (m_pRecorder)
+			m_pRecorder->RecordAddEntity(a_sFileName, a_sUniqueID);
+
+		MyEntity* pEntity = TakeEntity();
+		pEntity->Load(a_sFileName, a_sUniqueID);
+		uint uIndex = m_uEntityCount;
+		if (AddEntity(pEntity).IsNull())
+			continue;
+
+		if (i < a_m4ToWorldList.size())
+		{
+			pEntity->SetModelMatrix(a_m4ToWorldList[i]);
+			if (m_pRecorder)
+				m_pRecorder->RecordModelMatrix(uIndex, a_m4ToWorldList[i]);
+		}
+	}
+}
+void Simplex::MyEntityManager::Reserve(uint a_uCapacity)
+{
+	if (a_uCapacity <= m_uEntityCapacity)
+		return;
+
+	//create a new temp array with the room asked for
+	PEntity* tempArray = new PEntity[a_uCapacity];
 	//start from 0 to the current count
-	for (uint i = 0; i < m_uEntityCount - 1; ++i)
+	for (uint i = 0; i < m_uEntityCount; ++i)
 	{
 		tempArray[i] = m_mEntityArray[i];
 	}
@@ -247,13 +796,83 @@ void Simplex::MyEntityManager::RemoveEntity(uint a_uIndex)
 	}
 	//make the member pointer the temp pointer
 	m_mEntityArray = tempArray;
-	//add one entity to the count
+	m_uEntityCapacity = a_uCapacity;
+}
+void Simplex::MyEntityManager::RemoveEntity(uint a_uIndex)
+{
+	//if the list is empty return
+	if (m_uEntityCount == 0)
+		return;
+
+	// if out of bounds choose the last one
+	if (a_uIndex >= m_uEntityCount)
+		a_uIndex = m_uEntityCount - 1;
+
+	if (m_pRecorder)
+		m_pRecorder->RecordRemoveEntity(a_uIndex);
+
+	// if the entity is not the very last we swap it for the last one
+	if (a_uIndex != m_uEntityCount - 1)
+	{
+		std::swap(m_mEntityArray[a_uIndex], m_mEntityArray[m_uEntityCount - 1]);
+		std::swap(m_EntitySlotList[a_uIndex], m_EntitySlotList[m_uEntityCount - 1]);
+		//the handles of the one that moved follow it
+		m_SlotList[m_EntitySlotList[a_uIndex]].uIndex = a_uIndex;
+	}
+	
+	//and then pop the last one, the array keeps its size for the next ones added
+	m_IDSlotMap.erase(m_mEntityArray[m_uEntityCount - 1]->GetUniqueID());
+	FreeSlot(m_EntitySlotList.back());
+	m_EntitySlotList.pop_back();
+	RecycleEntity(m_mEntityArray[m_uEntityCount - 1]);
+	m_mEntityArray[m_uEntityCount - 1] = nullptr;
 	--m_uEntityCount;
 }
 void Simplex::MyEntityManager::RemoveEntity(String a_sUniqueID)
 {
 	int nIndex = GetEntityIndex(a_sUniqueID);
-	RemoveEntity((uint)nIndex);
+	//an unknown id does not remove anything
+	if (nIndex >= 0)
+		RemoveEntity(static_cast<uint>(nIndex));
+}
+void Simplex::MyEntityManager::RemoveEntity(MyEntityHandle a_hEntity)
+{
+	int nIndex = GetEntityIndex(a_hEntity);
+	if (nIndex >= 0)
+		RemoveEntity(static_cast<uint>(nIndex));
+}
+void Simplex::MyEntityManager::RemoveEntities(std::vector<uint> a_IndexList)
+{
+	if (m_pRecorder)
+		m_pRecorder->RecordRemoveEntities(a_IndexList);
+
+	//mark the ones to remove
+	std::vector<bool> removeList(m_uEntityCount, false);
+	for (uint i = 0; i < a_IndexList.size(); ++i)
+	{
+		if (a_IndexList[i] < m_uEntityCount)
+			removeList[a_IndexList[i]] = true;
+	}
+
+	//delete them and move the ones left down over the gaps
+	uint uCount = 0;
+	for (uint i = 0; i < m_uEntityCount; ++i)
+	{
+		if (removeList[i])
+		{
+			m_IDSlotMap.erase(m_mEntityArray[i]->GetUniqueID());
+			FreeSlot(m_EntitySlotList[i]);
+			RecycleEntity(m_mEntityArray[i]);
+			m_mEntityArray[i] = nullptr;
+			continue;
+		}
+		m_mEntityArray[uCount] = m_mEntityArray[i];
+		m_EntitySlotList[uCount] = m_EntitySlotList[i];
+		m_SlotList[m_EntitySlotList[uCount]].uIndex = uCount;
+		++uCount;
+	}
+	m_uEntityCount = uCount;
+	m_EntitySlotList.resize(uCount);
 }
 Simplex::String Simplex::MyEntityManager::GetUniqueID(uint a_uIndex)
 {
@@ -279,18 +898,58 @@ Simplex::MyEntity* Simplex::MyEntityManager::GetEntity(uint a_uIndex)
 
 	return m_mEntityArray[a_uIndex];
 }
+Simplex::MyEntity* Simplex::MyEntityManager::GetEntity(MyEntityHandle a_hEntity)
+{
+	int nIndex = GetEntityIndex(a_hEntity);
+	if (nIndex < 0)
+		return nullptr;
+	return m_mEntityArray[nIndex];
+}
+Simplex::MyEntity* Simplex::MyEntityManager::GetEntity(String a_sUniqueID)
+{
+	int nIndex = GetEntityIndex(a_sUniqueID);
+	if (nIndex < 0)
+		return nullptr;
+	return m_mEntityArray[nIndex];
+}
+Simplex::MyEntityHandle Simplex::MyEntityManager::GetHandle(uint a_uIndex)
+{
+	if (a_uIndex >= m_uEntityCount)
+		return MyEntityHandle();
+
+	uint uSlot = m_EntitySlotList[a_uIndex];
+	return MyEntityHandle(uSlot, m_SlotList[uSlot].uGeneration);
+}
+Simplex::MyEntityHandle Simplex::MyEntityManager::GetHandle(String a_sUniqueID)
+{
+	int nIndex = GetEntityIndex(a_sUniqueID);
+	if (nIndex < 0)
+		return MyEntityHandle();
+	return GetHandle(static_cast<uint>(nIndex));
+}
+int Simplex::MyEntityManager::GetEntityIndex(MyEntityHandle a_hEntity)
+{
+	//a stale handle has an older generation than its slot
+	uint uSlot = a_hEntity.GetSlot();
+	if (a_hEntity.IsNull() || uSlot >= m_SlotList.size() || m_SlotList[uSlot].uGeneration != a_hEntity.GetGeneration())
+		return -1;
+	return static_cast<int>(m_SlotList[uSlot].uIndex);
+}
+bool Simplex::MyEntityManager::IsValid(MyEntityHandle a_hEntity) { return GetEntityIndex(a_hEntity) >= 0; }
 void Simplex::MyEntityManager::AddEntityToRenderList(uint a_uIndex, bool a_bRigidBody)
 {
 	//if out of bounds will do it for all
 	if (a_uIndex >= m_uEntityCount)
 	{
-		//add for each one in the entity list
+		//add for each one in the entity list that is not hidden
 		for (a_uIndex = 0; a_uIndex < m_uEntityCount; ++a_uIndex)
 		{
+			if (m_bOcclusionCulling && m_mEntityArray[a_uIndex]->IsOccluded())
+				continue;
 			m_mEntityArray[a_uIndex]->AddToRenderList(a_bRigidBody);
 		}
 	}
-	else //do it for the specified one
+	else if (!m_bOcclusionCulling || !m_mEntityArray[a_uIndex]->IsOccluded()) //do it for the specified one
 	{
 		m_mEntityArray[a_uIndex]->AddToRenderList(a_bRigidBody);
 	}
@@ -298,13 +957,90 @@ void Simplex::MyEntityManager::AddEntityToRenderList(uint a_uIndex, bool a_bRigi
 void Simplex::MyEntityManager::AddEntityToRenderList(String a_sUniqueID, bool a_bRigidBody)
 {
 	//Get the entity
-	MyEntity* pTemp = MyEntity::GetEntity(a_sUniqueID);
-	//if the entity exists
-	if (pTemp)
+	MyEntity* pTemp = GetEntity(a_sUniqueID);
+	//if the entity exists and is not hidden
+	if (pTemp && (!m_bOcclusionCulling || !pTemp->IsOccluded()))
 	{
 		pTemp->AddToRenderList(a_bRigidBody);
 	}
 }
+void Simplex::MyEntityManager::UseOcclusionCulling(bool a_bUse) { m_bOcclusionCulling = a_bUse; }
+bool Simplex::MyEntityManager::IsUsingOcclusionCulling(void) { return m_bOcclusionCulling; }
+uint Simplex::MyEntityManager::GetOccludedCount(void) { return m_OcclusionCuller.GetOccludedCount(); }
+float Simplex::MyEntityManager::GetOcclusionTime(void) { return m_fOcclusionTime; }
+MyOcclusionCuller* Simplex::MyEntityManager::GetOcclusionCuller(void) { return &m_OcclusionCuller; }
+void Simplex::MyEntityManager::CullOccludedEntities(matrix4 a_m4ViewProjection)
+{
+	if (!m_bOcclusionCulling)
+		return;
+
+	typedef std::chrono::high_resolution_clock Clock;
+	Clock::time_point start = Clock::now();
+	MySolver* pSolver = MySolver::GetInstance();
+
+	//the occluders that are not moving are drawn where their rigid body is, the ones that are
+	//moving are drawn somewhere between their last two states so they are left out
+	m_OcclusionCuller.BeginFrame(a_m4ViewProjection);
+	for (uint i = 0; i < m_uEntityCount; ++i)
+	{
+		MyEntity* pEntity = m_mEntityArray[i];
+		if (!pEntity->IsInitialized() || !pEntity->IsOccluder())
+			continue;
+		if (pEntity->IsUsingPhysicsSolver() && !pEntity->IsSleeping())
+			continue;
+		MyRigidBody* pRigidBody = pEntity->GetRigidBody();
+		m_OcclusionCuller.AddOccluder(pRigidBody->GetModelMatrix(), pRigidBody->GetMinLocal(), pRigidBody->GetMaxLocal());
+	}
+	m_OcclusionCuller.BuildPyramid();
+
+	//the ARBB is on the last physics state, it is stretched back to the previous one to cover the interpolated model
+	for (uint i = 0; i < m_uEntityCount; ++i)
+	{
+		MyEntity* pEntity = m_mEntityArray[i];
+		if (!pEntity->IsInitialized())
+		{
+			pEntity->SetOccluded(false);
+			continue;
+		}
+		MyRigidBody* pRigidBody = pEntity->GetRigidBody();
+		vector3 v3Min = pRigidBody->GetMinGlobal();
+		vector3 v3Max = pRigidBody->GetMaxGlobal();
+		if (pEntity->IsUsingPhysicsSolver() && !pEntity->IsSleeping())
+		{
+			uint uBody = pEntity->GetSolverIndex();
+			vector3 v3Motion = pSolver->GetPreviousPosition(uBody) - pSolver->GetPosition(uBody);
+			v3Min = glm::min(v3Min, v3Min + v3Motion);
+			v3Max = glm::max(v3Max, v3Max + v3Motion);
+		}
+		pEntity->SetOccluded(!m_OcclusionCuller.IsVisible(v3Min, v3Max));
+	}
+
+	m_fOcclusionTime = std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+}
+void Simplex::MyEntityManager::SetOccluder(bool a_bOccluder, String a_sUniqueID)
+{
+	int nIndex = GetEntityIndex(a_sUniqueID);
+	if (nIndex >= 0)
+		SetOccluder(a_bOccluder, static_cast<uint>(nIndex));
+}
+void Simplex::MyEntityManager::SetOccluder(bool a_bOccluder, uint a_uIndex)
+{
+	//if the list is empty return
+	if (m_uEntityCount == 0)
+		return;
+
+	//if the index is larger than the number of entries we are asking for the last one
+	if (a_uIndex >= m_uEntityCount)
+		a_uIndex = m_uEntityCount - 1;
+
+	m_mEntityArray[a_uIndex]->SetOccluder(a_bOccluder);
+}
+void Simplex::MyEntityManager::SetOccluder(bool a_bOccluder, MyEntityHandle a_hEntity)
+{
+	int nIndex = GetEntityIndex(a_hEntity);
+	if (nIndex >= 0)
+		SetOccluder(a_bOccluder, static_cast<uint>(nIndex));
+}
 void Simplex::MyEntityManager::AddDimension(uint a_uIndex, uint a_uDimension)
 {
 	//if the list is empty return
@@ -320,7 +1056,7 @@ void Simplex::MyEntityManager::AddDimension(uint a_uIndex, uint a_uDimension)
 void Simplex::MyEntityManager::AddDimension(String a_sUniqueID, uint a_uDimension)
 {
 	//Get the entity
-	MyEntity* pTemp = MyEntity::GetEntity(a_sUniqueID);
+	MyEntity* pTemp = GetEntity(a_sUniqueID);
 	//if the entity exists
 	if (pTemp)
 	{
@@ -342,7 +1078,7 @@ void Simplex::MyEntityManager::RemoveDimension(uint a_uIndex, uint a_uDimension)
 void Simplex::MyEntityManager::RemoveDimension(String a_sUniqueID, uint a_uDimension)
 {
 	//Get the entity
-	MyEntity* pTemp = MyEntity::GetEntity(a_sUniqueID);
+	MyEntity* pTemp = GetEntity(a_sUniqueID);
 	//if the entity exists
 	if (pTemp)
 	{
@@ -371,7 +1107,7 @@ void Simplex::MyEntityManager::ClearDimensionSet(uint a_uIndex)
 void Simplex::MyEntityManager::ClearDimensionSet(String a_sUniqueID)
 {
 	//Get the entity
-	MyEntity* pTemp = MyEntity::GetEntity(a_sUniqueID);
+	MyEntity* pTemp = GetEntity(a_sUniqueID);
 	//if the entity exists
 	if (pTemp)
 	{
@@ -393,7 +1129,7 @@ bool Simplex::MyEntityManager::IsInDimension(uint a_uIndex, uint a_uDimension)
 bool Simplex::MyEntityManager::IsInDimension(String a_sUniqueID, uint a_uDimension)
 {
 	//Get the entity
-	MyEntity* pTemp = MyEntity::GetEntity(a_sUniqueID);
+	MyEntity* pTemp = GetEntity(a_sUniqueID);
 	//if the entity exists
 	if (pTemp)
 	{
@@ -416,7 +1152,7 @@ bool Simplex::MyEntityManager::SharesDimension(uint a_uIndex, MyEntity* const a_
 bool Simplex::MyEntityManager::SharesDimension(String a_sUniqueID, MyEntity* const a_pOther)
 {
 	//Get the entity
-	MyEntity* pTemp = MyEntity::GetEntity(a_sUniqueID);
+	MyEntity* pTemp = GetEntity(a_sUniqueID);
 	//if the entity exists
 	if (pTemp)
 	{
@@ -426,12 +1162,11 @@ bool Simplex::MyEntityManager::SharesDimension(String a_sUniqueID, MyEntity* con
 }
 void Simplex::MyEntityManager::ApplyForce(vector3 a_v3Force, String a_sUniqueID)
 {
-	//Get the entity
-	MyEntity* pTemp = MyEntity::GetEntity(a_sUniqueID);
-	//if the entity does not exists return
-	if(pTemp)
-		pTemp->ApplyForce(a_v3Force);
-	return;
+	//Get the entity through the hashed id, the index overload records the call
+	int nIndex = GetEntityIndex(a_sUniqueID);
+	//if the entity exists
+	if (nIndex >= 0)
+		ApplyForce(a_v3Force, static_cast<uint>(nIndex));
 }
 void Simplex::MyEntityManager::ApplyForce(vector3 a_v3Force, uint a_uIndex)
 {
@@ -443,18 +1178,18 @@ void Simplex::MyEntityManager::ApplyForce(vector3 a_v3Force, uint a_uIndex)
 	if (a_uIndex >= m_uEntityCount)
 		a_uIndex = m_uEntityCount - 1;
 
+	if (m_pRecorder)
+		m_pRecorder->RecordForce(a_uIndex, a_v3Force);
+
 	return m_mEntityArray[a_uIndex]->ApplyForce(a_v3Force);
 }
 void Simplex::MyEntityManager::SetPosition(vector3 a_v3Position, String a_sUniqueID)
 {
-	//Get the entity
-	MyEntity* pTemp = MyEntity::GetEntity(a_sUniqueID);
-	//if the entity does not exists return
-	if (pTemp)
-	{
-		pTemp->SetPosition(a_v3Position);
-	}
-	return;
+	//Get the entity through the hashed id, the index overload records the call
+	int nIndex = GetEntityIndex(a_sUniqueID);
+	//if the entity exists
+	if (nIndex >= 0)
+		SetPosition(a_v3Position, static_cast<uint>(nIndex));
 }
 void Simplex::MyEntityManager::SetPosition(vector3 a_v3Position, uint a_uIndex)
 {
@@ -466,20 +1201,20 @@ void Simplex::MyEntityManager::SetPosition(vector3 a_v3Position, uint a_uIndex)
 	if (a_uIndex >= m_uEntityCount)
 		a_uIndex = m_uEntityCount - 1;
 
+	if (m_pRecorder)
+		m_pRecorder->RecordPosition(a_uIndex, a_v3Position);
+
 	m_mEntityArray[a_uIndex]->SetPosition(a_v3Position);
 
 	return;
 }
 void Simplex::MyEntityManager::SetMass(float a_fMass, String a_sUniqueID)
 {
-	//Get the entity
-	MyEntity* pTemp = MyEntity::GetEntity(a_sUniqueID);
-	//if the entity does not exists return
-	if (pTemp)
-	{
-		pTemp->SetMass(a_fMass);
-	}
-	return;
+	//Get the entity through the hashed id, the index overload records the call
+	int nIndex = GetEntityIndex(a_sUniqueID);
+	//if the entity exists
+	if (nIndex >= 0)
+		SetMass(a_fMass, static_cast<uint>(nIndex));
 }
 void Simplex::MyEntityManager::SetMass(float a_fMass, uint a_uIndex)
 {
@@ -491,19 +1226,20 @@ void Simplex::MyEntityManager::SetMass(float a_fMass, uint a_uIndex)
 	if (a_uIndex >= m_uEntityCount)
 		a_uIndex = m_uEntityCount - 1;
 
+	if (m_pRecorder)
+		m_pRecorder->RecordMass(a_uIndex, a_fMass);
+
 	m_mEntityArray[a_uIndex]->SetMass(a_fMass);
 
 	return;
 }
 void Simplex::MyEntityManager::UsePhysicsSolver(bool a_bUse, String a_sUniqueID)
 {
-	//Get the entity
-	MyEntity* pTemp = MyEntity::GetEntity(a_sUniqueID);
-
-	//if the entity does not exists return
-	if (pTemp)
-		pTemp->UsePhysicsSolver(a_bUse);
-	return;
+	//Get the entity through the hashed id, the index overload records the call
+	int nIndex = GetEntityIndex(a_sUniqueID);
+	//if the entity exists
+	if (nIndex >= 0)
+		UsePhysicsSolver(a_bUse, static_cast<uint>(nIndex));
 }
 void Simplex::MyEntityManager::UsePhysicsSolver(bool a_bUse, uint a_uIndex)
 {
@@ -515,5 +1251,330 @@ void Simplex::MyEntityManager::UsePhysicsSolver(bool a_bUse, uint a_uIndex)
 	if (a_uIndex >= m_uEntityCount)
 		a_uIndex = m_uEntityCount - 1;
 
+	if (m_pRecorder)
+		m_pRecorder->RecordPhysicsSolver(a_uIndex, a_bUse);
+
 	return m_mEntityArray[a_uIndex]->UsePhysicsSolver(a_bUse);
-}
\ No newline at end of file
+}
+void Simplex::MyEntityManager::UseContinuousCollision(bool a_bUse, String a_sUniqueID)
+{
+	//Get the entity through the hashed id, the index overload records the call
+	int nIndex = GetEntityIndex(a_sUniqueID);
+	//if the entity exists
+	if (nIndex >= 0)
+		UseContinuousCollision(a_bUse, static_cast<uint>(nIndex));
+}
+void Simplex::MyEntityManager::UseContinuousCollision(bool a_bUse, uint a_uIndex)
+{
+	//if the list is empty return
+	if (m_uEntityCount == 0)
+		return;
+
+	//if the index is larger than the number of entries we are asking for the last one
+	if (a_uIndex >= m_uEntityCount)
+		a_uIndex = m_uEntityCount - 1;
+
+	if (m_pRecorder)
+		m_pRecorder->RecordContinuous(a_uIndex, a_bUse);
+
+	return m_mEntityArray[a_uIndex]->UseContinuousCollision(a_bUse);
+}
+void Simplex::MyEntityManager::ApplyForce(vector3 a_v3Force, MyEntityHandle a_hEntity)
+{
+	int nIndex = GetEntityIndex(a_hEntity);
+	if (nIndex >= 0)
+		ApplyForce(a_v3Force, static_cast<uint>(nIndex));
+}
+void Simplex::MyEntityManager::SetPosition(vector3 a_v3Position, MyEntityHandle a_hEntity)
+{
+	int nIndex = GetEntityIndex(a_hEntity);
+	if (nIndex >= 0)
+		SetPosition(a_v3Position, static_cast<uint>(nIndex));
+}
+void Simplex::MyEntityManager::SetMass(float a_fMass, MyEntityHandle a_hEntity)
+{
+	int nIndex = GetEntityIndex(a_hEntity);
+	if (nIndex >= 0)
+		SetMass(a_fMass, static_cast<uint>(nIndex));
+}
+void Simplex::MyEntityManager::UsePhysicsSolver(bool a_bUse, MyEntityHandle a_hEntity)
+{
+	int nIndex = GetEntityIndex(a_hEntity);
+	if (nIndex >= 0)
+		UsePhysicsSolver(a_bUse, static_cast<uint>(nIndex));
+}
+void Simplex::MyEntityManager::UseContinuousCollision(bool a_bUse, MyEntityHandle a_hEntity)
+{
+	int nIndex = GetEntityIndex(a_hEntity);
+	if (nIndex >= 0)
+		UseContinuousCollision(a_bUse, static_cast<uint>(nIndex));
+}
+bool Simplex::MyEntityManager::SetParent(MyEntityHandle a_hChild, MyEntityHandle a_hParent)
+{
+	int nChild = GetEntityIndex(a_hChild);
+	if (nChild < 0)
+		return false;
+	uint uChild = a_hChild.GetSlot();
+
+	//a null parent detaches the child
+	int nParent = -1;
+	uint uParent = NO_SLOT;
+	if (!a_hParent.IsNull())
+	{
+		nParent = GetEntityIndex(a_hParent);
+		if (nParent < 0)
+			return false;
+		uParent = a_hParent.GetSlot();
+		//the parent cannot be the child or hang from it
+		for (uint uSlot = uParent; uSlot != NO_SLOT; uSlot = m_TransformList[uSlot].uParent)
+		{
+			if (uSlot == uChild)
+				return false;
+		}
+	}
+
+	MyTransformNode& child = m_TransformList[uChild];
+	if (child.uParent == uParent)
+		return true;
+
+	if (m_pRecorder)
+		m_pRecorder->RecordParent(nChild, nParent);
+
+	UnlinkChild(uChild);
+
+	//the child stays where it is, its local transform is its world matrix seen from the parent
+	matrix4 m4World = m_mEntityArray[nChild]->GetModelMatrix();
+	matrix4 m4Local = m4World;
+	if (uParent != NO_SLOT)
+	{
+		LinkChild(uParent, uChild);
+		m4Local = glm::inverse(m_mEntityArray[nParent]->GetModelMatrix()) * m4World;
+	}
+	Decompose(m4Local, child.v3Position, child.qOrientation, child.v3Scale);
+
+	child.bLocal = true;
+	child.bDirty = true;
+	child.m4World = m4World;
+	m_bHierarchyChanged = true;
+	return true;
+}
+Simplex::MyEntityHandle Simplex::MyEntityManager::GetParent(MyEntityHandle a_hEntity)
+{
+	if (GetEntityIndex(a_hEntity) < 0)
+		return MyEntityHandle();
+
+	uint uParent = m_TransformList[a_hEntity.GetSlot()].uParent;
+	if (uParent == NO_SLOT)
+		return MyEntityHandle();
+	return MyEntityHandle(uParent, m_SlotList[uParent].uGeneration);
+}
+void Simplex::MyEntityManager::SetLocalTransform(vector3 a_v3Position, quaternion a_qOrientation, vector3 a_v3Scale, MyEntityHandle a_hEntity)
+{
+	int nIndex = GetEntityIndex(a_hEntity);
+	if (nIndex < 0)
+		return;
+
+	if (m_pRecorder)
+		m_pRecorder->RecordLocalTransform(nIndex, a_v3Position, a_qOrientation, a_v3Scale);
+
+	MyTransformNode& node = m_TransformList[a_hEntity.GetSlot()];
+	//an entity placed by its local transform for the first time joins the hierarchy
+	if (!node.bLocal)
+		m_bHierarchyChanged = true;
+	node.bLocal = true;
+	node.bDirty = true;
+	node.v3Position = a_v3Position;
+	node.qOrientation = a_qOrientation;
+	node.v3Scale = a_v3Scale;
+}
+void Simplex::MyEntityManager::SetLocalPosition(vector3 a_v3Position, MyEntityHandle a_hEntity)
+{
+	int nIndex = GetEntityIndex(a_hEntity);
+	if (nIndex < 0)
+		return;
+
+	vector3 v3Position, v3Scale;
+	quaternion qOrientation;
+	GetLocalTransform(nIndex, v3Position, qOrientation, v3Scale);
+	SetLocalTransform(a_v3Position, qOrientation, v3Scale, a_hEntity);
+}
+void Simplex::MyEntityManager::SetLocalOrientation(quaternion a_qOrientation, MyEntityHandle a_hEntity)
+{
+	int nIndex = GetEntityIndex(a_hEntity);
+	if (nIndex < 0)
+		return;
+
+	vector3 v3Position, v3Scale;
+	quaternion qOrientation;
+	GetLocalTransform(nIndex, v3Position, qOrientation, v3Scale);
+	SetLocalTransform(v3Position, a_qOrientation, v3Scale, a_hEntity);
+}
+void Simplex::MyEntityManager::SetLocalScale(vector3 a_v3Scale, MyEntityHandle a_hEntity)
+{
+	int nIndex = GetEntityIndex(a_hEntity);
+	if (nIndex < 0)
+		return;
+
+	vector3 v3Position, v3Scale;
+	quaternion qOrientation;
+	GetLocalTransform(nIndex, v3Position, qOrientation, v3Scale);
+	SetLocalTransform(v3Position, qOrientation, a_v3Scale, a_hEntity);
+}
+Simplex::matrix4 Simplex::MyEntityManager::GetLocalMatrix(MyEntityHandle a_hEntity)
+{
+	int nIndex = GetEntityIndex(a_hEntity);
+	if (nIndex < 0)
+		return IDENTITY_M4;
+
+	MyTransformNode& node = m_TransformList[a_hEntity.GetSlot()];
+	//without a local transform it is a root placed straight in the world
+	if (!node.bLocal)
+		return m_mEntityArray[nIndex]->GetModelMatrix();
+	return glm::translate(node.v3Position) * glm::mat4_cast(node.qOrientation) * glm::scale(node.v3Scale);
+}
+Simplex::uint Simplex::MyEntityManager::GetHierarchyUpdateCount(void) { return m_uHierarchyUpdateCount; }
+void Simplex::MyEntityManager::GetLocalTransform(uint a_uIndex, vector3& a_v3Position, quaternion& a_qOrientation, vector3& a_v3Scale)
+{
+	MyTransformNode& node = m_TransformList[m_EntitySlotList[a_uIndex]];
+	if (node.bLocal)
+	{
+		a_v3Position = node.v3Position;
+		a_qOrientation = node.qOrientation;
+		a_v3Scale = node.v3Scale;
+		return;
+	}
+	//only roots are placed without one, so their world matrix is their local one
+	Decompose(m_mEntityArray[a_uIndex]->GetModelMatrix(), a_v3Position, a_qOrientation, a_v3Scale);
+}
+void Simplex::MyEntityManager::UpdateHierarchy(void)
+{
+	if (m_bHierarchyChanged)
+		BuildHierarchy();
+
+	for (uint i = 0; i < m_HierarchyList.size(); ++i)
+	{
+		uint uSlot = m_HierarchyList[i];
+		MyTransformNode& node = m_TransformList[uSlot];
+		MyEntity* pEntity = m_mEntityArray[m_SlotList[uSlot].uIndex];
+
+		//placed from outside, its children only need to know if it moved
+		if (!node.bLocal)
+		{
+			matrix4 m4World = pEntity->GetModelMatrix();
+			node.bChanged = m4World != node.m4World;
+			node.m4World = m4World;
+			continue;
+		}
+
+		//nothing to do for a clean subtree, its parent was already visited
+		node.bChanged = node.bDirty || (node.uParent != NO_SLOT && m_TransformList[node.uParent].bChanged);
+		if (!node.bChanged)
+			continue;
+
+		matrix4 m4World = glm::translate(node.v3Position) * glm::mat4_cast(node.qOrientation) * glm::scale(node.v3Scale);
+		if (node.uParent != NO_SLOT)
+			m4World = m_TransformList[node.uParent].m4World * m4World;
+		++m_uHierarchyUpdateCount;
+		node.bDirty = false;
+
+		//the rigid body only refreshes its box if the matrix really moved
+		node.bChanged = m4World != node.m4World;
+		node.m4World = m4World;
+		if (node.bChanged)
+		{
+			pEntity->SetModelMatrix(m4World);
+			node.m4Render = m4World;
+		}
+	}
+}
+void Simplex::MyEntityManager::BuildHierarchy(void)
+{
+	m_HierarchyList.clear();
+	for (uint i = 0; i < m_uEntityCount; ++i)
+	{
+		uint uSlot = m_EntitySlotList[i];
+		MyTransformNode& node = m_TransformList[uSlot];
+		//entities that are placed only through their model matrix and have no children stay out
+		if (!node.bLocal && node.uParent == NO_SLOT && node.uFirstChild == NO_SLOT)
+			continue;
+
+		node.uDepth = 0;
+		for (uint uParent = node.uParent; uParent != NO_SLOT; uParent = m_TransformList[uParent].uParent)
+		{
+			++node.uDepth;
+		}
+		m_HierarchyList.push_back(uSlot);
+	}
+
+	//parents before children, the ones at the same depth keep the order of the list
+	std::stable_sort(m_HierarchyList.begin(), m_HierarchyList.end(), [this](uint a_uA, uint a_uB)
+	{
+		return m_TransformList[a_uA].uDepth < m_TransformList[a_uB].uDepth;
+	});
+	m_bHierarchyChanged = false;
+}
+void Simplex::MyEntityManager::DetachSlot(uint a_uSlot)
+{
+	MyTransformNode& node = m_TransformList[a_uSlot];
+	if (!node.bLocal && node.uParent == NO_SLOT && node.uFirstChild == NO_SLOT)
+		return;
+
+	UnlinkChild(a_uSlot);
+
+	//the children stay where they were on the last update, now as roots
+	uint uChild = node.uFirstChild;
+	while (uChild != NO_SLOT)
+	{
+		MyTransformNode& child = m_TransformList[uChild];
+		uChild = child.uNextSibling;
+		Decompose(child.m4World, child.v3Position, child.qOrientation, child.v3Scale);
+		child.uParent = NO_SLOT;
+		child.uPrevSibling = NO_SLOT;
+		child.uNextSibling = NO_SLOT;
+		child.bDirty = true;
+	}
+
+	node = MyTransformNode();
+	m_bHierarchyChanged = true;
+}
+void Simplex::MyEntityManager::LinkChild(uint a_uParent, uint a_uChild)
+{
+	MyTransformNode& parent = m_TransformList[a_uParent];
+	MyTransformNode& child = m_TransformList[a_uChild];
+	//the new child goes first, there is no order among siblings
+	child.uParent = a_uParent;
+	child.uPrevSibling = NO_SLOT;
+	child.uNextSibling = parent.uFirstChild;
+	if (parent.uFirstChild != NO_SLOT)
+		m_TransformList[parent.uFirstChild].uPrevSibling = a_uChild;
+	parent.uFirstChild = a_uChild;
+}
+void Simplex::MyEntityManager::UnlinkChild(uint a_uChild)
+{
+	MyTransformNode& child = m_TransformList[a_uChild];
+	if (child.uParent == NO_SLOT)
+		return;
+
+	if (child.uPrevSibling != NO_SLOT)
+		m_TransformList[child.uPrevSibling].uNextSibling = child.uNextSibling;
+	else
+		m_TransformList[child.uParent].uFirstChild = child.uNextSibling;
+	if (child.uNextSibling != NO_SLOT)
+		m_TransformList[child.uNextSibling].uPrevSibling = child.uPrevSibling;
+	child.uParent = NO_SLOT;
+	child.uPrevSibling = NO_SLOT;
+	child.uNextSibling = NO_SLOT;
+}
+void Simplex::MyEntityManager::Decompose(matrix4 a_m4Matrix, vector3& a_v3Position, quaternion& a_qOrientation, vector3& a_v3Scale)
+{
+	a_v3Position = vector3(a_m4Matrix[3]);
+	//the scale is the length of each axis, without it what is left of the axes is the rotation
+	matrix3 m3Rotation = matrix3(a_m4Matrix);
+	for (uint i = 0; i < 3; ++i)
+	{
+		a_v3Scale[i] = glm::length(m3Rotation[i]);
+		if (a_v3Scale[i] > 0.0f)
+			m3Rotation[i] /= a_v3Scale[i];
+	}
+	a_qOrientation = glm::quat_cast(m3Rotation);
+}
@@ -6,17 +6,120 @@ Date: 2017/07
 #define __MYENTITYMANAGER_H_
 
 #include "MyEntity.h"
+#include "MyJobSystem.h"
+#include "MyOcclusionCuller.h"
+#include "MyRecorder.h"
+#include <chrono>
+#include <unordered_map>
 
 namespace Simplex
 {
 
+//Parts of a physics step that are timed
+enum eStepPhase
+{
+	PHASE_DETECTION = 0, //broad and narrow phase
+	PHASE_FORCES, //forces and gravity into velocities
+	PHASE_CONTACTS, //islands and contact solver
+	PHASE_VELOCITIES, //velocities into positions
+	PHASE_ENTITIES, //entity update
+	PHASE_CONTINUOUS, //continuous collision detection
+
+	PHASE_COUNT
+};
+
+//32 bit reference to an entity that stays valid while the entity lives, whatever its index in the list,
+//and that can tell when the entity it referred to is gone
+struct MyEntityHandle
+{
+	static const uint m_uSlotBits = 20; //bits of the slot, the rest are the generation
+	static const uint m_uSlotMask = (1u << m_uSlotBits) - 1; //mask of the slot bits
+	static const uint m_uGenerationMask = (1u << (32 - m_uSlotBits)) - 1; //mask of the generation once shifted down
+
+	uint m_uValue = 0; //generation on the high bits and slot on the low ones, 0 is never a valid handle
+
+	MyEntityHandle(void) { }
+	MyEntityHandle(uint a_uSlot, uint a_uGeneration) : m_uValue((a_uGeneration << m_uSlotBits) | a_uSlot) { }
+	uint GetSlot(void) const { return m_uValue & m_uSlotMask; }
+	uint GetGeneration(void) const { return m_uValue >> m_uSlotBits; }
+	bool IsNull(void) const { return m_uValue == 0; }
+	bool operator==(MyEntityHandle const& other) const { return m_uValue == other.m_uValue; }
+	bool operator!=(MyEntityHandle const& other) const { return m_uValue != other.m_uValue; }
+};
+
 //System Class
 class MyEntityManager
 {
 	typedef MyEntity* PEntity; //MyEntity Pointer
 	uint m_uEntityCount = 0; //number of elements in the list
+	uint m_uEntityCapacity = 0; //number of elements the array can hold before it has to grow
 	PEntity* m_mEntityArray = nullptr; //array of MyEntity pointers
+
+	//Where a handle points to, the slot lives as long as the manager and only its generation changes
+	struct MyEntitySlot
+	{
+		uint uIndex = 0; //index of the entity in the list
+		uint uGeneration = 1; //generation of the handles that are valid for this slot
+	};
+	std::vector<MyEntitySlot> m_SlotList; //slots handles point to
+	std::vector<uint> m_FreeSlotList; //slots without an entity
+	std::vector<uint> m_EntitySlotList; //slot of each entity of the list
+	std::vector<MyEntity*> m_EntityPool; //entities removed from the list, kept to be loaded again
+	std::unordered_map<String, uint> m_IDSlotMap; //slot of each unique ID, the only table of the names in use, hashed so names resolve in constant time
+
+	static const uint NO_SLOT = ~0u; //marks a missing parent, child or sibling in the hierarchy
+
+	//Place of an entity in the transform hierarchy, kept by slot so it follows the entity around the list
+	struct MyTransformNode
+	{
+		uint uParent = NO_SLOT; //slot of the parent, NO_SLOT for none
+		uint uFirstChild = NO_SLOT; //slot of the first entity attached to this one, the rest follow as its siblings
+		uint uPrevSibling = NO_SLOT; //slot of the previous child of the same parent
+		uint uNextSibling = NO_SLOT; //slot of the next child of the same parent
+		uint uDepth = 0; //number of ancestors
+		bool bLocal = false; //placed by its local transform, otherwise by SetModelMatrix or the solver
+		bool bDirty = false; //local transform changed since the last update
+		bool bChanged = false; //world matrix changed on the current update, tells the children to follow
+		vector3 v3Position = ZERO_V3; //position relative to the parent
+		quaternion qOrientation = quaternion(); //orientation relative to the parent
+		vector3 v3Scale = vector3(1.0f); //scale relative to the parent
+		matrix4 m4World = IDENTITY_M4; //world matrix on the last update
+		matrix4 m4Render = IDENTITY_M4; //world matrix the model is drawn with, in between physics states
+	};
+	std::vector<MyTransformNode> m_TransformList; //hierarchy node of each slot
+	std::vector<uint> m_HierarchyList; //slots in the hierarchy sorted by depth, parents always before their children
+	bool m_bHierarchyChanged = false; //the hierarchy list needs to be built again
+	uint m_uHierarchyUpdateCount = 0; //world matrices the hierarchy computed on the last update or step
 	static MyEntityManager* m_pInstance; // Singleton pointer
+
+	uint m_uClock = 0; //clock used to know how much time passed between updates
+	float m_fFixedTimeStep = 1.0f / 60.0f; //time simulated on each physics step
+	uint m_uMaxSubsteps = 5; //maximum number of physics steps run on a single update
+	float m_fAccumulator = 0.0f; //time that has passed and has not been simulated yet
+	float m_fInterpolation = 0.0f; //fraction of a step between the last two physics states
+	uint m_uSubstepCount = 0; //physics steps run on the last update
+
+	std::vector<uint> m_ActiveList; //entities that are awake on this step, the only ones that look for collisions
+	std::vector<bool> m_Active; //is each entity in the active list?
+	std::vector<std::vector<std::pair<uint, uint>>> m_OverlapList; //overlapping pairs found by each active entity, filled in parallel
+	std::vector<std::vector<std::pair<uint, uint>>> m_SweptOverlapList; //pairs with a fast mover found by each active entity that could hit along the motion of the step, filled in parallel
+	std::vector<std::pair<uint, uint>> m_OverlapPairList; //overlapping pairs of this step sorted by entity index
+	std::vector<std::pair<uint, uint>> m_SweptPairList; //pairs with a fast mover that could hit on this step sorted by entity index
+	std::vector<std::vector<uint>> m_SweptList; //entities each fast mover could hit on this step, the candidates of the continuous collision detection
+	std::vector<std::pair<uint, uint>> m_ContactList; //pairs of entity indices colliding on this step
+	std::vector<uint> m_IslandParent; //union-find parent of each entity, entities in contact share an island
+	std::vector<uint> m_IslandStart; //first contact of each island in the sorted contact list
+	std::vector<std::pair<uint, uint>> m_IslandContactList; //contact list sorted by island
+	uint m_uIslandCount = 0; //number of contact islands on the last step
+
+	float m_fPhaseTime[PHASE_COUNT]; //milliseconds each phase took on the last step
+	float m_fFramePhaseTime[PHASE_COUNT]; //milliseconds each phase took over all the steps of the last update
+
+	MyRecorder* m_pRecorder = nullptr; //log of the calls that change the simulation, null when not recording
+
+	MyOcclusionCuller m_OcclusionCuller; //depth buffer the occluders are drawn into
+	bool m_bOcclusionCulling = false; //skip the occluded entities when adding them to the render list?
+	float m_fOcclusionTime = 0.0f; //milliseconds the last culling took
 public:
 	/*
 	Usage: Gets the singleton pointer
@@ -41,9 +144,34 @@ public:
 	ARGUMENTS:
 	-	String a_sFileName -> Name of the model to load
 	-	String a_sUniqueID -> Name wanted as identifier, if not available will generate one
+	OUTPUT: handle of the entity, null if it could not be generated
+	*/
+	MyEntityHandle AddEntity(String a_sFileName, String a_sUniqueID = "NA");
+	/*
+	USAGE: Will add an entity without a model to the list, only its rigid body is generated
+	ARGUMENTS:
+	-	std::vector<vector3> a_VertexList -> vertices of the collision shape
+	-	String a_sUniqueID -> Name wanted as identifier, if not available will generate one
+	OUTPUT: handle of the entity, null if it could not be generated
+	*/
+	MyEntityHandle AddEntity(std::vector<vector3> a_VertexList, String a_sUniqueID = "NA");
+	/*
+	USAGE: Will add several entities of the same model to the list, growing it only once
+	ARGUMENTS:
+	-	String a_sFileName -> Name of the model to load
+	-	uint a_uCount -> number of entities to add
+	-	std::vector<matrix4> const& a_m4ToWorldList -> model matrix of each entity, the ones
+		without a matrix are left at the origin
+	-	String a_sUniqueID -> Name wanted as identifier, a unique one is generated for each entity
 	OUTPUT: ---
 	*/
-	void AddEntity(String a_sFileName, String a_sUniqueID = "NA");
+	void AddEntities(String a_sFileName, uint a_uCount, std::vector<matrix4> const& a_m4ToWorldList, String a_sUniqueID = "NA");
+	/*
+	USAGE: Makes room in the list for a number of entities so adding up to that many does not grow it again
+	ARGUMENTS: uint a_uCapacity -> number of entities
+	OUTPUT: ---
+	*/
+	void Reserve(uint a_uCapacity);
 	/*
 	USAGE: Deletes the MyEntity Specified by unique ID and removes it from the list
 	ARGUMENTS: uint a_uIndex -> index of the queried entry, if < 0 asks for the last one added
@@ -57,6 +185,19 @@ public:
 	*/
 	void RemoveEntity(String a_sUniqueID);
 	/*
+	USAGE: Deletes the MyEntity specified by handle and removes it from the list, the handle becomes stale
+	ARGUMENTS: MyEntityHandle a_hEntity -> handle of the entity, nothing happens if it is stale
+	OUTPUT: ---
+	*/
+	void RemoveEntity(MyEntityHandle a_hEntity);
+	/*
+	USAGE: Deletes several entities and removes them from the list in a single pass, unlike RemoveEntity
+	the entities left keep their order
+	ARGUMENTS: std::vector<uint> a_IndexList -> indices of the entities, the ones out of range are ignored
+	OUTPUT: ---
+	*/
+	void RemoveEntities(std::vector<uint> a_IndexList);
+	/*
 	USAGE: Gets the uniqueID name of the entity indexed
 	ARGUMENTS: uint a_uIndex = -1 -> index of the queried entry, if < 0 asks for the last one added
 	OUTPUT: UniqueID of the entity, if the list is empty will return blank
@@ -69,11 +210,153 @@ public:
 	*/
 	MyEntity* GetEntity(uint a_uIndex = -1);
 	/*
-	USAGE: Will update the MyEntity manager
+	USAGE: Gets the entity a handle refers to
+	ARGUMENTS: MyEntityHandle a_hEntity -> handle of the entity
+	OUTPUT: entity, nullptr if the handle is stale
+	*/
+	MyEntity* GetEntity(MyEntityHandle a_hEntity);
+	/*
+	USAGE: Gets the entity specified by unique ID
+	ARGUMENTS: String a_sUniqueID -> Unique Identifier
+	OUTPUT: entity, nullptr if not found
+	*/
+	MyEntity* GetEntity(String a_sUniqueID);
+	/*
+	USAGE: Gets the handle of the entity indexed
+	ARGUMENTS: uint a_uIndex -> index of the entity
+	OUTPUT: handle, null if out of range
+	*/
+	MyEntityHandle GetHandle(uint a_uIndex);
+	/*
+	USAGE: Gets the handle of the entity specified by unique ID, resolve it once and keep the handle
+	ARGUMENTS: String a_sUniqueID -> Unique Identifier
+	OUTPUT: handle, null if not found
+	*/
+	MyEntityHandle GetHandle(String a_sUniqueID);
+	/*
+	USAGE: Gets the index (from the list of entities) of the entity a handle refers to
+	ARGUMENTS: MyEntityHandle a_hEntity -> handle of the entity
+	OUTPUT: index from the list of entities, -1 if the handle is stale
+	*/
+	int GetEntityIndex(MyEntityHandle a_hEntity);
+	/*
+	USAGE: Asks if the entity a handle refers to is still in the list
+	ARGUMENTS: MyEntityHandle a_hEntity -> handle of the entity
+	OUTPUT: valid?
+	*/
+	bool IsValid(MyEntityHandle a_hEntity);
+	/*
+	USAGE: Will update the MyEntity manager, runs as many fixed physics steps as the time
+	passed since the last update requires (up to the maximum) and interpolates the models
+	between the last two physics states for rendering
 	ARGUMENTS: ---
 	OUTPUT: ---
 	*/
+#ifndef SIMPLEX_HEADLESS
 	void Update(void);
+#endif
+	/*
+	USAGE: Will update the MyEntity manager as Update(void) does but with the time passed given by the caller
+	ARGUMENTS: float a_fDeltaTime -> time in seconds since the last update
+	OUTPUT: ---
+	*/
+	void Update(float a_fDeltaTime);
+	/*
+	USAGE: First half of Update, runs as many fixed physics steps as the time passed since the last call
+	requires (up to the maximum), collisions included, without placing the models for rendering
+	ARGUMENTS: ---
+	OUTPUT: ---
+	*/
+#ifndef SIMPLEX_HEADLESS
+	void Simulate(void);
+#endif
+	/*
+	USAGE: Will simulate as Simulate(void) does but with the time passed given by the caller
+	ARGUMENTS: float a_fDeltaTime -> time in seconds since the last call
+	OUTPUT: ---
+	*/
+	void Simulate(float a_fDeltaTime);
+	/*
+	USAGE: Second half of Update, places the children under their parents and the models (and their bounding
+	boxes) in between the last two physics states
+	ARGUMENTS: ---
+	OUTPUT: ---
+	*/
+	void Interpolate(void);
+	/*
+	USAGE: Runs a single fixed physics step, collisions and integration, regardless of the time that has passed
+	ARGUMENTS: ---
+	OUTPUT: ---
+	*/
+	void Step(void);
+	/*
+	USAGE: Gets the time a phase took on the last physics step
+	ARGUMENTS: uint a_uPhase -> phase, from eStepPhase
+	OUTPUT: time in milliseconds
+	*/
+	float GetPhaseTime(uint a_uPhase);
+	/*
+	USAGE: Gets the time a phase took over all the physics steps of the last update or step
+	ARGUMENTS: uint a_uPhase -> phase, from eStepPhase
+	OUTPUT: time in milliseconds
+	*/
+	float GetFramePhaseTime(uint a_uPhase);
+	/*
+	USAGE: Starts writing every call that changes the simulation (entities added and removed, forces, positions,
+	model matrices, flags and updates) to a log that MyReplayer can run again, entities already in the manager
+	are written as boxes at their current state
+	ARGUMENTS: String a_sFileName -> path of the log
+	OUTPUT: did the log open?
+	*/
+	bool StartRecording(String a_sFileName);
+	/*
+	USAGE: Stops recording and closes the log
+	ARGUMENTS: ---
+	OUTPUT: ---
+	*/
+	void StopRecording(void);
+	/*
+	USAGE: Asks if the calls are being recorded
+	ARGUMENTS: ---
+	OUTPUT: recording?
+	*/
+	bool IsRecording(void);
+	/*
+	USAGE: Sets the time simulated on each physics step
+	ARGUMENTS: float a_fTimeStep -> time in seconds
+	OUTPUT: ---
+	*/
+	void SetFixedTimeStep(float a_fTimeStep);
+	/*
+	USAGE: Gets the time simulated on each physics step
+	ARGUMENTS: ---
+	OUTPUT: time in seconds
+	*/
+	float GetFixedTimeStep(void);
+	/*
+	USAGE: Sets the maximum number of physics steps run on a single update, time beyond that gets dropped
+	ARGUMENTS: uint a_uMaxSubsteps -> maximum steps
+	OUTPUT: ---
+	*/
+	void SetMaxSubsteps(uint a_uMaxSubsteps);
+	/*
+	USAGE: Gets the maximum number of physics steps run on a single update
+	ARGUMENTS: ---
+	OUTPUT: maximum steps
+	*/
+	uint GetMaxSubsteps(void);
+	/*
+	USAGE: Gets the number of physics steps run on the last update
+	ARGUMENTS: ---
+	OUTPUT: step count
+	*/
+	uint GetSubstepCount(void);
+	/*
+	USAGE: Gets the number of groups of entities in contact with each other on the last step
+	ARGUMENTS: ---
+	OUTPUT: island count
+	*/
+	uint GetIslandCount(void);
 	/*
 	USAGE: Gets the model associated with this entity
 	ARGUMENTS: uint a_uIndex = -1 -> index in the list of entities; if less than 0 it will add it to the last in the list
@@ -111,6 +394,12 @@ public:
 	*/
 	matrix4 GetModelMatrix(String a_sUniqueID);
 	/*
+	USAGE: Gets the model matrix associated with this entity
+	ARGUMENTS: MyEntityHandle a_hEntity -> handle of the entity
+	OUTPUT: model to world matrix, identity if the handle is stale
+	*/
+	matrix4 GetModelMatrix(MyEntityHandle a_hEntity);
+	/*
 	USAGE: Sets the model matrix associated to the entity specified in the ID
 	ARGUMENTS:
 	-	matrix4 a_m4ToWorld -> model matrix to set
@@ -127,6 +416,14 @@ public:
 	*/
 	void SetModelMatrix(matrix4 a_m4ToWorld, String a_sUniqueID);
 	/*
+	USAGE: Sets the model matrix associated to the entity specified by handle
+	ARGUMENTS:
+	-	matrix4 a_m4ToWorld -> model matrix to set
+	-	MyEntityHandle a_hEntity -> handle of the entity, nothing happens if it is stale
+	OUTPUT: ---
+	*/
+	void SetModelMatrix(matrix4 a_m4ToWorld, MyEntityHandle a_hEntity);
+	/*
 	USAGE: Sets the axis visibility associated to the entity specified in the ID
 	ARGUMENTS: 
 	-	bool a_bVisibility -> visibility of the axis
@@ -159,6 +456,69 @@ public:
 	*/
 	void AddEntityToRenderList(String a_sUniqueID, bool a_bRigidBody = false);
 	/*
+	USAGE: Turns occlusion culling on or off, while on AddEntityToRenderList skips the entities the last
+	call to CullOccludedEntities found behind the occluders, depth is taken from w so nothing is culled with
+	an orthographic camera
+	ARGUMENTS: bool a_bUse = true -> use occlusion culling?
+	OUTPUT: ---
+	*/
+	void UseOcclusionCulling(bool a_bUse = true);
+	/*
+	USAGE: Asks if occlusion culling is on
+	ARGUMENTS: ---
+	OUTPUT: using occlusion culling?
+	*/
+	bool IsUsingOcclusionCulling(void);
+	/*
+	USAGE: Draws the occluders into the occlusion buffer and tests the ARBB of every entity against it,
+	call once per frame before adding the entities to the render list, does nothing if culling is off
+	ARGUMENTS: matrix4 a_m4ViewProjection -> projection * view of the camera the frame is rendered with
+	OUTPUT: ---
+	*/
+	void CullOccludedEntities(matrix4 a_m4ViewProjection);
+	/*
+	USAGE: Sets the occluder flag of the specified object, occluders hide the entities behind their rigid body box
+	ARGUMENTS:
+	-	bool a_bOccluder -> is it an occluder?
+	-	String a_sUniqueID -> ID of the MyEntity
+	OUTPUT: ---
+	*/
+	void SetOccluder(bool a_bOccluder, String a_sUniqueID);
+	/*
+	USAGE: Sets the occluder flag of the specified object, occluders hide the entities behind their rigid body box
+	ARGUMENTS:
+	-	bool a_bOccluder = true -> is it an occluder?
+	-	uint a_uIndex = -1 -> ID of the MyEntity if < 0 last object added
+	OUTPUT: ---
+	*/
+	void SetOccluder(bool a_bOccluder = true, uint a_uIndex = -1);
+	/*
+	USAGE: Sets the occluder flag of the entity specified by handle
+	ARGUMENTS:
+	-	bool a_bOccluder -> is it an occluder?
+	-	MyEntityHandle a_hEntity -> handle of the entity, nothing happens if it is stale
+	OUTPUT: ---
+	*/
+	void SetOccluder(bool a_bOccluder, MyEntityHandle a_hEntity);
+	/*
+	USAGE: Gets the number of entities found behind the occluders on the last culling
+	ARGUMENTS: ---
+	OUTPUT: occluded entities
+	*/
+	uint GetOccludedCount(void);
+	/*
+	USAGE: Gets the time the last culling took
+	ARGUMENTS: ---
+	OUTPUT: time in milliseconds
+	*/
+	float GetOcclusionTime(void);
+	/*
+	USAGE: Gets the culler the occluders are drawn into, for its counters and depth buffer
+	ARGUMENTS: ---
+	OUTPUT: occlusion culler
+	*/
+	MyOcclusionCuller* GetOcclusionCuller(void);
+	/*
 	USAGE: Will set a dimension to the MyEntity
 	ARGUMENTS:
 	-	uint a_uIndex -> index (from the list) of the entity queried if < 0 will use the last one
@@ -264,6 +624,14 @@ public:
 	*/
 	void ApplyForce(vector3 a_v3Force, uint a_uIndex = -1);
 	/*
+	USAGE: Applies a force to the entity specified by handle
+	ARGUMENTS:
+	-	vector3 a_v3Force -> force to apply
+	-	MyEntityHandle a_hEntity -> handle of the entity, nothing happens if it is stale
+	OUTPUT: ---
+	*/
+	void ApplyForce(vector3 a_v3Force, MyEntityHandle a_hEntity);
+	/*
 	USAGE: Sets the position of the specified entity
 	ARGUMENTS:
 	-	vector3 a_v3Position -> position to set
@@ -280,6 +648,14 @@ public:
 	*/
 	void SetPosition(vector3 a_v3Position, uint a_uIndex = -1);
 	/*
+	USAGE: Sets the position of the entity specified by handle
+	ARGUMENTS:
+	-	vector3 a_v3Position -> position to set
+	-	MyEntityHandle a_hEntity -> handle of the entity, nothing happens if it is stale
+	OUTPUT: ---
+	*/
+	void SetPosition(vector3 a_v3Position, MyEntityHandle a_hEntity);
+	/*
 	USAGE: Sets the mass of the specified entity
 	ARGUMENTS:
 	-	float a_fMass -> mass to set
@@ -296,6 +672,14 @@ public:
 	*/
 	void SetMass(float a_v3Position, uint a_uIndex = -1);
 	/*
+	USAGE: Sets the mass of the entity specified by handle
+	ARGUMENTS:
+	-	float a_fMass -> mass to set
+	-	MyEntityHandle a_hEntity -> handle of the entity, nothing happens if it is stale
+	OUTPUT: ---
+	*/
+	void SetMass(float a_fMass, MyEntityHandle a_hEntity);
+	/*
 	USAGE: Sets the using physics solver flag for the specified object
 	ARGUMENTS:
 	-	bool a_bUse -> Using physics?
@@ -311,7 +695,213 @@ public:
 	OUTPUT: ---
 	*/
 	void UsePhysicsSolver(bool a_bUse = true, uint a_uIndex = -1);
+	/*
+	USAGE: Sets the using physics solver flag for the entity specified by handle
+	ARGUMENTS:
+	-	bool a_bUse -> Using physics?
+	-	MyEntityHandle a_hEntity -> handle of the entity, nothing happens if it is stale
+	OUTPUT: ---
+	*/
+	void UsePhysicsSolver(bool a_bUse, MyEntityHandle a_hEntity);
+	/*
+	USAGE: Sets the continuous collision detection flag for the specified object, meant for fast movers
+	ARGUMENTS:
+	-	bool a_bUse -> Using continuous collision detection?
+	-	String a_sUniqueID -> ID of the MyEntity
+	OUTPUT: ---
+	*/
+	void UseContinuousCollision(bool a_bUse, String a_sUniqueID);
+	/*
+	USAGE: Sets the continuous collision detection flag for the specified object, meant for fast movers
+	ARGUMENTS:
+	-	bool a_bUse -> Using continuous collision detection?
+	-	uint a_uIndex = -1 -> ID of the MyEntity if < 0 last object added
+	OUTPUT: ---
+	*/
+	void UseContinuousCollision(bool a_bUse = true, uint a_uIndex = -1);
+	/*
+	USAGE: Sets the continuous collision detection flag for the entity specified by handle
+	ARGUMENTS:
+	-	bool a_bUse -> Using continuous collision detection?
+	-	MyEntityHandle a_hEntity -> handle of the entity, nothing happens if it is stale
+	OUTPUT: ---
+	*/
+	void UseContinuousCollision(bool a_bUse, MyEntityHandle a_hEntity);
+	/*
+	USAGE: Attaches an entity to a parent, the child keeps its world placement and from then on is
+	placed by its local transform relative to the parent, which should not be moved by the solver
+	ARGUMENTS:
+	-	MyEntityHandle a_hChild -> handle of the entity to attach
+	-	MyEntityHandle a_hParent -> handle of the parent, a null handle detaches the child
+	OUTPUT: was it attached? not if a handle is stale or the parent is the child or one of its descendants
+	*/
+	bool SetParent(MyEntityHandle a_hChild, MyEntityHandle a_hParent);
+	/*
+	USAGE: Gets the parent of an entity
+	ARGUMENTS: MyEntityHandle a_hEntity -> handle of the entity
+	OUTPUT: handle of the parent, null if it has none or the handle is stale
+	*/
+	MyEntityHandle GetParent(MyEntityHandle a_hEntity);
+	/*
+	USAGE: Sets the transform of an entity relative to its parent, or to the world if it has none;
+	its world matrix and the ones of its descendants are computed on the next update
+	ARGUMENTS:
+	-	vector3 a_v3Position -> position
+	-	quaternion a_qOrientation -> orientation
+	-	vector3 a_v3Scale -> scale
+	-	MyEntityHandle a_hEntity -> handle of the entity, nothing happens if it is stale
+	OUTPUT: ---
+	*/
+	void SetLocalTransform(vector3 a_v3Position, quaternion a_qOrientation, vector3 a_v3Scale, MyEntityHandle a_hEntity);
+	/*
+	USAGE: Sets the position of an entity relative to its parent, keeping the rest of its local transform
+	ARGUMENTS:
+	-	vector3 a_v3Position -> position
+	-	MyEntityHandle a_hEntity -> handle of the entity, nothing happens if it is stale
+	OUTPUT: ---
+	*/
+	void SetLocalPosition(vector3 a_v3Position, MyEntityHandle a_hEntity);
+	/*
+	USAGE: Sets the orientation of an entity relative to its parent, keeping the rest of its local transform
+	ARGUMENTS:
+	-	quaternion a_qOrientation -> orientation
+	-	MyEntityHandle a_hEntity -> handle of the entity, nothing happens if it is stale
+	OUTPUT: ---
+	*/
+	void SetLocalOrientation(quaternion a_qOrientation, MyEntityHandle a_hEntity);
+	/*
+	USAGE: Sets the scale of an entity relative to its parent, keeping the rest of its local transform
+	ARGUMENTS:
+	-	vector3 a_v3Scale -> scale
+	-	MyEntityHandle a_hEntity -> handle of the entity, nothing happens if it is stale
+	OUTPUT: ---
+	*/
+	void SetLocalScale(vector3 a_v3Scale, MyEntityHandle a_hEntity);
+	/*
+	USAGE: Gets the transform of an entity relative to its parent
+	ARGUMENTS: MyEntityHandle a_hEntity -> handle of the entity
+	OUTPUT: local matrix, identity if the handle is stale
+	*/
+	matrix4 GetLocalMatrix(MyEntityHandle a_hEntity);
+	/*
+	USAGE: Gets the number of world matrices the hierarchy computed on the last update or step
+	ARGUMENTS: ---
+	OUTPUT: matrix count
+	*/
+	uint GetHierarchyUpdateCount(void);
 private:
+	/*
+	Usage: Adds an entity that was already loaded to the list, returns it to the pool if it could not be initialized
+	Arguments: MyEntity* a_pEntity -> entity to add
+	Output: handle of the entity, null if it could not be initialized
+	*/
+	MyEntityHandle AddEntity(MyEntity* a_pEntity);
+	/*
+	Usage: Takes an empty entity from the pool, or creates one if the pool is empty
+	Arguments: ---
+	Output: empty entity, to be loaded
+	*/
+	MyEntity* TakeEntity(void);
+	/*
+	Usage: Empties an entity and keeps it in the pool to be loaded again
+	Arguments: MyEntity* a_pEntity -> entity that left the list
+	Output: ---
+	*/
+	void RecycleEntity(MyEntity* a_pEntity);
+	/*
+	Usage: Gives a slot to an entity added at the end of the list
+	Arguments: ---
+	Output: handle of the entity
+	*/
+	MyEntityHandle AllocateSlot(void);
+	/*
+	Usage: Frees the slot of an entity that left the list, the handles to it become stale
+	Arguments: uint a_uSlot -> slot
+	Output: ---
+	*/
+	void FreeSlot(uint a_uSlot);
+	/*
+	Usage: Runs a physics step timing each of its phases, shared by Step and Update so only the call
+	that started it gets recorded
+	Arguments: ---
+	Output: ---
+	*/
+	void SimulateStep(void);
+	/*
+	Usage: Computes the world matrices of the entities in the hierarchy whose local transform or
+	parent changed, walking the list by depth so the parents are placed before their children
+	Arguments: ---
+	Output: ---
+	*/
+	void UpdateHierarchy(void);
+	/*
+	Usage: Builds the list of slots in the hierarchy sorted by depth
+	Arguments: ---
+	Output: ---
+	*/
+	void BuildHierarchy(void);
+	/*
+	Usage: Takes a slot out of the hierarchy, its children are left where they are as roots
+	Arguments: uint a_uSlot -> slot
+	Output: ---
+	*/
+	void DetachSlot(uint a_uSlot);
+	/*
+	Usage: Adds a slot to the children of another one, it must not have a parent
+	Arguments:
+	-	uint a_uParent -> slot of the parent
+	-	uint a_uChild -> slot of the child
+	Output: ---
+	*/
+	void LinkChild(uint a_uParent, uint a_uChild);
+	/*
+	Usage: Takes a slot out of the children of its parent, if it has one
+	Arguments: uint a_uChild -> slot of the child
+	Output: ---
+	*/
+	void UnlinkChild(uint a_uChild);
+	/*
+	Usage: Gets the transform of an entity relative to its parent, taken from its model matrix if it
+	was never given one
+	Arguments:
+	-	uint a_uIndex -> index of the entity
+	-	vector3& a_v3Position -> (output) position
+	-	quaternion& a_qOrientation -> (output) orientation
+	-	vector3& a_v3Scale -> (output) scale
+	Output: ---
+	*/
+	void GetLocalTransform(uint a_uIndex, vector3& a_v3Position, quaternion& a_qOrientation, vector3& a_v3Scale);
+	/*
+	Usage: Splits a matrix made of a translation, a rotation and a scale into them
+	Arguments:
+	-	matrix4 a_m4Matrix -> matrix to split
+	-	vector3& a_v3Position -> (output) translation
+	-	quaternion& a_qOrientation -> (output) rotation
+	-	vector3& a_v3Scale -> (output) scale
+	Output: ---
+	*/
+	static void Decompose(matrix4 a_m4Matrix, vector3& a_v3Position, quaternion& a_qOrientation, vector3& a_v3Scale);
+	/*
+	Usage: Resolves the contacts found on this step with the sequential impulse solver, contacts are grouped in islands
+	of entities touching each other and each island is solved as an independent task, inside an island the contacts keep
+	the order they were found in so the result does not depend on the number of threads
+	Arguments: ---
+	Output: ---
+	*/
+	void ResolveContacts(void);
+	/*
+	Usage: Finds the island the entity belongs to
+	Arguments: uint a_uIndex -> index of the entity
+	Output: index of the entity that represents the island
+	*/
+	uint FindIsland(uint a_uIndex);
+	/*
+	Usage: Sweeps the fast movers along the motion of this frame against the candidates the detection found for them
+	and moves them back to their first contact
+	Arguments: ---
+	Output: ---
+	*/
+	void ResolveContinuousCollisions(void);
 	/*
 	Usage: constructor
 	Arguments: ---
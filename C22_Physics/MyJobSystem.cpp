@@ -0,0 +1,271 @@
+#include "MyJobSystem.h"
+using namespace Simplex;
+//index of the thread running, the workers set theirs when they start
+static thread_local uint g_uThreadIndex = 0;
+//  MyJobSystem
+Simplex::MyJobSystem* Simplex::MyJobSystem::m_pInstance = nullptr;
+void Simplex::MyJobSystem::Init(void)
+{
+	m_uQueuedJobs = 0;
+	m_bExit = false;
+	m_FrameStart = Clock::now();
+	m_fLastFrameLength = 0.0f;
+
+	//the main thread is thread 0 and works while it waits, only the other cores get a worker
+	uint uCores = std::thread::hardware_concurrency();
+	m_uThreadCount = uCores > 1 ? uCores : 1;
+
+	m_pWorkerArray = new MyWorker[m_uThreadCount];
+	for (uint i = 0; i < m_uThreadCount; ++i)
+	{
+		m_pWorkerArray[i].m_pJobPool = new MyJob[m_uJobPoolSize];
+		m_pWorkerArray[i].m_uNextJob = 0;
+	}
+	for (uint i = 1; i < m_uThreadCount; ++i)
+	{
+		m_ThreadList.push_back(std::thread(&MyJobSystem::WorkerLoop, this, i));
+	}
+}
+void Simplex::MyJobSystem::Release(void)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_SleepMutex);
+		m_bExit = true;
+	}
+	m_WakeUp.notify_all();
+	for (uint i = 0; i < m_ThreadList.size(); ++i)
+	{
+		m_ThreadList[i].join();
+	}
+	m_ThreadList.clear();
+
+	if (m_pWorkerArray)
+	{
+		for (uint i = 0; i < m_uThreadCount; ++i)
+		{
+			delete[] m_pWorkerArray[i].m_pJobPool;
+		}
+		delete[] m_pWorkerArray;
+		m_pWorkerArray = nullptr;
+	}
+}
+Simplex::MyJobSystem* Simplex::MyJobSystem::GetInstance()
+{
+	if (m_pInstance == nullptr)
+	{
+		m_pInstance = new MyJobSystem();
+	}
+	return m_pInstance;
+}
+void Simplex::MyJobSystem::ReleaseInstance()
+{
+	if (m_pInstance != nullptr)
+	{
+		delete m_pInstance;
+		m_pInstance = nullptr;
+	}
+}
+//The big 3
+Simplex::MyJobSystem::MyJobSystem(){ Init(); }
+Simplex::MyJobSystem::MyJobSystem(MyJobSystem const& a_pOther){ }
+Simplex::MyJobSystem& Simplex::MyJobSystem::operator=(MyJobSystem const& a_pOther) { return *this; }
+Simplex::MyJobSystem::~MyJobSystem(){ Release(); };
+//Accessors
+Simplex::uint Simplex::MyJobSystem::GetThreadCount(void) { return m_uThreadCount; }
+Simplex::uint Simplex::MyJobSystem::GetThreadIndex(void) { return g_uThreadIndex; }
+bool Simplex::MyJobSystem::IsFinished(MyJob* a_pJob) { return a_pJob->m_uUnfinished == 0; }
+float Simplex::MyJobSystem::GetFrameLength(void) { return m_fLastFrameLength; }
+std::vector<MyJobSpan> Simplex::MyJobSystem::GetFrameTimeline(uint a_uThread)
+{
+	if (a_uThread >= m_uThreadCount)
+		return std::vector<MyJobSpan>();
+	return m_pWorkerArray[a_uThread].m_LastSpanList;
+}
+float Simplex::MyJobSystem::GetUtilization(uint a_uThread)
+{
+	if (a_uThread >= m_uThreadCount || m_fLastFrameLength <= 0.0f)
+		return 0.0f;
+
+	//a job waiting on others runs them inside its own span, merge the overlaps so they count once
+	std::vector<MyJobSpan> spanList = m_pWorkerArray[a_uThread].m_LastSpanList;
+	std::sort(spanList.begin(), spanList.end(), [](MyJobSpan const& a, MyJobSpan const& b) { return a.fStart < b.fStart; });
+	float fBusy = 0.0f;
+	float fCovered = 0.0f;
+	for (uint i = 0; i < spanList.size(); ++i)
+	{
+		float fStart = std::max(spanList[i].fStart, fCovered);
+		if (spanList[i].fEnd > fStart)
+		{
+			fBusy += spanList[i].fEnd - fStart;
+			fCovered = spanList[i].fEnd;
+		}
+	}
+	return std::min(fBusy / m_fLastFrameLength, 1.0f);
+}
+//Methods
+void Simplex::MyJobSystem::BeginFrame(void)
+{
+	Clock::time_point now = Clock::now();
+	m_fLastFrameLength = std::chrono::duration<float, std::milli>(now - m_FrameStart).count();
+	m_FrameStart = now;
+	for (uint i = 0; i < m_uThreadCount; ++i)
+	{
+		m_pWorkerArray[i].m_LastSpanList.swap(m_pWorkerArray[i].m_SpanList);
+		m_pWorkerArray[i].m_SpanList.clear();
+	}
+}
+MyJob* Simplex::MyJobSystem::CreateJob(std::function<void(void)> a_Task, const char* a_sName, MyJob* a_pParent)
+{
+	//take the next job of the ring of this thread, by now the one that used it is long finished
+	MyWorker& worker = m_pWorkerArray[GetThreadIndex()];
+	MyJob* pJob = &worker.m_pJobPool[worker.m_uNextJob];
+	worker.m_uNextJob = (worker.m_uNextJob + 1) % m_uJobPoolSize;
+
+	pJob->m_Task = a_Task;
+	pJob->m_sName = a_sName;
+	pJob->m_pParent = a_pParent;
+	pJob->m_uUnfinished = 1;
+	pJob->m_uPending = 1;
+	pJob->m_uDependentCount = 0;
+	if (a_pParent)
+		++a_pParent->m_uUnfinished;
+	return pJob;
+}
+bool Simplex::MyJobSystem::AddDependency(MyJob* a_pJob, MyJob* a_pPrerequisite)
+{
+	if (a_pPrerequisite->m_uDependentCount >= MyJob::m_uMaxDependents)
+		return false;
+
+	a_pPrerequisite->m_pDependentArray[a_pPrerequisite->m_uDependentCount] = a_pJob;
+	++a_pPrerequisite->m_uDependentCount;
+	++a_pJob->m_uPending;
+	return true;
+}
+void Simplex::MyJobSystem::Run(MyJob* a_pJob)
+{
+	//drop the hold placed on creation, if nothing else is pending it is ready
+	if (--a_pJob->m_uPending == 0)
+		Push(a_pJob);
+}
+void Simplex::MyJobSystem::Wait(MyJob* a_pJob)
+{
+	while (a_pJob->m_uUnfinished > 0)
+	{
+		MyJob* pJob = GetJob();
+		if (pJob)
+			Execute(pJob);
+		else
+			std::this_thread::yield();
+	}
+}
+void Simplex::MyJobSystem::ParallelFor(uint a_uCount, std::function<void(uint)> a_Task, const char* a_sName)
+{
+	if (a_uCount == 0)
+		return;
+
+	//a few batches per thread so the ones that finish early can steal the rest
+	uint uBatchSize = std::max(a_uCount / (m_uThreadCount * 4), 1u);
+	MyJob* pRoot = CreateJob(nullptr, a_sName);
+	for (uint uStart = 0; uStart < a_uCount; uStart += uBatchSize)
+	{
+		uint uEnd = std::min(uStart + uBatchSize, a_uCount);
+		Run(CreateJob([&a_Task, uStart, uEnd]()
+		{
+			for (uint i = uStart; i < uEnd; ++i)
+				a_Task(i);
+		}, a_sName, pRoot));
+	}
+	Run(pRoot);
+	Wait(pRoot);
+}
+void Simplex::MyJobSystem::Push(MyJob* a_pJob)
+{
+	//counted before it is queued so it cannot be taken before it is counted
+	++m_uQueuedJobs;
+	MyWorker& worker = m_pWorkerArray[GetThreadIndex()];
+	{
+		std::lock_guard<std::mutex> lock(worker.m_Mutex);
+		worker.m_JobQueue.push_back(a_pJob);
+	}
+
+	//taking the lock makes sure a worker about to sleep sees the job first
+	{
+		std::lock_guard<std::mutex> lock(m_SleepMutex);
+	}
+	m_WakeUp.notify_one();
+}
+MyJob* Simplex::MyJobSystem::GetJob(void)
+{
+	uint uThread = GetThreadIndex();
+
+	//newest job of this thread first, its data is the most likely to still be in cache
+	{
+		MyWorker& worker = m_pWorkerArray[uThread];
+		std::lock_guard<std::mutex> lock(worker.m_Mutex);
+		if (!worker.m_JobQueue.empty())
+		{
+			MyJob* pJob = worker.m_JobQueue.back();
+			worker.m_JobQueue.pop_back();
+			--m_uQueuedJobs;
+			return pJob;
+		}
+	}
+
+	//steal the oldest job of the others, it is the one that is likely to spawn the most work
+	for (uint i = 1; i < m_uThreadCount; ++i)
+	{
+		MyWorker& victim = m_pWorkerArray[(uThread + i) % m_uThreadCount];
+		std::lock_guard<std::mutex> lock(victim.m_Mutex);
+		if (!victim.m_JobQueue.empty())
+		{
+			MyJob* pJob = victim.m_JobQueue.front();
+			victim.m_JobQueue.pop_front();
+			--m_uQueuedJobs;
+			return pJob;
+		}
+	}
+	return nullptr;
+}
+void Simplex::MyJobSystem::Execute(MyJob* a_pJob)
+{
+	MyJobSpan span;
+	span.sName = a_pJob->m_sName;
+	span.fStart = std::chrono::duration<float, std::milli>(Clock::now() - m_FrameStart).count();
+	if (a_pJob->m_Task)
+		a_pJob->m_Task();
+	span.fEnd = std::chrono::duration<float, std::milli>(Clock::now() - m_FrameStart).count();
+	m_pWorkerArray[GetThreadIndex()].m_SpanList.push_back(span);
+
+	Finish(a_pJob);
+}
+void Simplex::MyJobSystem::Finish(MyJob* a_pJob)
+{
+	if (--a_pJob->m_uUnfinished > 0)
+		return;
+
+	//the job and its children are done, release the jobs waiting on it
+	MyJob* pParent = a_pJob->m_pParent;
+	for (uint i = 0; i < a_pJob->m_uDependentCount; ++i)
+	{
+		Run(a_pJob->m_pDependentArray[i]);
+	}
+	if (pParent)
+		Finish(pParent);
+}
+void Simplex::MyJobSystem::WorkerLoop(uint a_uThread)
+{
+	g_uThreadIndex = a_uThread;
+	while (!m_bExit)
+	{
+		MyJob* pJob = GetJob();
+		if (pJob)
+		{
+			Execute(pJob);
+			continue;
+		}
+
+		//nothing to do, sleep until a job is queued
+		std::unique_lock<std::mutex> lock(m_SleepMutex);
+		m_WakeUp.wait(lock, [this] { return m_bExit || m_uQueuedJobs > 0; });
+	}
+}
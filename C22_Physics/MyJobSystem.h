@@ -0,0 +1,253 @@
+/*----------------------------------------------
+Programmer: Alberto Bobadilla (labigm@gmail.com)
+Date: 2017/07
+----------------------------------------------*/
+#ifndef __MYJOBSYSTEM_H_
+#define __MYJOBSYSTEM_H_
+
+#ifdef SIMPLEX_HEADLESS
+#include "HeadlessDefinitions.h"
+#else
+#include "Simplex\Simplex.h"
+#endif
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <deque>
+#include <chrono>
+
+namespace Simplex
+{
+
+//Unit of work of the job system, it runs once all the jobs it depends on have finished and it is not finished
+//until all of its children have finished too
+struct MyJob
+{
+	static const uint m_uMaxDependents = 16; //jobs that can wait on a single job
+
+	std::function<void(void)> m_Task; //work to do
+	const char* m_sName = "Job"; //name shown in the timeline, must outlive the frame
+	MyJob* m_pParent = nullptr; //job that does not finish until this one does
+	std::atomic<uint> m_uUnfinished; //this job plus its children that have not finished
+	std::atomic<uint> m_uPending; //jobs this one depends on that have not finished, plus one until it is run
+	MyJob* m_pDependentArray[m_uMaxDependents]; //jobs that depend on this one
+	uint m_uDependentCount = 0; //number of jobs that depend on this one
+};
+
+//Time a job ran on a thread, relative to the start of the frame
+struct MyJobSpan
+{
+	float fStart = 0.0f; //milliseconds
+	float fEnd = 0.0f; //milliseconds
+	const char* sName = nullptr; //name of the job
+};
+
+//Fixed set of worker threads that run jobs, each thread keeps its own queue of jobs and takes jobs from
+//the others when it runs out, the thread that creates the system (thread 0) works too while it waits
+class MyJobSystem
+{
+	typedef std::chrono::high_resolution_clock Clock;
+
+	//State owned by each thread
+	struct MyWorker
+	{
+		std::mutex m_Mutex; //guards the queue
+		std::deque<MyJob*> m_JobQueue; //the owner works from the back, the others steal from the front
+		MyJob* m_pJobPool = nullptr; //ring of jobs this thread creates
+		uint m_uNextJob = 0; //next job of the ring
+		std::vector<MyJobSpan> m_SpanList; //jobs run on this frame
+		std::vector<MyJobSpan> m_LastSpanList; //jobs run on the last frame
+	};
+
+	static MyJobSystem* m_pInstance; // Singleton pointer
+	static const uint m_uJobPoolSize = 4096; //jobs a thread can have in flight at once
+
+	std::vector<std::thread> m_ThreadList; //worker threads
+	MyWorker* m_pWorkerArray = nullptr; //state of each thread, 0 is the main thread
+	uint m_uThreadCount = 1; //worker threads plus the main thread
+
+	std::atomic<uint> m_uQueuedJobs; //jobs waiting on any queue
+	std::mutex m_SleepMutex; //guards the sleep of idle workers
+	std::condition_variable m_WakeUp; //signals the idle workers there are jobs
+	std::atomic<bool> m_bExit; //tells the workers to finish
+
+	Clock::time_point m_FrameStart; //start of the current frame
+	float m_fLastFrameLength = 0.0f; //milliseconds of the last frame
+public:
+	/*
+	Usage: Gets the singleton pointer
+	Arguments: ---
+	Output: singleton pointer
+	*/
+	static MyJobSystem* GetInstance();
+	/*
+	Usage: Releases the content of the singleton
+	Arguments: ---
+	Output: ---
+	*/
+	static void ReleaseInstance(void);
+	/*
+	USAGE: Gets the number of threads running jobs, including the main thread
+	ARGUMENTS: ---
+	OUTPUT: thread count
+	*/
+	uint GetThreadCount(void);
+	/*
+	USAGE: Creates a job that is not running yet, jobs are taken from a ring so they only live for a few frames
+	ARGUMENTS:
+	-	std::function<void(void)> a_Task -> work to do
+	-	const char* a_sName = "Job" -> name shown in the timeline, must outlive the frame
+	-	MyJob* a_pParent = nullptr -> job that will not finish until this one does, the parent must not
+		have finished, so it has to be created before it runs or from its own task
+	OUTPUT: job, to be run with Run
+	*/
+	MyJob* CreateJob(std::function<void(void)> a_Task, const char* a_sName = "Job", MyJob* a_pParent = nullptr);
+	/*
+	USAGE: Makes a job wait for another one to finish before it runs, neither of them can be running yet
+	ARGUMENTS:
+	-	MyJob* a_pJob -> job that waits
+	-	MyJob* a_pPrerequisite -> job waited for
+	OUTPUT: was the dependency added? false if the prerequisite has too many dependents
+	*/
+	bool AddDependency(MyJob* a_pJob, MyJob* a_pPrerequisite);
+	/*
+	USAGE: Queues a job on the calling thread, it runs as soon as the jobs it depends on finish
+	ARGUMENTS: MyJob* a_pJob -> job to run
+	OUTPUT: ---
+	*/
+	void Run(MyJob* a_pJob);
+	/*
+	USAGE: Waits for a job and all its children to finish, running other jobs in the meantime
+	ARGUMENTS: MyJob* a_pJob -> job to wait for
+	OUTPUT: ---
+	*/
+	void Wait(MyJob* a_pJob);
+	/*
+	USAGE: Asks if a job and all its children have finished
+	ARGUMENTS: MyJob* a_pJob -> job
+	OUTPUT: finished?
+	*/
+	bool IsFinished(MyJob* a_pJob);
+	/*
+	USAGE: Runs the task for every index from 0 to a_uCount - 1 split in jobs across the threads and waits for all of them,
+	the order in which the indices run is not defined so tasks must not depend on each other
+	ARGUMENTS:
+	-	uint a_uCount -> number of indices
+	-	std::function<void(uint)> a_Task -> task to run for each index
+	-	const char* a_sName = "ParallelFor" -> name of the jobs shown in the timeline
+	OUTPUT: ---
+	*/
+	void ParallelFor(uint a_uCount, std::function<void(uint)> a_Task, const char* a_sName = "ParallelFor");
+	/*
+	USAGE: Starts a new frame of the timeline, the jobs of the frame that ends become the ones reported,
+	call it from the main thread when no jobs are running
+	ARGUMENTS: ---
+	OUTPUT: ---
+	*/
+	void BeginFrame(void);
+	/*
+	USAGE: Gets the jobs a thread ran on the last frame
+	ARGUMENTS: uint a_uThread -> thread, 0 is the main thread
+	OUTPUT: jobs in the order they ran, empty if out of range
+	*/
+	std::vector<MyJobSpan> GetFrameTimeline(uint a_uThread);
+	/*
+	USAGE: Gets the length of the last frame
+	ARGUMENTS: ---
+	OUTPUT: milliseconds
+	*/
+	float GetFrameLength(void);
+	/*
+	USAGE: Gets the fraction of the last frame a thread spent running jobs, nested jobs are only counted once
+	ARGUMENTS: uint a_uThread -> thread, 0 is the main thread
+	OUTPUT: fraction from 0 to 1
+	*/
+	float GetUtilization(uint a_uThread);
+private:
+	/*
+	Usage: constructor
+	Arguments: ---
+	Output: class object instance
+	*/
+	MyJobSystem(void);
+	/*
+	Usage: copy constructor
+	Arguments: class object to copy
+	Output: class object instance
+	*/
+	MyJobSystem(MyJobSystem const& a_pOther);
+	/*
+	Usage: copy assignment operator
+	Arguments: class object to copy
+	Output: ---
+	*/
+	MyJobSystem& operator=(MyJobSystem const& a_pOther);
+	/*
+	Usage: destructor
+	Arguments: ---
+	Output: ---
+	*/
+	~MyJobSystem(void);
+	/*
+	Usage: releases the worker threads
+	Arguments: ---
+	Output: ---
+	*/
+	void Release(void);
+	/*
+	Usage: initializes the singleton and starts the worker threads
+	Arguments: ---
+	Output: ---
+	*/
+	void Init(void);
+	/*
+	Usage: Loop each worker thread runs until the system is released
+	Arguments: uint a_uThread -> index of the thread
+	Output: ---
+	*/
+	void WorkerLoop(uint a_uThread);
+	/*
+	Usage: Adds a job that is ready to the queue of the calling thread and wakes an idle worker
+	Arguments: MyJob* a_pJob -> job to queue
+	Output: ---
+	*/
+	void Push(MyJob* a_pJob);
+	/*
+	Usage: Takes the newest job of the calling thread, or the oldest job of another thread if it has none
+	Arguments: ---
+	Output: job, nullptr if every queue is empty
+	*/
+	MyJob* GetJob(void);
+	/*
+	Usage: Runs a job on the calling thread and finishes it
+	Arguments: MyJob* a_pJob -> job to run
+	Output: ---
+	*/
+	void Execute(MyJob* a_pJob);
+	/*
+	Usage: Marks one unfinished part of a job as done, once all of them are the jobs that depend on it get
+	queued and its parent is told
+	Arguments: MyJob* a_pJob -> job
+	Output: ---
+	*/
+	void Finish(MyJob* a_pJob);
+	/*
+	Usage: Gets the index of the calling thread
+	Arguments: ---
+	Output: index, 0 for the main thread
+	*/
+	uint GetThreadIndex(void);
+};//class
+
+} //namespace Simplex
+
+#endif //__MYJOBSYSTEM_H_
+
+/*
+USAGE:
+ARGUMENTS: ---
+OUTPUT: ---
+*/
@@ -0,0 +1,390 @@
+#include "MyOcclusionCuller.h"
+#include <emmintrin.h>
+#include <cfloat>
+using namespace Simplex;
+namespace
+{
+	const float g_fNearW = 0.01f; //closest w kept by the clipper, nearer geometry is dropped from the occluders
+	const float g_fGuardBand = 2.0f; //clip x and y to this many times the screen so pixel coordinates stay small
+
+	//corners of a box, the index bits select the maximum coordinate in x (1), y (2) and z (4)
+	vector3 GetCorner(vector3 const& a_v3Min, vector3 const& a_v3Max, uint a_uIndex)
+	{
+		return vector3((a_uIndex & 1) ? a_v3Max.x : a_v3Min.x,
+			(a_uIndex & 2) ? a_v3Max.y : a_v3Min.y,
+			(a_uIndex & 4) ? a_v3Max.z : a_v3Min.z);
+	}
+
+	//faces of a box as corner indices, counter clockwise seen from outside (-x, +x, -y, +y, -z, +z)
+	const uint g_uBoxFace[6][4] = {
+		{ 0, 4, 6, 2 }, { 1, 3, 7, 5 },
+		{ 0, 1, 5, 4 }, { 2, 6, 7, 3 },
+		{ 0, 2, 3, 1 }, { 4, 5, 7, 6 } };
+
+	//distance of a clip space vertex to each plane the clipper uses, inside if positive
+	float GetPlaneDistance(vector4 const& a_v4Vertex, uint a_uPlane)
+	{
+		switch (a_uPlane)
+		{
+		case 0: return a_v4Vertex.w - g_fNearW;
+		case 1: return g_fGuardBand * a_v4Vertex.w - a_v4Vertex.x;
+		case 2: return g_fGuardBand * a_v4Vertex.w + a_v4Vertex.x;
+		case 3: return g_fGuardBand * a_v4Vertex.w - a_v4Vertex.y;
+		default: return g_fGuardBand * a_v4Vertex.w + a_v4Vertex.y;
+		}
+	}
+}
+//The big 3
+MyOcclusionCuller::MyOcclusionCuller(void)
+{
+	//each level halves the one before it, a side that reaches one texel stays at one
+	uint uWidth = m_uWidth;
+	uint uHeight = m_uHeight;
+	for (m_uLevelCount = 0; m_uLevelCount < m_uLevelMax; ++m_uLevelCount)
+	{
+		m_Level[m_uLevelCount].uWidth = uWidth;
+		m_Level[m_uLevelCount].uHeight = uHeight;
+		m_Level[m_uLevelCount].DepthList.resize(uWidth * uHeight, 0.0f);
+		if (uWidth == 1 && uHeight == 1)
+		{
+			++m_uLevelCount;
+			break;
+		}
+		uWidth = std::max(uWidth / 2, 1u);
+		uHeight = std::max(uHeight / 2, 1u);
+	}
+}
+MyOcclusionCuller::MyOcclusionCuller(MyOcclusionCuller const& other)
+{
+	for (uint i = 0; i < m_uLevelMax; ++i)
+		m_Level[i] = other.m_Level[i];
+	m_uLevelCount = other.m_uLevelCount;
+	m_m4ViewProjection = other.m_m4ViewProjection;
+	m_bEmpty = other.m_bEmpty;
+	m_bPyramidDirty = other.m_bPyramidDirty;
+	m_uOccluderCount = other.m_uOccluderCount;
+	m_uTriangleCount = other.m_uTriangleCount;
+	m_uTestCount = other.m_uTestCount;
+	m_uOccludedCount = other.m_uOccludedCount;
+}
+MyOcclusionCuller& MyOcclusionCuller::operator=(MyOcclusionCuller const& other)
+{
+	if (this != &other)
+	{
+		for (uint i = 0; i < m_uLevelMax; ++i)
+			m_Level[i] = other.m_Level[i];
+		m_uLevelCount = other.m_uLevelCount;
+		m_m4ViewProjection = other.m_m4ViewProjection;
+		m_bEmpty = other.m_bEmpty;
+		m_bPyramidDirty = other.m_bPyramidDirty;
+		m_uOccluderCount = other.m_uOccluderCount;
+		m_uTriangleCount = other.m_uTriangleCount;
+		m_uTestCount = other.m_uTestCount;
+		m_uOccludedCount = other.m_uOccludedCount;
+	}
+	return *this;
+}
+MyOcclusionCuller::~MyOcclusionCuller(void) { }
+//Accessors
+uint MyOcclusionCuller::GetOccluderCount(void) { return m_uOccluderCount; }
+uint MyOcclusionCuller::GetTriangleCount(void) { return m_uTriangleCount; }
+uint MyOcclusionCuller::GetTestCount(void) { return m_uTestCount; }
+uint MyOcclusionCuller::GetOccludedCount(void) { return m_uOccludedCount; }
+float MyOcclusionCuller::GetDepth(uint a_uLevel, uint a_uX, uint a_uY)
+{
+	if (a_uLevel >= m_uLevelCount)
+		return 0.0f;
+	if (m_bPyramidDirty)
+		BuildPyramid();
+	MyLevel& level = m_Level[a_uLevel];
+	if (a_uX >= level.uWidth || a_uY >= level.uHeight)
+		return 0.0f;
+	return level.DepthList[a_uY * level.uWidth + a_uX];
+}
+//Methods
+void MyOcclusionCuller::BeginFrame(matrix4 a_m4ViewProjection)
+{
+	m_m4ViewProjection = a_m4ViewProjection;
+	std::fill(m_Level[0].DepthList.begin(), m_Level[0].DepthList.end(), 0.0f);
+	m_bEmpty = true;
+	m_bPyramidDirty = false;
+	m_uOccluderCount = 0;
+	m_uTriangleCount = 0;
+	m_uTestCount = 0;
+	m_uOccludedCount = 0;
+}
+void MyOcclusionCuller::AddOccluder(matrix4 a_m4ToWorld, vector3 a_v3Min, vector3 a_v3Max)
+{
+	matrix4 m4ToClip = m_m4ViewProjection * a_m4ToWorld;
+	vector4 v4Corner[8];
+	uint uOutside[5] = { 0, 0, 0, 0, 0 }; //corners outside of each clipping plane
+	for (uint i = 0; i < 8; ++i)
+	{
+		v4Corner[i] = m4ToClip * vector4(GetCorner(a_v3Min, a_v3Max, i), 1.0f);
+		for (uint uPlane = 0; uPlane < 5; ++uPlane)
+		{
+			if (GetPlaneDistance(v4Corner[i], uPlane) < 0.0f)
+				++uOutside[uPlane];
+		}
+	}
+	//the whole box is behind the camera or off the guard band
+	for (uint uPlane = 0; uPlane < 5; ++uPlane)
+	{
+		if (uOutside[uPlane] == 8)
+			return;
+	}
+
+	//the whole box is inside all of them, the corners can be projected once and shared by the faces
+	bool bClip = false;
+	for (uint uPlane = 0; uPlane < 5; ++uPlane)
+		bClip = bClip || uOutside[uPlane] > 0;
+	vector3 v3Screen[8];
+	if (!bClip)
+	{
+		for (uint i = 0; i < 8; ++i)
+			v3Screen[i] = ToScreen(v4Corner[i]);
+	}
+
+	++m_uOccluderCount;
+	//a mirroring model matrix turns the faces inside out
+	bool bMirrored = glm::determinant(matrix3(a_m4ToWorld)) < 0.0f;
+	for (uint uFace = 0; uFace < 6; ++uFace)
+	{
+		uint uCorner[4] = { g_uBoxFace[uFace][0], g_uBoxFace[uFace][1], g_uBoxFace[uFace][2], g_uBoxFace[uFace][3] };
+		if (bMirrored)
+			std::swap(uCorner[1], uCorner[3]);
+		for (uint uTriangle = 0; uTriangle < 2; ++uTriangle)
+		{
+			uint uSecond = uCorner[uTriangle + 1];
+			uint uThird = uCorner[uTriangle + 2];
+			if (bClip)
+			{
+				vector4 v4Triangle[3] = { v4Corner[uCorner[0]], v4Corner[uSecond], v4Corner[uThird] };
+				ClipTriangle(v4Triangle);
+			}
+			else
+			{
+				vector3 v3Triangle[3] = { v3Screen[uCorner[0]], v3Screen[uSecond], v3Screen[uThird] };
+				RasterizeTriangle(v3Triangle);
+			}
+		}
+	}
+}
+vector3 MyOcclusionCuller::ToScreen(vector4 a_v4Clip)
+{
+	//depth is 1/w so it can be interpolated linearly on the screen
+	float fInverseW = 1.0f / a_v4Clip.w;
+	return vector3((a_v4Clip.x * fInverseW * 0.5f + 0.5f) * m_uWidth, (a_v4Clip.y * fInverseW * 0.5f + 0.5f) * m_uHeight, fInverseW);
+}
+void MyOcclusionCuller::ClipTriangle(vector4 a_v4Clip[3])
+{
+	//Sutherland-Hodgman, each plane can add a vertex to the polygon
+	vector4 v4Polygon[2][8];
+	uint uCount = 3;
+	uint uCurrent = 0;
+	for (uint i = 0; i < 3; ++i)
+		v4Polygon[0][i] = a_v4Clip[i];
+
+	for (uint uPlane = 0; uPlane < 5 && uCount > 0; ++uPlane)
+	{
+		vector4* pInput = v4Polygon[uCurrent];
+		vector4* pOutput = v4Polygon[1 - uCurrent];
+		uint uOutput = 0;
+		for (uint i = 0; i < uCount; ++i)
+		{
+			vector4& v4A = pInput[i];
+			vector4& v4B = pInput[(i + 1) % uCount];
+			float fA = GetPlaneDistance(v4A, uPlane);
+			float fB = GetPlaneDistance(v4B, uPlane);
+			if (fA >= 0.0f)
+				pOutput[uOutput++] = v4A;
+			if ((fA >= 0.0f) != (fB >= 0.0f))
+				pOutput[uOutput++] = v4A + (v4B - v4A) * (fA / (fA - fB));
+		}
+		uCount = uOutput;
+		uCurrent = 1 - uCurrent;
+	}
+	if (uCount < 3)
+		return;
+
+	vector3 v3Screen[8];
+	for (uint i = 0; i < uCount; ++i)
+		v3Screen[i] = ToScreen(v4Polygon[uCurrent][i]);
+	//the clipped polygon is convex, draw it as a fan
+	for (uint i = 1; i + 1 < uCount; ++i)
+	{
+		vector3 v3Triangle[3] = { v3Screen[0], v3Screen[i], v3Screen[i + 1] };
+		RasterizeTriangle(v3Triangle);
+	}
+}
+void MyOcclusionCuller::RasterizeTriangle(vector3 a_v3Screen[3])
+{
+	vector3& v3A = a_v3Screen[0];
+	vector3& v3B = a_v3Screen[1];
+	vector3& v3C = a_v3Screen[2];
+
+	//back faces and degenerate triangles are not drawn
+	float fArea = (v3B.x - v3A.x) * (v3C.y - v3A.y) - (v3B.y - v3A.y) * (v3C.x - v3A.x);
+	if (fArea <= 0.0f)
+		return;
+
+	//pixels touched, the first column is aligned to the four pixels drawn at once
+	int nMinX = std::max(static_cast<int>(std::floor(std::min(v3A.x, std::min(v3B.x, v3C.x)))), 0);
+	int nMaxX = std::min(static_cast<int>(std::ceil(std::max(v3A.x, std::max(v3B.x, v3C.x)))), static_cast<int>(m_uWidth) - 1);
+	int nMinY = std::max(static_cast<int>(std::floor(std::min(v3A.y, std::min(v3B.y, v3C.y)))), 0);
+	int nMaxY = std::min(static_cast<int>(std::ceil(std::max(v3A.y, std::max(v3B.y, v3C.y)))), static_cast<int>(m_uHeight) - 1);
+	if (nMinX > nMaxX || nMinY > nMaxY)
+		return;
+	nMinX &= ~3;
+	++m_uTriangleCount;
+
+	//edge functions, positive inside: edge i goes from vertex i + 1 to vertex i + 2 and weights vertex i
+	float fEdgeX[3], fEdgeY[3], fEdgeC[3];
+	for (uint i = 0; i < 3; ++i)
+	{
+		vector3& v3From = a_v3Screen[(i + 1) % 3];
+		vector3& v3To = a_v3Screen[(i + 2) % 3];
+		fEdgeX[i] = v3From.y - v3To.y;
+		fEdgeY[i] = v3To.x - v3From.x;
+		fEdgeC[i] = -(fEdgeX[i] * v3From.x + fEdgeY[i] * v3From.y);
+	}
+	//depth plane from the weights, moved back by the most it changes within half a pixel so the
+	//pixel never reports an occluder nearer than the one covering any part of it
+	float fInverseArea = 1.0f / fArea;
+	float fDepthX = (fEdgeX[0] * v3A.z + fEdgeX[1] * v3B.z + fEdgeX[2] * v3C.z) * fInverseArea;
+	float fDepthY = (fEdgeY[0] * v3A.z + fEdgeY[1] * v3B.z + fEdgeY[2] * v3C.z) * fInverseArea;
+	float fDepthC = (fEdgeC[0] * v3A.z + fEdgeC[1] * v3B.z + fEdgeC[2] * v3C.z) * fInverseArea;
+	fDepthC -= 0.5f * (std::abs(fDepthX) + std::abs(fDepthY));
+
+	const __m128 v4Zero = _mm_setzero_ps();
+	const __m128 v4Column = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f); //pixel centers of the four columns
+	__m128 v4EdgeX[3], v4EdgeStep[3];
+	for (uint i = 0; i < 3; ++i)
+	{
+		v4EdgeX[i] = _mm_set1_ps(fEdgeX[i]);
+		v4EdgeStep[i] = _mm_set1_ps(fEdgeX[i] * 4.0f);
+	}
+	const __m128 v4DepthX = _mm_set1_ps(fDepthX);
+	const __m128 v4DepthStep = _mm_set1_ps(fDepthX * 4.0f);
+
+	std::vector<float>& depthList = m_Level[0].DepthList;
+	for (int nY = nMinY; nY <= nMaxY; ++nY)
+	{
+		float fY = nY + 0.5f;
+		__m128 v4X = _mm_add_ps(_mm_set1_ps(static_cast<float>(nMinX)), v4Column);
+		__m128 v4Edge[3];
+		for (uint i = 0; i < 3; ++i)
+			v4Edge[i] = _mm_add_ps(_mm_mul_ps(v4EdgeX[i], v4X), _mm_set1_ps(fEdgeY[i] * fY + fEdgeC[i]));
+		__m128 v4Depth = _mm_add_ps(_mm_mul_ps(v4DepthX, v4X), _mm_set1_ps(fDepthY * fY + fDepthC));
+
+		float* pRow = &depthList[nY * m_uWidth];
+		for (int nX = nMinX; nX <= nMaxX; nX += 4)
+		{
+			__m128 v4Inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(v4Edge[0], v4Zero), _mm_cmpge_ps(v4Edge[1], v4Zero)),
+				_mm_cmpge_ps(v4Edge[2], v4Zero));
+			if (_mm_movemask_ps(v4Inside) != 0)
+			{
+				//the buffer is never below 0, so the pixels outside can be written as 0 and keep their depth
+				__m128 v4Old = _mm_loadu_ps(pRow + nX);
+				_mm_storeu_ps(pRow + nX, _mm_max_ps(v4Old, _mm_and_ps(v4Inside, v4Depth)));
+			}
+			for (uint i = 0; i < 3; ++i)
+				v4Edge[i] = _mm_add_ps(v4Edge[i], v4EdgeStep[i]);
+			v4Depth = _mm_add_ps(v4Depth, v4DepthStep);
+		}
+	}
+	m_bEmpty = false;
+	m_bPyramidDirty = true;
+}
+void MyOcclusionCuller::BuildPyramid(void)
+{
+	m_bPyramidDirty = false;
+	for (uint uLevel = 1; uLevel < m_uLevelCount; ++uLevel)
+	{
+		MyLevel& source = m_Level[uLevel - 1];
+		MyLevel& target = m_Level[uLevel];
+		float* pSource = source.DepthList.data();
+		float* pTarget = target.DepthList.data();
+		for (uint uY = 0; uY < target.uHeight; ++uY)
+		{
+			float* pRow0 = pSource + (uY * 2) * source.uWidth;
+			float* pRow1 = pSource + std::min(uY * 2 + 1, source.uHeight - 1) * source.uWidth;
+			float* pOut = pTarget + uY * target.uWidth;
+			uint uX = 0;
+			//eight source texels into four, the columns are paired up after the rows
+			if (source.uWidth == target.uWidth * 2)
+			{
+				for (; uX + 4 <= target.uWidth; uX += 4)
+				{
+					__m128 v4Left = _mm_min_ps(_mm_loadu_ps(pRow0 + uX * 2), _mm_loadu_ps(pRow1 + uX * 2));
+					__m128 v4Right = _mm_min_ps(_mm_loadu_ps(pRow0 + uX * 2 + 4), _mm_loadu_ps(pRow1 + uX * 2 + 4));
+					__m128 v4Even = _mm_shuffle_ps(v4Left, v4Right, _MM_SHUFFLE(2, 0, 2, 0));
+					__m128 v4Odd = _mm_shuffle_ps(v4Left, v4Right, _MM_SHUFFLE(3, 1, 3, 1));
+					_mm_storeu_ps(pOut + uX, _mm_min_ps(v4Even, v4Odd));
+				}
+			}
+			for (; uX < target.uWidth; ++uX)
+			{
+				uint uX0 = uX * 2;
+				uint uX1 = std::min(uX0 + 1, source.uWidth - 1);
+				pOut[uX] = std::min(std::min(pRow0[uX0], pRow0[uX1]), std::min(pRow1[uX0], pRow1[uX1]));
+			}
+		}
+	}
+}
+bool MyOcclusionCuller::IsVisible(vector3 a_v3Min, vector3 a_v3Max)
+{
+	++m_uTestCount;
+	if (m_bEmpty)
+		return true;
+	if (m_bPyramidDirty)
+		BuildPyramid();
+
+	//screen rectangle and nearest depth of the box
+	float fMinX = FLT_MAX, fMinY = FLT_MAX, fMaxX = -FLT_MAX, fMaxY = -FLT_MAX;
+	float fNearest = 0.0f;
+	for (uint i = 0; i < 8; ++i)
+	{
+		vector4 v4Clip = m_m4ViewProjection * vector4(GetCorner(a_v3Min, a_v3Max, i), 1.0f);
+		//the box reaches the camera, nothing can be in front of all of it
+		if (v4Clip.w < g_fNearW)
+			return true;
+		vector3 v3Screen = ToScreen(v4Clip);
+		fMinX = std::min(fMinX, v3Screen.x);
+		fMaxX = std::max(fMaxX, v3Screen.x);
+		fMinY = std::min(fMinY, v3Screen.y);
+		fMaxY = std::max(fMaxY, v3Screen.y);
+		fNearest = std::max(fNearest, v3Screen.z);
+	}
+	//off the screen, that is for the renderer to decide
+	if (fMaxX < 0.0f || fMaxY < 0.0f || fMinX >= m_uWidth || fMinY >= m_uHeight)
+		return true;
+	//the occluders are sampled at the pixel centers, a box past an occluder edge by less than half
+	//a pixel would only touch pixels that report it covered, so it is grown to reach the next ones
+	fMinX -= 0.5f;
+	fMaxX += 0.5f;
+	fMinY -= 0.5f;
+	fMaxY += 0.5f;
+	uint uMinX = static_cast<uint>(std::max(fMinX, 0.0f));
+	uint uMaxX = static_cast<uint>(std::min(fMaxX, m_uWidth - 1.0f));
+	uint uMinY = static_cast<uint>(std::max(fMinY, 0.0f));
+	uint uMaxY = static_cast<uint>(std::min(fMaxY, m_uHeight - 1.0f));
+
+	//coarsest level where the rectangle spans at most two texels on each side
+	uint uLevel = 0;
+	while (uLevel + 1 < m_uLevelCount && ((uMaxX >> uLevel) - (uMinX >> uLevel) > 1 || (uMaxY >> uLevel) - (uMinY >> uLevel) > 1))
+		++uLevel;
+
+	MyLevel& level = m_Level[uLevel];
+	for (uint uY = uMinY >> uLevel; uY <= (uMaxY >> uLevel); ++uY)
+	{
+		for (uint uX = uMinX >> uLevel; uX <= (uMaxX >> uLevel); ++uX)
+		{
+			//some occluder of the texel is not nearer than the box
+			if (level.DepthList[uY * level.uWidth + uX] <= fNearest)
+				return true;
+		}
+	}
+	++m_uOccludedCount;
+	return false;
+}
@@ -0,0 +1,162 @@
+/*----------------------------------------------
+Programmer: Alberto Bobadilla (labigm@gmail.com)
+Date: 2017/07
+----------------------------------------------*/
+#ifndef __MYOCCLUSIONCULLER_H_
+#define __MYOCCLUSIONCULLER_H_
+
+#ifdef SIMPLEX_HEADLESS
+#include "HeadlessDefinitions.h"
+#else
+#include "Simplex\Simplex.h"
+#endif
+
+namespace Simplex
+{
+
+//Software occlusion culler, the occluders chosen by the application are rasterized on the CPU into a small depth
+//buffer and boxes are tested against a pyramid built from it, so entities hidden behind them are never submitted.
+//Depth is stored as 1/w, nearer is larger and the buffer clears to 0 (infinitely far), which makes every texel of
+//the pyramid the minimum of the ones below it: the farthest occluder depth of the area it covers
+class MyOcclusionCuller
+{
+public:
+	static const uint m_uWidth = 256; //columns of the depth buffer, multiple of 4
+	static const uint m_uHeight = 128; //rows of the depth buffer
+	static const uint m_uLevelMax = 9; //levels of the pyramid, enough to get down to a single texel
+
+private:
+	struct MyLevel
+	{
+		uint uWidth = 0; //columns of this level
+		uint uHeight = 0; //rows of this level
+		std::vector<float> DepthList; //depth of each texel, row major
+	};
+
+	MyLevel m_Level[m_uLevelMax]; //level 0 is the depth buffer, each one after it has half the resolution
+	uint m_uLevelCount = 0; //levels in use
+	matrix4 m_m4ViewProjection = IDENTITY_M4; //world to clip space of the current frame
+	bool m_bEmpty = true; //no occluder was rasterized this frame, everything is visible
+	bool m_bPyramidDirty = false; //occluders were rasterized after the pyramid was built
+
+	uint m_uOccluderCount = 0; //occluders rasterized this frame
+	uint m_uTriangleCount = 0; //triangles that reached the rasterizer this frame
+	uint m_uTestCount = 0; //boxes tested this frame
+	uint m_uOccludedCount = 0; //boxes found occluded this frame
+
+public:
+	/*
+	Usage: Constructor, allocates the depth buffer and the pyramid
+	Arguments: ---
+	Output: class object instance
+	*/
+	MyOcclusionCuller(void);
+	/*
+	Usage: Copy Constructor
+	Arguments: class object to copy
+	Output: class object instance
+	*/
+	MyOcclusionCuller(MyOcclusionCuller const& other);
+	/*
+	Usage: Copy Assignment Operator
+	Arguments: class object to copy
+	Output: ---
+	*/
+	MyOcclusionCuller& operator=(MyOcclusionCuller const& other);
+	/*
+	Usage: Destructor
+	Arguments: ---
+	Output: ---
+	*/
+	~MyOcclusionCuller(void);
+	/*
+	USAGE: Starts a new frame, clears the depth buffer and the counters
+	ARGUMENTS: matrix4 a_m4ViewProjection -> projection * view of the camera the frame is rendered with
+	OUTPUT: ---
+	*/
+	void BeginFrame(matrix4 a_m4ViewProjection);
+	/*
+	USAGE: Rasterizes the front faces of a box into the depth buffer, only boxes the object fills completely
+	(walls, floors, crates) should be used or things behind the gaps will be culled
+	ARGUMENTS:
+	-	matrix4 a_m4ToWorld -> model matrix of the box
+	-	vector3 a_v3Min -> minimum corner in local space
+	-	vector3 a_v3Max -> maximum corner in local space
+	OUTPUT: ---
+	*/
+	void AddOccluder(matrix4 a_m4ToWorld, vector3 a_v3Min, vector3 a_v3Max);
+	/*
+	USAGE: Builds the pyramid from the depth buffer, call once after the last occluder, IsVisible calls it
+	if it was not
+	ARGUMENTS: ---
+	OUTPUT: ---
+	*/
+	void BuildPyramid(void);
+	/*
+	USAGE: Tests a world space axis aligned box against the occluders of the frame
+	ARGUMENTS:
+	-	vector3 a_v3Min -> minimum corner
+	-	vector3 a_v3Max -> maximum corner
+	OUTPUT: false only if the box is completely behind the occluders, boxes that cross the near plane or are
+	completely off the screen are visible, the ones partly off it are tested with the part that is on it
+	*/
+	bool IsVisible(vector3 a_v3Min, vector3 a_v3Max);
+	/*
+	USAGE: Gets the depth of a texel of the pyramid, for debugging
+	ARGUMENTS:
+	-	uint a_uLevel -> level, 0 is the depth buffer
+	-	uint a_uX -> column
+	-	uint a_uY -> row, 0 is the bottom of the screen
+	OUTPUT: 1/w of the texel, 0 if nothing was drawn on it or it is out of range
+	*/
+	float GetDepth(uint a_uLevel, uint a_uX, uint a_uY);
+	/*
+	USAGE: Gets the number of occluders rasterized on this frame
+	ARGUMENTS: ---
+	OUTPUT: occluder count
+	*/
+	uint GetOccluderCount(void);
+	/*
+	USAGE: Gets the number of triangles that reached the rasterizer on this frame, back faces and the ones
+	off the screen are not counted
+	ARGUMENTS: ---
+	OUTPUT: triangle count
+	*/
+	uint GetTriangleCount(void);
+	/*
+	USAGE: Gets the number of boxes tested on this frame
+	ARGUMENTS: ---
+	OUTPUT: test count
+	*/
+	uint GetTestCount(void);
+	/*
+	USAGE: Gets the number of boxes found occluded on this frame
+	ARGUMENTS: ---
+	OUTPUT: occluded count
+	*/
+	uint GetOccludedCount(void);
+
+private:
+	/*
+	USAGE: Clips a triangle against the near plane and a guard band around the screen and rasterizes what is left
+	ARGUMENTS: vector4 a_v4Clip[3] -> vertices in clip space, counter clockwise seen from the front
+	OUTPUT: ---
+	*/
+	void ClipTriangle(vector4 a_v4Clip[3]);
+	/*
+	USAGE: Projects a clip space vertex to the depth buffer
+	ARGUMENTS: vector4 a_v4Clip -> vertex in clip space, in front of the near plane
+	OUTPUT: pixel coordinates and 1/w
+	*/
+	vector3 ToScreen(vector4 a_v4Clip);
+	/*
+	USAGE: Rasterizes a triangle four pixels at a time, keeping the nearest depth of each pixel
+	ARGUMENTS: vector3 a_v3Screen[3] -> pixel coordinates and 1/w of the vertices, counter clockwise
+	OUTPUT: ---
+	*/
+	void RasterizeTriangle(vector3 a_v3Screen[3]);
+};//class
+
+} //namespace Simplex
+
+#endif //__MYOCCLUSIONCULLER_H_
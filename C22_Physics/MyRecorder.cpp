@@ -0,0 +1,144 @@
+#include "MyRecorder.h"
+using namespace Simplex;
+//  MyRecorder
+MyRecorder::MyRecorder(void) { }
+MyRecorder::MyRecorder(MyRecorder const& other) { }
+MyRecorder& MyRecorder::operator=(MyRecorder const& other) { return *this; }
+MyRecorder::~MyRecorder(void) { Close(); }
+
+bool MyRecorder::Open(String a_sFileName)
+{
+	Close();
+	m_File.open(a_sFileName, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!m_File.is_open())
+		return false;
+
+	Write(m_uMagic);
+	Write(m_uVersion);
+	m_uFrameCount = 0;
+	return true;
+}
+void MyRecorder::Close(void)
+{
+	if (m_File.is_open())
+		m_File.close();
+}
+bool MyRecorder::IsOpen(void) { return m_File.is_open(); }
+uint MyRecorder::GetFrameCount(void) { return m_uFrameCount; }
+
+void MyRecorder::WriteString(String a_sValue)
+{
+	Write(static_cast<uint>(a_sValue.size()));
+	m_File.write(a_sValue.data(), a_sValue.size());
+}
+void MyRecorder::WriteType(eRecordType a_Type) { Write(static_cast<unsigned char>(a_Type)); }
+
+void MyRecorder::RecordAddEntity(String a_sFileName, String a_sUniqueID)
+{
+	WriteType(RECORD_ADD_ENTITY);
+	WriteString(a_sFileName);
+	WriteString(a_sUniqueID);
+}
+void MyRecorder::RecordAddEntity(std::vector<vector3> const& a_VertexList, String a_sUniqueID)
+{
+	//the box around the vertices generates the same rigid body as all of them
+	vector3 v3Min = a_VertexList.empty() ? ZERO_V3 : a_VertexList[0];
+	vector3 v3Max = v3Min;
+	for (uint i = 1; i < a_VertexList.size(); i++)
+	{
+		v3Min = glm::min(v3Min, a_VertexList[i]);
+		v3Max = glm::max(v3Max, a_VertexList[i]);
+	}
+
+	WriteType(RECORD_ADD_SHAPE);
+	//an empty list fails to generate the entity, keep it failing on replay
+	Write(static_cast<unsigned char>(a_VertexList.empty() ? 0 : 1));
+	Write(v3Min);
+	Write(v3Max);
+	WriteString(a_sUniqueID);
+}
+void MyRecorder::RecordRemoveEntity(uint a_uIndex)
+{
+	WriteType(RECORD_REMOVE_ENTITY);
+	Write(a_uIndex);
+}
+void MyRecorder::RecordRemoveEntities(std::vector<uint> const& a_IndexList)
+{
+	WriteType(RECORD_REMOVE_ENTITIES);
+	Write(static_cast<uint>(a_IndexList.size()));
+	for (uint i = 0; i < a_IndexList.size(); i++)
+	{
+		Write(a_IndexList[i]);
+	}
+}
+void MyRecorder::RecordModelMatrix(uint a_uIndex, matrix4 a_m4ToWorld)
+{
+	WriteType(RECORD_MODEL_MATRIX);
+	Write(a_uIndex);
+	Write(a_m4ToWorld);
+}
+void MyRecorder::RecordForce(uint a_uIndex, vector3 a_v3Force)
+{
+	WriteType(RECORD_FORCE);
+	Write(a_uIndex);
+	Write(a_v3Force);
+}
+void MyRecorder::RecordPosition(uint a_uIndex, vector3 a_v3Position)
+{
+	WriteType(RECORD_POSITION);
+	Write(a_uIndex);
+	Write(a_v3Position);
+}
+void MyRecorder::RecordMass(uint a_uIndex, float a_fMass)
+{
+	WriteType(RECORD_MASS);
+	Write(a_uIndex);
+	Write(a_fMass);
+}
+void MyRecorder::RecordPhysicsSolver(uint a_uIndex, bool a_bUse)
+{
+	WriteType(RECORD_PHYSICS_SOLVER);
+	Write(a_uIndex);
+	Write(static_cast<unsigned char>(a_bUse ? 1 : 0));
+}
+void MyRecorder::RecordContinuous(uint a_uIndex, bool a_bUse)
+{
+	WriteType(RECORD_CONTINUOUS);
+	Write(a_uIndex);
+	Write(static_cast<unsigned char>(a_bUse ? 1 : 0));
+}
+void MyRecorder::RecordParent(uint a_uIndex, int a_nParent)
+{
+	WriteType(RECORD_PARENT);
+	Write(a_uIndex);
+	Write(a_nParent);
+}
+void MyRecorder::RecordLocalTransform(uint a_uIndex, vector3 a_v3Position, quaternion a_qOrientation, vector3 a_v3Scale)
+{
+	WriteType(RECORD_LOCAL_TRANSFORM);
+	Write(a_uIndex);
+	Write(a_v3Position);
+	Write(a_qOrientation);
+	Write(a_v3Scale);
+}
+void MyRecorder::RecordFixedTimeStep(float a_fTimeStep)
+{
+	WriteType(RECORD_FIXED_TIME_STEP);
+	Write(a_fTimeStep);
+}
+void MyRecorder::RecordMaxSubsteps(uint a_uMaxSubsteps)
+{
+	WriteType(RECORD_MAX_SUBSTEPS);
+	Write(a_uMaxSubsteps);
+}
+void MyRecorder::RecordUpdate(float a_fDeltaTime)
+{
+	WriteType(RECORD_UPDATE);
+	Write(a_fDeltaTime);
+	++m_uFrameCount;
+}
+void MyRecorder::RecordStep(void)
+{
+	WriteType(RECORD_STEP);
+	++m_uFrameCount;
+}
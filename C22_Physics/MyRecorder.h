@@ -0,0 +1,244 @@
+/*----------------------------------------------
+Programmer: Alberto Bobadilla (labigm@gmail.com)
+Date: 2017/07
+----------------------------------------------*/
+#ifndef __MYRECORDER_H_
+#define __MYRECORDER_H_
+
+#include "MySolver.h"
+
+namespace Simplex
+{
+
+//Type of each entry of a simulation log, stored as a single byte before the data of the entry
+enum eRecordType
+{
+	RECORD_ADD_ENTITY = 1, //file name, unique id
+	RECORD_ADD_SHAPE, //min and max of the vertices, unique id
+	RECORD_REMOVE_ENTITY, //entity index
+	RECORD_MODEL_MATRIX, //entity index, matrix
+	RECORD_FORCE, //entity index, force
+	RECORD_POSITION, //entity index, position
+	RECORD_MASS, //entity index, mass
+	RECORD_PHYSICS_SOLVER, //entity index, flag
+	RECORD_CONTINUOUS, //entity index, flag
+	RECORD_FIXED_TIME_STEP, //time step
+	RECORD_MAX_SUBSTEPS, //maximum substeps
+	RECORD_UPDATE, //delta time, ends a frame
+	RECORD_STEP, //single fixed step, ends a frame
+	RECORD_REMOVE_ENTITIES, //count, entity indices
+	RECORD_PARENT, //child index, parent index or -1
+	RECORD_LOCAL_TRANSFORM //entity index, position, orientation, scale
+};
+
+//Writes everything that changes the simulation of the entity manager to a binary log, so the same run can be
+//replayed by MyReplayer with the same results, entities are referenced by their index in the manager
+class MyRecorder
+{
+	std::ofstream m_File; //log being written
+	uint m_uFrameCount = 0; //frames recorded so far
+public:
+	static const uint m_uMagic = 0x43525853; //"SXRC" at the start of every log
+	//version of the log format, raised every time it gains record types so older replayers refuse the log:
+	//1 up to RECORD_STEP, 2 added RECORD_REMOVE_ENTITIES, 3 added RECORD_PARENT and RECORD_LOCAL_TRANSFORM
+	static const uint m_uVersion = 3;
+
+	/*
+	USAGE: Constructor
+	ARGUMENTS: ---
+	OUTPUT: object instance
+	*/
+	MyRecorder(void);
+	/*
+	USAGE: Destructor, closes the log
+	ARGUMENTS: ---
+	OUTPUT: ---
+	*/
+	~MyRecorder(void);
+	/*
+	USAGE: Creates the log, overwriting it if it exists
+	ARGUMENTS: String a_sFileName -> path of the log
+	OUTPUT: was it created?
+	*/
+	bool Open(String a_sFileName);
+	/*
+	USAGE: Closes the log
+	ARGUMENTS: ---
+	OUTPUT: ---
+	*/
+	void Close(void);
+	/*
+	USAGE: Asks if the log is open
+	ARGUMENTS: ---
+	OUTPUT: open?
+	*/
+	bool IsOpen(void);
+	/*
+	USAGE: Gets the number of frames recorded so far
+	ARGUMENTS: ---
+	OUTPUT: frame count
+	*/
+	uint GetFrameCount(void);
+
+	/*
+	USAGE: Records an entity loaded from a model
+	ARGUMENTS:
+	-	String a_sFileName -> Name of the model
+	-	String a_sUniqueID -> Name asked as identifier
+	OUTPUT: ---
+	*/
+	void RecordAddEntity(String a_sFileName, String a_sUniqueID);
+	/*
+	USAGE: Records an entity generated from a vertex list, only the box around the vertices is stored
+	as that is all the rigid body keeps of them
+	ARGUMENTS:
+	-	std::vector<vector3> const& a_VertexList -> vertices of the collision shape
+	-	String a_sUniqueID -> Name asked as identifier
+	OUTPUT: ---
+	*/
+	void RecordAddEntity(std::vector<vector3> const& a_VertexList, String a_sUniqueID);
+	/*
+	USAGE: Records the removal of an entity
+	ARGUMENTS: uint a_uIndex -> index of the entity
+	OUTPUT: ---
+	*/
+	void RecordRemoveEntity(uint a_uIndex);
+	/*
+	USAGE: Records the removal of several entities at once
+	ARGUMENTS: std::vector<uint> const& a_IndexList -> indices of the entities
+	OUTPUT: ---
+	*/
+	void RecordRemoveEntities(std::vector<uint> const& a_IndexList);
+	/*
+	USAGE: Records a model matrix set on an entity
+	ARGUMENTS:
+	-	uint a_uIndex -> index of the entity
+	-	matrix4 a_m4ToWorld -> model matrix
+	OUTPUT: ---
+	*/
+	void RecordModelMatrix(uint a_uIndex, matrix4 a_m4ToWorld);
+	/*
+	USAGE: Records a force applied to an entity
+	ARGUMENTS:
+	-	uint a_uIndex -> index of the entity
+	-	vector3 a_v3Force -> force
+	OUTPUT: ---
+	*/
+	void RecordForce(uint a_uIndex, vector3 a_v3Force);
+	/*
+	USAGE: Records a position set on an entity
+	ARGUMENTS:
+	-	uint a_uIndex -> index of the entity
+	-	vector3 a_v3Position -> position
+	OUTPUT: ---
+	*/
+	void RecordPosition(uint a_uIndex, vector3 a_v3Position);
+	/*
+	USAGE: Records a mass set on an entity
+	ARGUMENTS:
+	-	uint a_uIndex -> index of the entity
+	-	float a_fMass -> mass
+	OUTPUT: ---
+	*/
+	void RecordMass(uint a_uIndex, float a_fMass);
+	/*
+	USAGE: Records an entity starting or stopping to use the physics solver
+	ARGUMENTS:
+	-	uint a_uIndex -> index of the entity
+	-	bool a_bUse -> using the solver?
+	OUTPUT: ---
+	*/
+	void RecordPhysicsSolver(uint a_uIndex, bool a_bUse);
+	/*
+	USAGE: Records an entity starting or stopping to use continuous collision detection
+	ARGUMENTS:
+	-	uint a_uIndex -> index of the entity
+	-	bool a_bUse -> using continuous collision detection?
+	OUTPUT: ---
+	*/
+	void RecordContinuous(uint a_uIndex, bool a_bUse);
+	/*
+	USAGE: Records an entity attached to a parent or detached from it
+	ARGUMENTS:
+	-	uint a_uIndex -> index of the child entity
+	-	int a_nParent -> index of the parent entity, -1 to detach it
+	OUTPUT: ---
+	*/
+	void RecordParent(uint a_uIndex, int a_nParent);
+	/*
+	USAGE: Records a local transform set on an entity
+	ARGUMENTS:
+	-	uint a_uIndex -> index of the entity
+	-	vector3 a_v3Position -> position relative to the parent
+	-	quaternion a_qOrientation -> orientation relative to the parent
+	-	vector3 a_v3Scale -> scale relative to the parent
+	OUTPUT: ---
+	*/
+	void RecordLocalTransform(uint a_uIndex, vector3 a_v3Position, quaternion a_qOrientation, vector3 a_v3Scale);
+	/*
+	USAGE: Records a change of the time simulated on each physics step
+	ARGUMENTS: float a_fTimeStep -> time in seconds
+	OUTPUT: ---
+	*/
+	void RecordFixedTimeStep(float a_fTimeStep);
+	/*
+	USAGE: Records a change of the maximum number of physics steps per update
+	ARGUMENTS: uint a_uMaxSubsteps -> maximum steps
+	OUTPUT: ---
+	*/
+	void RecordMaxSubsteps(uint a_uMaxSubsteps);
+	/*
+	USAGE: Records an update of the entity manager, ends the frame
+	ARGUMENTS: float a_fDeltaTime -> time in seconds since the last update
+	OUTPUT: ---
+	*/
+	void RecordUpdate(float a_fDeltaTime);
+	/*
+	USAGE: Records a single fixed step of the entity manager, ends the frame
+	ARGUMENTS: ---
+	OUTPUT: ---
+	*/
+	void RecordStep(void);
+
+private:
+	/*
+	USAGE: Copy Constructor, a log has a single writer
+	ARGUMENTS: object to copy
+	OUTPUT: object instance
+	*/
+	MyRecorder(MyRecorder const& other);
+	/*
+	USAGE: Copy Assignment Operator, a log has a single writer
+	ARGUMENTS: object to copy
+	OUTPUT: this instance
+	*/
+	MyRecorder& operator=(MyRecorder const& other);
+	/*
+	USAGE: Writes the raw bytes of a value
+	ARGUMENTS: T a_Value -> value to write
+	OUTPUT: ---
+	*/
+	template <class T> void Write(T a_Value) { m_File.write(reinterpret_cast<const char*>(&a_Value), sizeof(T)); }
+	/*
+	USAGE: Writes a string as its length followed by its characters
+	ARGUMENTS: String a_sValue -> string to write
+	OUTPUT: ---
+	*/
+	void WriteString(String a_sValue);
+	/*
+	USAGE: Writes the type of an entry
+	ARGUMENTS: eRecordType a_Type -> type of the entry
+	OUTPUT: ---
+	*/
+	void WriteType(eRecordType a_Type);
+};
+
+} //namespace Simplex
+
+#endif //__MYRECORDER_H_
+
+/*
+USAGE:
+ARGUMENTS: ---
+OUTPUT: ---
+*/
@@ -0,0 +1,228 @@
+#include "MyReplayer.h"
+using namespace Simplex;
+//  MyReplayer
+MyReplayer::MyReplayer(void) { }
+MyReplayer::MyReplayer(MyReplayer const& other) { }
+MyReplayer& MyReplayer::operator=(MyReplayer const& other) { return *this; }
+MyReplayer::~MyReplayer(void) { }
+
+bool MyReplayer::Load(String a_sFileName)
+{
+	m_bValid = false;
+	m_Data.clear();
+	m_uCursor = 0;
+
+	std::ifstream file(a_sFileName, std::ios::in | std::ios::binary);
+	if (!file.is_open())
+		return false;
+	m_Data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+	uint uMagic = 0;
+	uint uVersion = 0;
+	if (!Read(uMagic) || !Read(uVersion))
+		return false;
+	//every version only adds record types, so older logs still read
+	m_bValid = uMagic == MyRecorder::m_uMagic && uVersion >= 1 && uVersion <= MyRecorder::m_uVersion;
+	return m_bValid;
+}
+bool MyReplayer::ReadString(String& a_sValue)
+{
+	uint uLength = 0;
+	if (!Read(uLength) || m_uCursor + uLength > m_Data.size())
+		return false;
+	a_sValue.assign(&m_Data[0] + m_uCursor, uLength);
+	m_uCursor += uLength;
+	return true;
+}
+bool MyReplayer::Replay(MyEntityManager* a_pEntityMngr)
+{
+	m_FrameList.clear();
+	m_uChecksum = 0;
+	if (!m_bValid || !a_pEntityMngr)
+		return false;
+
+	typedef std::chrono::high_resolution_clock Clock;
+	//skip the header
+	m_uCursor = sizeof(uint) * 2;
+	bool bComplete = true;
+	while (m_uCursor < m_Data.size() && bComplete)
+	{
+		unsigned char uType = 0;
+		uint uIndex = 0;
+		unsigned char uFlag = 0;
+		String sName, sID;
+		vector3 v3Value, v3Max;
+		matrix4 m4Value;
+		float fValue = 0.0f;
+		Read(uType);
+		switch (uType)
+		{
+		case RECORD_ADD_ENTITY:
+			bComplete = ReadString(sName) && ReadString(sID);
+			if (bComplete)
+				a_pEntityMngr->AddEntity(sName, sID);
+			break;
+		case RECORD_ADD_SHAPE:
+			bComplete = Read(uFlag) && Read(v3Value) && Read(v3Max) && ReadString(sID);
+			if (bComplete)
+			{
+				std::vector<vector3> box;
+				if (uFlag)
+					box = { v3Value, v3Max };
+				a_pEntityMngr->AddEntity(box, sID);
+			}
+			break;
+		case RECORD_REMOVE_ENTITY:
+			bComplete = Read(uIndex);
+			if (bComplete)
+				a_pEntityMngr->RemoveEntity(uIndex);
+			break;
+		case RECORD_REMOVE_ENTITIES:
+		{
+			bComplete = Read(uIndex);
+			std::vector<uint> indexList;
+			for (uint i = 0; i < uIndex && bComplete; i++)
+			{
+				uint uEntity = 0;
+				bComplete = Read(uEntity);
+				indexList.push_back(uEntity);
+			}
+			if (bComplete)
+				a_pEntityMngr->RemoveEntities(indexList);
+			break;
+		}
+		case RECORD_MODEL_MATRIX:
+			bComplete = Read(uIndex) && Read(m4Value);
+			if (bComplete)
+				a_pEntityMngr->SetModelMatrix(m4Value, uIndex);
+			break;
+		case RECORD_FORCE:
+			bComplete = Read(uIndex) && Read(v3Value);
+			if (bComplete)
+				a_pEntityMngr->ApplyForce(v3Value, uIndex);
+			break;
+		case RECORD_POSITION:
+			bComplete = Read(uIndex) && Read(v3Value);
+			if (bComplete)
+				a_pEntityMngr->SetPosition(v3Value, uIndex);
+			break;
+		case RECORD_MASS:
+			bComplete = Read(uIndex) && Read(fValue);
+			if (bComplete)
+				a_pEntityMngr->SetMass(fValue, uIndex);
+			break;
+		case RECORD_PHYSICS_SOLVER:
+			bComplete = Read(uIndex) && Read(uFlag);
+			if (bComplete)
+				a_pEntityMngr->UsePhysicsSolver(uFlag != 0, uIndex);
+			break;
+		case RECORD_CONTINUOUS:
+			bComplete = Read(uIndex) && Read(uFlag);
+			if (bComplete)
+				a_pEntityMngr->UseContinuousCollision(uFlag != 0, uIndex);
+			break;
+		case RECORD_PARENT:
+		{
+			int nParent = -1;
+			bComplete = Read(uIndex) && Read(nParent);
+			if (bComplete)
+			{
+				MyEntityHandle hParent = nParent < 0 ? MyEntityHandle() : a_pEntityMngr->GetHandle(static_cast<uint>(nParent));
+				a_pEntityMngr->SetParent(a_pEntityMngr->GetHandle(uIndex), hParent);
+			}
+			break;
+		}
+		case RECORD_LOCAL_TRANSFORM:
+		{
+			quaternion qValue;
+			bComplete = Read(uIndex) && Read(v3Value) && Read(qValue) && Read(v3Max);
+			if (bComplete)
+				a_pEntityMngr->SetLocalTransform(v3Value, qValue, v3Max, a_pEntityMngr->GetHandle(uIndex));
+			break;
+		}
+		case RECORD_FIXED_TIME_STEP:
+			bComplete = Read(fValue);
+			if (bComplete)
+				a_pEntityMngr->SetFixedTimeStep(fValue);
+			break;
+		case RECORD_MAX_SUBSTEPS:
+			bComplete = Read(uIndex);
+			if (bComplete)
+				a_pEntityMngr->SetMaxSubsteps(uIndex);
+			break;
+		case RECORD_UPDATE:
+		case RECORD_STEP:
+		{
+			bComplete = uType == RECORD_STEP || Read(fValue);
+			if (!bComplete)
+				break;
+
+			//a frame is an update or a single step, time it as a whole and by phase
+			Clock::time_point start = Clock::now();
+			if (uType == RECORD_UPDATE)
+				a_pEntityMngr->Update(fValue);
+			else
+				a_pEntityMngr->Step();
+			MyFrameTime frame;
+			frame.fTotal = std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+			frame.uSubsteps = uType == RECORD_UPDATE ? a_pEntityMngr->GetSubstepCount() : 1;
+			for (uint i = 0; i < PHASE_COUNT; i++)
+			{
+				frame.fPhase[i] = a_pEntityMngr->GetFramePhaseTime(i);
+			}
+			m_FrameList.push_back(frame);
+			break;
+		}
+		default:
+			//unknown entry, the rest of the log cannot be trusted
+			bComplete = false;
+			break;
+		}
+	}
+
+	m_uChecksum = ComputeChecksum(a_pEntityMngr);
+	return bComplete;
+}
+uint MyReplayer::ComputeChecksum(MyEntityManager* a_pEntityMngr)
+{
+	//FNV-1a over the bytes of every position
+	uint uHash = 2166136261u;
+	uint uCount = a_pEntityMngr->GetEntityCount();
+	for (uint i = 0; i < uCount; i++)
+	{
+		vector3 v3Position = a_pEntityMngr->GetEntity(i)->GetPosition();
+		const unsigned char* pByte = reinterpret_cast<const unsigned char*>(&v3Position);
+		for (uint j = 0; j < sizeof(vector3); j++)
+		{
+			uHash ^= pByte[j];
+			uHash *= 16777619u;
+		}
+	}
+	return uHash;
+}
+uint MyReplayer::GetFrameCount(void) { return static_cast<uint>(m_FrameList.size()); }
+MyFrameTime MyReplayer::GetFrameTime(uint a_uFrame)
+{
+	if (a_uFrame >= m_FrameList.size())
+		return MyFrameTime();
+	return m_FrameList[a_uFrame];
+}
+uint MyReplayer::GetChecksum(void) { return m_uChecksum; }
+bool MyReplayer::WriteFrameTimes(String a_sFileName)
+{
+	std::ofstream file(a_sFileName);
+	if (!file.is_open())
+		return false;
+
+	file << "frame,total_ms,substeps,detection_ms,forces_ms,contacts_ms,velocities_ms,entities_ms,continuous_ms\n";
+	for (uint i = 0; i < m_FrameList.size(); i++)
+	{
+		file << i << "," << m_FrameList[i].fTotal << "," << m_FrameList[i].uSubsteps;
+		for (uint j = 0; j < PHASE_COUNT; j++)
+		{
+			file << "," << m_FrameList[i].fPhase[j];
+		}
+		file << "\n";
+	}
+	return true;
+}
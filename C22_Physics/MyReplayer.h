@@ -0,0 +1,130 @@
+/*----------------------------------------------
+Programmer: Alberto Bobadilla (labigm@gmail.com)
+Date: 2017/07
+----------------------------------------------*/
+#ifndef __MYREPLAYER_H_
+#define __MYREPLAYER_H_
+
+#include "MyEntityManager.h"
+
+namespace Simplex
+{
+
+//Time a recorded frame took when replayed
+struct MyFrameTime
+{
+	float fTotal = 0.0f; //milliseconds of the whole update
+	uint uSubsteps = 0; //physics steps run on the update
+	float fPhase[PHASE_COUNT] = {}; //milliseconds of each phase over all the steps of the update
+};
+
+//Runs a log written by MyRecorder on an entity manager, making the same calls in the same order so the simulation
+//ends in the same state, and times every frame of it so runs can be compared for performance regressions
+class MyReplayer
+{
+	std::vector<char> m_Data; //contents of the log
+	uint m_uCursor = 0; //next byte to read
+	bool m_bValid = false; //was the log read and is its header right?
+	std::vector<MyFrameTime> m_FrameList; //time of each frame of the last replay
+	uint m_uChecksum = 0; //hash of the final state of the last replay
+public:
+	/*
+	USAGE: Constructor
+	ARGUMENTS: ---
+	OUTPUT: object instance
+	*/
+	MyReplayer(void);
+	/*
+	USAGE: Destructor
+	ARGUMENTS: ---
+	OUTPUT: ---
+	*/
+	~MyReplayer(void);
+	/*
+	USAGE: Reads a whole log into memory so reading it does not show in the timings
+	ARGUMENTS: String a_sFileName -> path of the log
+	OUTPUT: was it read and is it a log of a known version?
+	*/
+	bool Load(String a_sFileName);
+	/*
+	USAGE: Runs the loaded log on the manager, the manager and the solver should be empty so the
+	entities get the same indices they had when recorded
+	ARGUMENTS: MyEntityManager* a_pEntityMngr -> manager to drive
+	OUTPUT: did the whole log run? false if it was not loaded or is cut short
+	*/
+	bool Replay(MyEntityManager* a_pEntityMngr);
+	/*
+	USAGE: Gets the number of frames run on the last replay
+	ARGUMENTS: ---
+	OUTPUT: frame count
+	*/
+	uint GetFrameCount(void);
+	/*
+	USAGE: Gets the time a frame took on the last replay
+	ARGUMENTS: uint a_uFrame -> index of the frame
+	OUTPUT: frame time, empty if out of range
+	*/
+	MyFrameTime GetFrameTime(uint a_uFrame);
+	/*
+	USAGE: Gets a hash of the positions of the entities at the end of the last replay, the same log
+	gives the same hash as long as the simulation has not changed
+	ARGUMENTS: ---
+	OUTPUT: hash
+	*/
+	uint GetChecksum(void);
+	/*
+	USAGE: Writes the times of the last replay as comma separated values, one frame per line
+	ARGUMENTS: String a_sFileName -> path of the file
+	OUTPUT: was it written?
+	*/
+	bool WriteFrameTimes(String a_sFileName);
+
+private:
+	/*
+	USAGE: Copy Constructor, not needed
+	ARGUMENTS: object to copy
+	OUTPUT: object instance
+	*/
+	MyReplayer(MyReplayer const& other);
+	/*
+	USAGE: Copy Assignment Operator, not needed
+	ARGUMENTS: object to copy
+	OUTPUT: this instance
+	*/
+	MyReplayer& operator=(MyReplayer const& other);
+	/*
+	USAGE: Reads the raw bytes of a value
+	ARGUMENTS: T& a_Value -> read value
+	OUTPUT: was there enough data left?
+	*/
+	template <class T> bool Read(T& a_Value)
+	{
+		if (m_uCursor + sizeof(T) > m_Data.size())
+			return false;
+		memcpy(&a_Value, &m_Data[m_uCursor], sizeof(T));
+		m_uCursor += sizeof(T);
+		return true;
+	}
+	/*
+	USAGE: Reads a string written as its length followed by its characters
+	ARGUMENTS: String& a_sValue -> read string
+	OUTPUT: was there enough data left?
+	*/
+	bool ReadString(String& a_sValue);
+	/*
+	USAGE: Hashes the positions of the entities of the manager
+	ARGUMENTS: MyEntityManager* a_pEntityMngr -> manager to hash
+	OUTPUT: hash
+	*/
+	uint ComputeChecksum(MyEntityManager* a_pEntityMngr);
+};
+
+} //namespace Simplex
+
+#endif //__MYREPLAYER_H_
+
+/*
+USAGE:
+ARGUMENTS: ---
+OUTPUT: ---
+*/
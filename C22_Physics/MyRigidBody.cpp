@@ -3,25 +3,23 @@ using namespace Simplex;
 //Allocation
 void MyRigidBody::Init(void)
 {
+#ifndef SIMPLEX_HEADLESS
 	m_pMeshMngr = MeshManager::GetInstance();
+#endif
 	m_bVisibleBS = false;
 	m_bVisibleOBB = true;
 	m_bVisibleARBB = false;
 
-	m_fRadius = 0.0f;
+	m_pShape = nullptr;
 
 	m_v3ColorColliding = C_RED;
 	m_v3ColorNotColliding = C_WHITE;
 
-	m_v3CenterL = ZERO_V3;
 	m_v3CenterG = ZERO_V3;
-	m_v3MinL = ZERO_V3;
-	m_v3MaxL = ZERO_V3;
 
 	m_v3MinG = ZERO_V3;
 	m_v3MaxG = ZERO_V3;
 
-	m_v3HalfWidth = ZERO_V3;
 	m_v3ARBBSize = ZERO_V3;
 
 	m_m4ToWorld = IDENTITY_M4;
@@ -36,20 +34,16 @@ void MyRigidBody::Swap(MyRigidBody& other)
 	std::swap(m_bVisibleOBB, other.m_bVisibleOBB);
 	std::swap(m_bVisibleARBB, other.m_bVisibleARBB);
 
-	std::swap(m_fRadius, other.m_fRadius);
+	std::swap(m_pShape, other.m_pShape);
 
 	std::swap(m_v3ColorColliding, other.m_v3ColorColliding);
 	std::swap(m_v3ColorNotColliding, other.m_v3ColorNotColliding);
 
-	std::swap(m_v3CenterL, other.m_v3CenterL);
 	std::swap(m_v3CenterG, other.m_v3CenterG);
-	std::swap(m_v3MinL, other.m_v3MinL);
-	std::swap(m_v3MaxL, other.m_v3MaxL);
 
 	std::swap(m_v3MinG, other.m_v3MinG);
 	std::swap(m_v3MaxG, other.m_v3MaxG);
 
-	std::swap(m_v3HalfWidth, other.m_v3HalfWidth);
 	std::swap(m_v3ARBBSize, other.m_v3ARBBSize);
 
 	std::swap(m_m4ToWorld, other.m_m4ToWorld);
@@ -60,6 +54,7 @@ void MyRigidBody::Swap(MyRigidBody& other)
 void MyRigidBody::Release(void)
 {
 	m_pMeshMngr = nullptr;
+	m_pShape = nullptr;
 	ClearCollidingList();
 }
 //Accessors
@@ -69,18 +64,19 @@ bool MyRigidBody::GetVisibleOBB(void) { return m_bVisibleOBB; }
 void MyRigidBody::SetVisibleOBB(bool a_bVisible) { m_bVisibleOBB = a_bVisible; }
 bool MyRigidBody::GetVisibleARBB(void) { return m_bVisibleARBB; }
 void MyRigidBody::SetVisibleARBB(bool a_bVisible) { m_bVisibleARBB = a_bVisible; }
-float MyRigidBody::GetRadius(void) { return m_fRadius; }
+float MyRigidBody::GetRadius(void) { return m_pShape->fRadius; }
+PRigidBodyShape MyRigidBody::GetShape(void) { return m_pShape; }
 vector3 MyRigidBody::GetColorColliding(void) { return m_v3ColorColliding; }
 vector3 MyRigidBody::GetColorNotColliding(void) { return m_v3ColorNotColliding; }
 void MyRigidBody::SetColorColliding(vector3 a_v3Color) { m_v3ColorColliding = a_v3Color; }
 void MyRigidBody::SetColorNotColliding(vector3 a_v3Color) { m_v3ColorNotColliding = a_v3Color; }
-vector3 MyRigidBody::GetCenterLocal(void) { return m_v3CenterL; }
-vector3 MyRigidBody::GetMinLocal(void) { return m_v3MinL; }
-vector3 MyRigidBody::GetMaxLocal(void) { return m_v3MaxL; }
+vector3 MyRigidBody::GetCenterLocal(void) { return m_pShape->v3CenterL; }
+vector3 MyRigidBody::GetMinLocal(void) { return m_pShape->v3MinL; }
+vector3 MyRigidBody::GetMaxLocal(void) { return m_pShape->v3MaxL; }
 vector3 MyRigidBody::GetCenterGlobal(void){ return m_v3CenterG; }
 vector3 MyRigidBody::GetMinGlobal(void) { return m_v3MinG; }
 vector3 MyRigidBody::GetMaxGlobal(void) { return m_v3MaxG; }
-vector3 MyRigidBody::GetHalfWidth(void) { return m_v3HalfWidth; }
+vector3 MyRigidBody::GetHalfWidth(void) { return m_pShape->v3HalfWidth; }
 matrix4 MyRigidBody::GetModelMatrix(void) { return m_m4ToWorld; }
 MyRigidBody::PRigidBody* MyRigidBody::GetColliderArray(void) { return m_CollidingArray; }
 uint MyRigidBody::GetCollidingCount(void) { return m_uCollidingCount; }
@@ -93,21 +89,23 @@ void MyRigidBody::SetModelMatrix(matrix4 a_m4ModelMatrix)
 	//Assign the model matrix
 	m_m4ToWorld = a_m4ModelMatrix;
 
-	m_v3CenterG = vector3(m_m4ToWorld * vector4(m_v3CenterL, 1.0f));
+	vector3 const& v3MinL = m_pShape->v3MinL;
+	vector3 const& v3MaxL = m_pShape->v3MaxL;
+	m_v3CenterG = vector3(m_m4ToWorld * vector4(m_pShape->v3CenterL, 1.0f));
 
 	//Calculate the 8 corners of the cube
 	vector3 v3Corner[8];
 	//Back square
-	v3Corner[0] = m_v3MinL;
-	v3Corner[1] = vector3(m_v3MaxL.x, m_v3MinL.y, m_v3MinL.z);
-	v3Corner[2] = vector3(m_v3MinL.x, m_v3MaxL.y, m_v3MinL.z);
-	v3Corner[3] = vector3(m_v3MaxL.x, m_v3MaxL.y, m_v3MinL.z);
+	v3Corner[0] = v3MinL;
+	v3Corner[1] = vector3(v3MaxL.x, v3MinL.y, v3MinL.z);
+	v3Corner[2] = vector3(v3MinL.x, v3MaxL.y, v3MinL.z);
+	v3Corner[3] = vector3(v3MaxL.x, v3MaxL.y, v3MinL.z);
 
 	//Front square
-	v3Corner[4] = vector3(m_v3MinL.x, m_v3MinL.y, m_v3MaxL.z);
-	v3Corner[5] = vector3(m_v3MaxL.x, m_v3MinL.y, m_v3MaxL.z);
-	v3Corner[6] = vector3(m_v3MinL.x, m_v3MaxL.y, m_v3MaxL.z);
-	v3Corner[7] = m_v3MaxL;
+	v3Corner[4] = vector3(v3MinL.x, v3MinL.y, v3MaxL.z);
+	v3Corner[5] = vector3(v3MaxL.x, v3MinL.y, v3MaxL.z);
+	v3Corner[6] = vector3(v3MinL.x, v3MaxL.y, v3MaxL.z);
+	v3Corner[7] = v3MaxL;
 
 	//Place them in world space
 	for (uint uIndex = 0; uIndex < 8; ++uIndex)
@@ -135,44 +133,54 @@ void MyRigidBody::SetModelMatrix(matrix4 a_m4ModelMatrix)
 	m_v3ARBBSize = m_v3MaxG - m_v3MinG;
 }
 //The big 3
-MyRigidBody::MyRigidBody(std::vector<vector3> a_pointList)
+PRigidBodyShape MyRigidBody::MakeShape(std::vector<vector3> const& a_pointList)
 {
-	Init();
+	std::shared_ptr<MyRigidBodyShape> pShape = std::make_shared<MyRigidBodyShape>();
 	//Count the points of the incoming list
 	uint uVertexCount = a_pointList.size();
 
 	//If there are none just return, we have no information to create the BS from
 	if (uVertexCount == 0)
-		return;
+		return pShape;
 
+	vector3& v3MinL = pShape->v3MinL;
+	vector3& v3MaxL = pShape->v3MaxL;
 	//Max and min as the first vector of the list
-	m_v3MaxL = m_v3MinL = a_pointList[0];
+	v3MaxL = v3MinL = a_pointList[0];
 
 	//Get the max and min out of the list
 	for (uint i = 1; i < uVertexCount; ++i)
 	{
-		if (m_v3MaxL.x < a_pointList[i].x) m_v3MaxL.x = a_pointList[i].x;
-		else if (m_v3MinL.x > a_pointList[i].x) m_v3MinL.x = a_pointList[i].x;
+		if (v3MaxL.x < a_pointList[i].x) v3MaxL.x = a_pointList[i].x;
+		else if (v3MinL.x > a_pointList[i].x) v3MinL.x = a_pointList[i].x;
 
-		if (m_v3MaxL.y < a_pointList[i].y) m_v3MaxL.y = a_pointList[i].y;
-		else if (m_v3MinL.y > a_pointList[i].y) m_v3MinL.y = a_pointList[i].y;
+		if (v3MaxL.y < a_pointList[i].y) v3MaxL.y = a_pointList[i].y;
+		else if (v3MinL.y > a_pointList[i].y) v3MinL.y = a_pointList[i].y;
 
-		if (m_v3MaxL.z < a_pointList[i].z) m_v3MaxL.z = a_pointList[i].z;
-		else if (m_v3MinL.z > a_pointList[i].z) m_v3MinL.z = a_pointList[i].z;
+		if (v3MaxL.z < a_pointList[i].z) v3MaxL.z = a_pointList[i].z;
+		else if (v3MinL.z > a_pointList[i].z) v3MinL.z = a_pointList[i].z;
 	}
 
-	//with model matrix being the identity, local and global are the same
-	m_v3MinG = m_v3MinL;
-	m_v3MaxG = m_v3MaxL;
-
 	//with the max and the min we calculate the center
-	m_v3CenterL = (m_v3MaxL + m_v3MinL) / 2.0f;
+	pShape->v3CenterL = (v3MaxL + v3MinL) / 2.0f;
 
 	//we calculate the distance between min and max vectors
-	m_v3HalfWidth = (m_v3MaxL - m_v3MinL) / 2.0f;
+	pShape->v3HalfWidth = (v3MaxL - v3MinL) / 2.0f;
 
 	//Get the distance between the center and either the min or the max
-	m_fRadius = glm::distance(m_v3CenterL, m_v3MinL);
+	pShape->fRadius = glm::distance(pShape->v3CenterL, v3MinL);
+	return pShape;
+}
+MyRigidBody::MyRigidBody(std::vector<vector3> const& a_pointList) : MyRigidBody(MakeShape(a_pointList)) {}
+MyRigidBody::MyRigidBody(PRigidBodyShape a_pShape)
+{
+	Init();
+	m_pShape = a_pShape ? a_pShape : MakeShape(std::vector<vector3>());
+
+	//with model matrix being the identity, local and global are the same
+	m_v3MinG = m_pShape->v3MinL;
+	m_v3MaxG = m_pShape->v3MaxL;
+	m_v3CenterG = m_pShape->v3CenterL;
 }
 MyRigidBody::MyRigidBody(MyRigidBody const& other)
 {
@@ -182,20 +190,16 @@ MyRigidBody::MyRigidBody(MyRigidBody const& other)
 	m_bVisibleOBB = other.m_bVisibleOBB;
 	m_bVisibleARBB = other.m_bVisibleARBB;
 
-	m_fRadius = other.m_fRadius;
+	m_pShape = other.m_pShape;
 
 	m_v3ColorColliding = other.m_v3ColorColliding;
 	m_v3ColorNotColliding = other.m_v3ColorNotColliding;
 
-	m_v3CenterL = other.m_v3CenterL;
 	m_v3CenterG = other.m_v3CenterG;
-	m_v3MinL = other.m_v3MinL;
-	m_v3MaxL = other.m_v3MaxL;
 
 	m_v3MinG = other.m_v3MinG;
 	m_v3MaxG = other.m_v3MaxG;
 
-	m_v3HalfWidth = other.m_v3HalfWidth;
 	m_v3ARBBSize = other.m_v3ARBBSize;
 
 	m_m4ToWorld = other.m_m4ToWorld;
@@ -289,7 +293,7 @@ bool MyRigidBody::IsColliding(MyRigidBody* const other)
 {
 	//check if spheres are colliding
 	bool bColliding = true;
-	//bColliding = (glm::distance(GetCenterGlobal(), other->GetCenterGlobal()) < m_fRadius + other->m_fRadius);
+	//bColliding = (glm::distance(GetCenterGlobal(), other->GetCenterGlobal()) < GetRadius() + other->GetRadius());
 	//if they are check the Axis Aligned Bounding Box
 	if (bColliding) //they are colliding with bounding sphere
 	{
@@ -326,22 +330,98 @@ bool MyRigidBody::IsColliding(MyRigidBody* const other)
 	}
 	return bColliding;
 }
+bool MyRigidBody::IsOverlapping(MyRigidBody* const other)
+{
+	//separated along any axis means they are not overlapping
+	if (m_v3MaxG.x < other->m_v3MinG.x || m_v3MinG.x > other->m_v3MaxG.x)
+		return false;
+	if (m_v3MaxG.y < other->m_v3MinG.y || m_v3MinG.y > other->m_v3MaxG.y)
+		return false;
+	if (m_v3MaxG.z < other->m_v3MinG.z || m_v3MinG.z > other->m_v3MaxG.z)
+		return false;
+	return true;
+}
+bool MyRigidBody::IsOverlappingSwept(MyRigidBody* const a_pOther, vector3 a_v3Motion, vector3 a_v3OtherMotion)
+{
+	//the box that encloses the whole motion of each body
+	vector3 v3SweptMinA = glm::min(m_v3MinG, m_v3MinG + a_v3Motion);
+	vector3 v3SweptMaxA = glm::max(m_v3MaxG, m_v3MaxG + a_v3Motion);
+	vector3 v3SweptMinB = glm::min(a_pOther->m_v3MinG, a_pOther->m_v3MinG + a_v3OtherMotion);
+	vector3 v3SweptMaxB = glm::max(a_pOther->m_v3MaxG, a_pOther->m_v3MaxG + a_v3OtherMotion);
+	for (uint i = 0; i < 3; ++i)
+	{
+		if (v3SweptMaxA[i] < v3SweptMinB[i] || v3SweptMinA[i] > v3SweptMaxB[i])
+			return false;
+	}
+	return true;
+}
+bool MyRigidBody::IsCollidingSwept(MyRigidBody* const a_pOther, vector3 a_v3Motion, vector3 a_v3OtherMotion, float& a_fTimeOfImpact, vector3& a_v3Normal)
+{
+	a_fTimeOfImpact = 1.0f;
+	a_v3Normal = ZERO_V3;
+
+	//Broad phase: the boxes are at the end of the motion, sweep them back to where they started
+	if (!IsOverlappingSwept(a_pOther, -a_v3Motion, -a_v3OtherMotion))
+		return false;
+
+	//Boxes at the start of the frame
+	vector3 v3MinA = m_v3MinG - a_v3Motion;
+	vector3 v3MaxA = m_v3MaxG - a_v3Motion;
+	vector3 v3MinB = a_pOther->m_v3MinG - a_v3OtherMotion;
+	vector3 v3MaxB = a_pOther->m_v3MaxG - a_v3OtherMotion;
+
+	//Narrow phase: time of impact of A moving relative to B, one slab per axis,
+	//the last slab to be entered is the face they touch on
+	vector3 v3Relative = a_v3Motion - a_v3OtherMotion;
+	float fEnter = 0.0f;
+	float fExit = 1.0f;
+	uint uAxis = 3;
+	for (uint i = 0; i < 3; ++i)
+	{
+		if (v3Relative[i] == 0.0f)
+		{
+			//not moving on this axis, they need to overlap already
+			if (v3MaxA[i] < v3MinB[i] || v3MinA[i] > v3MaxB[i])
+				return false;
+			continue;
+		}
+		float fTime0 = (v3MinB[i] - v3MaxA[i]) / v3Relative[i];
+		float fTime1 = (v3MaxB[i] - v3MinA[i]) / v3Relative[i];
+		if (fTime0 > fTime1)
+			std::swap(fTime0, fTime1);
+		if (fTime0 > fEnter)
+		{
+			fEnter = fTime0;
+			uAxis = i;
+		}
+		fExit = std::min(fExit, fTime1);
+		if (fEnter > fExit)
+			return false;
+	}
+
+	a_fTimeOfImpact = fEnter;
+	//A was moving into B along that axis
+	if (uAxis < 3)
+		a_v3Normal[uAxis] = v3Relative[uAxis] < 0.0f ? -1.0f : 1.0f;
+	return true;
+}
 
 void MyRigidBody::AddToRenderList(void)
 {
+#ifndef SIMPLEX_HEADLESS
 	if (m_bVisibleBS)
 	{
 		if (m_uCollidingCount > 0)
-			m_pMeshMngr->AddWireSphereToRenderList(glm::translate(m_m4ToWorld, m_v3CenterL) * glm::scale(vector3(m_fRadius)), C_BLUE_CORNFLOWER);
+			m_pMeshMngr->AddWireSphereToRenderList(glm::translate(m_m4ToWorld, m_pShape->v3CenterL) * glm::scale(vector3(m_pShape->fRadius)), C_BLUE_CORNFLOWER);
 		else
-			m_pMeshMngr->AddWireSphereToRenderList(glm::translate(m_m4ToWorld, m_v3CenterL) * glm::scale(vector3(m_fRadius)), C_BLUE_CORNFLOWER);
+			m_pMeshMngr->AddWireSphereToRenderList(glm::translate(m_m4ToWorld, m_pShape->v3CenterL) * glm::scale(vector3(m_pShape->fRadius)), C_BLUE_CORNFLOWER);
 	}
 	if (m_bVisibleOBB)
 	{
 		if (m_uCollidingCount > 0)
-			m_pMeshMngr->AddWireCubeToRenderList(glm::translate(m_m4ToWorld, m_v3CenterL) * glm::scale(m_v3HalfWidth * 2.0f), m_v3ColorColliding);
+			m_pMeshMngr->AddWireCubeToRenderList(glm::translate(m_m4ToWorld, m_pShape->v3CenterL) * glm::scale(m_pShape->v3HalfWidth * 2.0f), m_v3ColorColliding);
 		else
-			m_pMeshMngr->AddWireCubeToRenderList(glm::translate(m_m4ToWorld, m_v3CenterL) * glm::scale(m_v3HalfWidth * 2.0f), m_v3ColorNotColliding);
+			m_pMeshMngr->AddWireCubeToRenderList(glm::translate(m_m4ToWorld, m_pShape->v3CenterL) * glm::scale(m_pShape->v3HalfWidth * 2.0f), m_v3ColorNotColliding);
 	}
 	if (m_bVisibleARBB)
 	{
@@ -350,6 +430,7 @@ void MyRigidBody::AddToRenderList(void)
 		else
 			m_pMeshMngr->AddWireCubeToRenderList(glm::translate(m_v3CenterG) * glm::scale(m_v3ARBBSize), C_YELLOW);
 	}
+#endif
 }
 bool MyRigidBody::IsInCollidingArray(MyRigidBody* a_pEntry)
 {
@@ -361,3 +442,20 @@ bool MyRigidBody::IsInCollidingArray(MyRigidBody* a_pEntry)
 	}
 	return false;
 }
+float MyRigidBody::GetPenetration(MyRigidBody* const a_pOther, vector3& a_v3Normal)
+{
+	//overlap of the boxes on each axis
+	vector3 v3Overlap = glm::min(m_v3MaxG, a_pOther->m_v3MaxG) - glm::max(m_v3MinG, a_pOther->m_v3MinG);
+
+	//the axis with the least overlap is the shortest way out
+	uint uAxis = 0;
+	if (v3Overlap.y < v3Overlap[uAxis])
+		uAxis = 1;
+	if (v3Overlap.z < v3Overlap[uAxis])
+		uAxis = 2;
+
+	vector3 v3Direction = (a_pOther->m_v3MinG + a_pOther->m_v3MaxG) - (m_v3MinG + m_v3MaxG);
+	a_v3Normal = ZERO_V3;
+	a_v3Normal[uAxis] = v3Direction[uAxis] < 0.0f ? -1.0f : 1.0f;
+	return v3Overlap[uAxis];
+}
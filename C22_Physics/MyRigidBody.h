@@ -5,11 +5,27 @@ Date: 2017/06
 #ifndef __MYRIGIDBODY_H_
 #define __MYRIGIDBODY_H_
 
+#ifdef SIMPLEX_HEADLESS
+#include "HeadlessDefinitions.h"
+#else
 #include "Simplex\Mesh\Model.h"
+#endif
+#include <memory>
 
 namespace Simplex
 {
 
+//Local space shape of a rigid body, the same for every instance of a model so it is shared between them
+struct MyRigidBodyShape
+{
+	float fRadius = 0.0f; //Radius
+	vector3 v3CenterL = ZERO_V3; //center point in local space
+	vector3 v3MinL = ZERO_V3; //minimum coordinate in local space (for OBB)
+	vector3 v3MaxL = ZERO_V3; //maximum coordinate in local space (for OBB)
+	vector3 v3HalfWidth = ZERO_V3; //half the size of the Oriented Bounding Box
+};
+typedef std::shared_ptr<MyRigidBodyShape const> PRigidBodyShape; //shared, read only shape
+
 //System Class
 class MyRigidBody
 {
@@ -23,21 +39,16 @@ protected:
 	bool m_bVisibleOBB = true; //Visibility of Oriented bounding box
 	bool m_bVisibleARBB = true; //Visibility of axis (Re)aligned bounding box
 
-	float m_fRadius = 0.0f; //Radius
+	PRigidBodyShape m_pShape = nullptr; //local space shape, shared with the other instances of the model
 
 	vector3 m_v3ColorColliding = C_RED; //Color when colliding
 	vector3 m_v3ColorNotColliding = C_WHITE; //Color when not colliding
 
-	vector3 m_v3CenterL = ZERO_V3; //center point in local space
 	vector3 m_v3CenterG = ZERO_V3; //center point in global space
 
-	vector3 m_v3MinL = ZERO_V3; //minimum coordinate in local space (for OBB)
-	vector3 m_v3MaxL = ZERO_V3; //maximum coordinate in local space (for OBB)
-
 	vector3 m_v3MinG = ZERO_V3; //minimum coordinate in global space (for ARBB)
 	vector3 m_v3MaxG = ZERO_V3; //maximum coordinate in global space (for ARBB)
 
-	vector3 m_v3HalfWidth = ZERO_V3; //half the size of the Oriented Bounding Box
 	vector3 m_v3ARBBSize = ZERO_V3;// size of the Axis (Re)Alligned Bounding Box
 
 	matrix4 m_m4ToWorld = IDENTITY_M4; //Matrix that will take us from local to world coordinate
@@ -47,11 +58,17 @@ protected:
 
 public:
 	/*
-	Usage: Constructor
-	Arguments: std::vector<vector3> a_pointList -> list of points to make the Rigid Body for
+	Usage: Constructor, makes a shape only for this Rigid Body
+	Arguments: std::vector<vector3> const& a_pointList -> list of points to make the Rigid Body for
 	Output: class object instance
 	*/
-	MyRigidBody(std::vector<vector3> a_pointList);
+	MyRigidBody(std::vector<vector3> const& a_pointList);
+	/*
+	Usage: Constructor, shares the shape with the other Rigid Bodies made from it
+	Arguments: PRigidBodyShape a_pShape -> local space shape, made with MakeShape
+	Output: class object instance
+	*/
+	MyRigidBody(PRigidBodyShape a_pShape);
 	/*
 	Usage: Copy Constructor
 	Arguments: class object to copy
@@ -76,6 +93,13 @@ public:
 	Output: ---
 	*/
 	void Swap(MyRigidBody& other);
+	/*
+	USAGE: Computes the local space shape enclosing a list of points, to be shared by the Rigid Bodies
+	of every instance of a model
+	ARGUMENTS: std::vector<vector3> const& a_pointList -> list of points to make the shape for
+	OUTPUT: shape, an empty one at the origin if there are no points
+	*/
+	static PRigidBodyShape MakeShape(std::vector<vector3> const& a_pointList);
 
 	/*
 	USAGE: Will render the Rigid Body at the model to world matrix
@@ -111,6 +135,45 @@ public:
 	OUTPUT: are they colliding?
 	*/
 	bool IsColliding(MyRigidBody* const other);
+	/*
+	USAGE: Tells if the boxes of both objects overlap without adding them to each other's collision list,
+	so it can be asked from several threads at once
+	ARGUMENTS: MyRigidBody* const other -> inspected rigid body
+	OUTPUT: are they overlapping?
+	*/
+	bool IsOverlapping(MyRigidBody* const other);
+	/*
+	USAGE: Tells if the boxes that enclose the motion of both objects overlap, the current global boxes are
+	considered the start of the motion, it does not store anything so it can be asked from several threads at once
+	ARGUMENTS:
+	-	MyRigidBody* const a_pOther -> inspected rigid body
+	-	vector3 a_v3Motion -> displacement of this rigid body
+	-	vector3 a_v3OtherMotion -> displacement of the inspected rigid body
+	OUTPUT: are the swept boxes overlapping?
+	*/
+	bool IsOverlappingSwept(MyRigidBody* const a_pOther, vector3 a_v3Motion, vector3 a_v3OtherMotion);
+
+	/*
+	USAGE: Tells if the object collides with the incoming one at any point of the motion of this frame,
+	the current global boxes are considered the end of the motion
+	ARGUMENTS:
+	-	MyRigidBody* const a_pOther -> inspected rigid body
+	-	vector3 a_v3Motion -> displacement of this rigid body during the frame
+	-	vector3 a_v3OtherMotion -> displacement of the inspected rigid body during the frame
+	-	float& a_fTimeOfImpact -> (output) time of the first contact, 0 start of the frame, 1 end of it
+	-	vector3& a_v3Normal -> (output) axis of the face they touch on, pointing from this rigid body to the
+		inspected one, zero if they were already overlapping at the start of the frame
+	OUTPUT: are they colliding during the frame?
+	*/
+	bool IsCollidingSwept(MyRigidBody* const a_pOther, vector3 a_v3Motion, vector3 a_v3OtherMotion, float& a_fTimeOfImpact, vector3& a_v3Normal);
+	/*
+	USAGE: Measures the overlap of the global boxes of two rigid bodies along the axis where it is the smallest
+	ARGUMENTS:
+	-	MyRigidBody* const a_pOther -> inspected rigid body
+	-	vector3& a_v3Normal -> (output) axis of the overlap pointing from this rigid body to the inspected one
+	OUTPUT: depth of the overlap, negative if they are apart on that axis
+	*/
+	float GetPenetration(MyRigidBody* const a_pOther, vector3& a_v3Normal);
 #pragma region Accessors
 	/*
 	Usage: Gets visibility of bounding sphere
@@ -155,6 +218,12 @@ public:
 	*/
 	float GetRadius(void);
 	/*
+	Usage: Gets the local space shape
+	Arguments: ---
+	Output: shape, shared with the other instances of the model
+	*/
+	PRigidBodyShape GetShape(void);
+	/*
 	Usage: Gets the color when colliding
 	Arguments: ---
 	Output: color
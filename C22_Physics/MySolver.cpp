@@ -1,133 +1,507 @@
 #include "MySolver.h"
+#include <xmmintrin.h>
 using namespace Simplex;
 //  MySolver
+MySolver* MySolver::m_pInstance = nullptr;
 void MySolver::Init(void)
 {
-	m_v3Acceleration = ZERO_V3;
-	m_v3Position = ZERO_V3;
-	m_v3Velocity = ZERO_V3;
-	m_fMass = 1.0f;
+	m_uBodyCount = 0;
+	m_FreeList.clear();
+	Resize(0);
+	m_fSleepVelocity = 0.03f;
+	m_uSleepFrames = 30;
+	m_uAwakeCount = 0;
+	m_ContactList.clear();
+	m_ContactCache.clear();
+	m_RemovedList.clear();
+	m_uIterationCount = 8;
+	m_fFriction = 0.5f;
 }
-void MySolver::Swap(MySolver& other)
+void MySolver::Release(void)
 {
-	std::swap(m_v3Acceleration, other.m_v3Acceleration);
-	std::swap(m_v3Velocity, other.m_v3Velocity);
-	std::swap(m_v3Position, other.m_v3Position);
-	std::swap(m_fMass, other.m_fMass);
+	m_uBodyCount = 0;
+	m_FreeList.clear();
+	m_ContactList.clear();
+	m_ContactCache.clear();
+	m_RemovedList.clear();
+	Resize(0);
+}
+MySolver* MySolver::GetInstance()
+{
+	if (m_pInstance == nullptr)
+	{
+		m_pInstance = new MySolver();
+	}
+	return m_pInstance;
+}
+void MySolver::ReleaseInstance()
+{
+	if (m_pInstance != nullptr)
+	{
+		delete m_pInstance;
+		m_pInstance = nullptr;
+	}
 }
-void MySolver::Release(void){/*nothing to deallocate*/ }
 //The big 3
 MySolver::MySolver(void){ Init(); }
-MySolver::MySolver(MySolver const& other)
+MySolver::MySolver(MySolver const& other){ }
+MySolver& MySolver::operator=(MySolver const& other) { return *this; }
+MySolver::~MySolver() { Release(); }
+
+void MySolver::Resize(uint a_uSize)
+{
+	//the integration works on four bodies at a time, round up so it never reads past the end
+	a_uSize = (a_uSize + 3) & ~3u;
+	m_Acceleration.Resize(a_uSize);
+	m_Position.Resize(a_uSize);
+	m_PreviousPosition.Resize(a_uSize);
+	m_Size.Resize(a_uSize);
+	m_Velocity.Resize(a_uSize);
+	m_Mass.resize(a_uSize, 1.0f);
+	m_InverseMass.resize(a_uSize, 1.0f);
+	m_Simulated.resize(a_uSize, 0.0f);
+	m_Continuous.resize(a_uSize, false);
+	m_Awake.resize(a_uSize, 1.0f);
+	m_StillFrames.resize(a_uSize, 0.0f);
+}
+void MySolver::ResetBody(uint a_uIndex)
 {
-	m_v3Acceleration = other.m_v3Acceleration;
-	m_v3Velocity = other.m_v3Velocity;
-	m_v3Position = other.m_v3Position;
-	m_fMass = other.m_fMass;
+	m_Acceleration.Set(a_uIndex, ZERO_V3);
+	m_Position.Set(a_uIndex, ZERO_V3);
+	m_PreviousPosition.Set(a_uIndex, ZERO_V3);
+	m_Size.Set(a_uIndex, vector3(1.0f));
+	m_Velocity.Set(a_uIndex, ZERO_V3);
+	m_Mass[a_uIndex] = 1.0f;
+	m_InverseMass[a_uIndex] = 1.0f;
+	m_Simulated[a_uIndex] = 0.0f;
+	m_Continuous[a_uIndex] = false;
+	m_Awake[a_uIndex] = 1.0f;
+	m_StillFrames[a_uIndex] = 0.0f;
 }
-MySolver& MySolver::operator=(MySolver const& other)
+uint MySolver::AddBody(void)
 {
-	if (this != &other)
+	uint uIndex;
+	//reuse a released slot if there is one
+	if (!m_FreeList.empty())
 	{
-		Release();
-		Init();
-		MySolver temp(other);
-		Swap(temp);
+		uIndex = m_FreeList.back();
+		m_FreeList.pop_back();
 	}
-	return *this;
+	else
+	{
+		uIndex = m_uBodyCount;
+		++m_uBodyCount;
+		if (m_uBodyCount > m_Mass.size())
+			Resize(m_uBodyCount);
+	}
+	ResetBody(uIndex);
+	return uIndex;
 }
-MySolver::~MySolver() { Release(); }
+uint MySolver::AddBody(uint a_uSource)
+{
+	uint uIndex = AddBody();
+	m_Acceleration.Set(uIndex, m_Acceleration.Get(a_uSource));
+	m_Position.Set(uIndex, m_Position.Get(a_uSource));
+	m_PreviousPosition.Set(uIndex, m_PreviousPosition.Get(a_uSource));
+	m_Size.Set(uIndex, m_Size.Get(a_uSource));
+	m_Velocity.Set(uIndex, m_Velocity.Get(a_uSource));
+	m_Mass[uIndex] = m_Mass[a_uSource];
+	m_InverseMass[uIndex] = m_InverseMass[a_uSource];
+	m_Simulated[uIndex] = m_Simulated[a_uSource];
+	m_Continuous[uIndex] = m_Continuous[a_uSource];
+	m_Awake[uIndex] = m_Awake[a_uSource];
+	m_StillFrames[uIndex] = m_StillFrames[a_uSource];
+	return uIndex;
+}
+void MySolver::RemoveBody(uint a_uIndex)
+{
+	if (a_uIndex >= m_uBodyCount)
+		return;
+
+	//an unsimulated body with no velocity is left untouched by the integration
+	ResetBody(a_uIndex);
+	m_FreeList.push_back(a_uIndex);
+
+	//a new body given this slot should not start with the impulses of this one, they are dropped before the
+	//next contacts are added so removing many bodies goes over the cache once
+	if (!m_ContactCache.empty())
+		m_RemovedList.push_back(a_uIndex);
+}
+uint MySolver::GetBodyCount(void) { return m_uBodyCount; }
 
 //Accessors
-void MySolver::SetPosition(vector3 a_v3Position) { m_v3Position = a_v3Position; }
-vector3 MySolver::GetPosition(void) { return m_v3Position; }
+void MySolver::SetSimulated(uint a_uIndex, bool a_bSimulated)
+{
+	m_Simulated[a_uIndex] = a_bSimulated ? 1.0f : 0.0f;
+	//forces applied while it was not simulated do not count
+	m_Acceleration.Set(a_uIndex, ZERO_V3);
+	WakeUp(a_uIndex);
+}
+bool MySolver::IsSimulated(uint a_uIndex) { return m_Simulated[a_uIndex] != 0.0f; }
 
-void MySolver::SetSize(vector3 a_v3Size) { m_v3Size = a_v3Size; }
-vector3 MySolver::GetSize(void) { return m_v3Size; }
+bool MySolver::IsAwake(uint a_uIndex) { return m_Awake[a_uIndex] != 0.0f; }
+void MySolver::WakeUp(uint a_uIndex)
+{
+	m_Awake[a_uIndex] = 1.0f;
+	m_StillFrames[a_uIndex] = 0.0f;
+}
+void MySolver::SetSleepThreshold(float a_fVelocity, uint a_uFrames)
+{
+	m_fSleepVelocity = a_fVelocity;
+	m_uSleepFrames = a_uFrames;
+}
+uint MySolver::GetAwakeCount(void) { return m_uAwakeCount; }
 
-void MySolver::SetVelocity(vector3 a_v3Velocity) { m_v3Velocity = a_v3Velocity; }
-vector3 MySolver::GetVelocity(void) { return m_v3Velocity; }
+void MySolver::SetPosition(uint a_uIndex, vector3 a_v3Position) { m_Position.Set(a_uIndex, a_v3Position); }
+vector3 MySolver::GetPosition(uint a_uIndex) { return m_Position.Get(a_uIndex); }
 
-void MySolver::SetMass(float a_fMass) { m_fMass = a_fMass; }
-float MySolver::GetMass(void) { return m_fMass; }
+void MySolver::SetSize(uint a_uIndex, vector3 a_v3Size) { m_Size.Set(a_uIndex, a_v3Size); }
+vector3 MySolver::GetSize(uint a_uIndex) { return m_Size.Get(a_uIndex); }
 
-//Methods
-void MySolver::ApplyFriction(float a_fFriction)
+void MySolver::SetVelocity(uint a_uIndex, vector3 a_v3Velocity)
 {
-	if (a_fFriction < 0.01f)
-		a_fFriction = 0.01f;
-	
-	m_v3Velocity *= 1.0f - a_fFriction;
-
-	//if velocity is really small make it zero
-	if (glm::length(m_v3Velocity) < 0.01f)
-		m_v3Velocity = ZERO_V3;
+	m_Velocity.Set(a_uIndex, a_v3Velocity);
+	WakeUp(a_uIndex);
 }
-void MySolver::ApplyForce(vector3 a_v3Force)
+vector3 MySolver::GetVelocity(uint a_uIndex) { return m_Velocity.Get(a_uIndex); }
+
+void MySolver::SetMass(uint a_uIndex, float a_fMass)
 {
+	m_Mass[a_uIndex] = a_fMass;
 	//check minimum mass
-	if (m_fMass < 0.01f)
-		m_fMass = 0.01f;
+	if (a_fMass < 0.01f)
+		a_fMass = 0.01f;
+	m_InverseMass[a_uIndex] = 1.0f / a_fMass;
+}
+float MySolver::GetMass(uint a_uIndex) { return m_Mass[a_uIndex]; }
+
+void MySolver::SetContinuous(uint a_uIndex, bool a_bContinuous) { m_Continuous[a_uIndex] = a_bContinuous; }
+bool MySolver::IsContinuous(uint a_uIndex) { return m_Continuous[a_uIndex]; }
+
+vector3 MySolver::GetPreviousPosition(uint a_uIndex) { return m_PreviousPosition.Get(a_uIndex); }
+void MySolver::ResetPreviousPosition(uint a_uIndex) { m_PreviousPosition.Set(a_uIndex, m_Position.Get(a_uIndex)); }
+vector3 MySolver::GetDisplacement(uint a_uIndex) { return m_Position.Get(a_uIndex) - m_PreviousPosition.Get(a_uIndex); }
+void MySolver::AdvanceTo(uint a_uIndex, float a_fTime)
+{
+	a_fTime = glm::clamp(a_fTime, 0.0f, 1.0f);
+	m_Position.Set(a_uIndex, m_PreviousPosition.Get(a_uIndex) + GetDisplacement(a_uIndex) * a_fTime);
+}
+
+//Methods
+void MySolver::ApplyForce(uint a_uIndex, vector3 a_v3Force)
+{
+	WakeUp(a_uIndex);
 	//f = m * a -> a = f / m
-	m_v3Acceleration += a_v3Force / m_fMass;
+	m_Acceleration.Set(a_uIndex, m_Acceleration.Get(a_uIndex) + a_v3Force * m_InverseMass[a_uIndex]);
+}
+void MySolver::Update(void)
+{
+	IntegrateForces();
+	IntegrateVelocities();
+}
+void MySolver::IntegrateForces(void)
+{
+	const __m128 v4Zero = _mm_setzero_ps();
+	const __m128 v4One = _mm_set1_ps(1.0f);
+	const __m128 v4Gravity = _mm_set1_ps(-0.035f);
+	const __m128 v4MaxVelocity = _mm_set1_ps(5.0f);
+	const __m128 v4MaxVelocitySq = _mm_set1_ps(5.0f * 5.0f);
+
+	uint uSize = static_cast<uint>(m_Mass.size());
+	for (uint i = 0; i < uSize; i += 4)
+	{
+		//only simulated bodies that are awake move, skip the group if none does
+		__m128 v4Simulated = _mm_and_ps(_mm_cmpgt_ps(_mm_loadu_ps(&m_Simulated[i]), v4Zero), _mm_cmpgt_ps(_mm_loadu_ps(&m_Awake[i]), v4Zero));
+		if (_mm_movemask_ps(v4Simulated) == 0)
+			continue;
+
+		__m128 v4InverseMass = _mm_loadu_ps(&m_InverseMass[i]);
+
+		__m128 v4AccX = _mm_loadu_ps(&m_Acceleration.x[i]);
+		__m128 v4AccY = _mm_loadu_ps(&m_Acceleration.y[i]);
+		__m128 v4AccZ = _mm_loadu_ps(&m_Acceleration.z[i]);
+
+		//gravity, applied as a force
+		v4AccY = _mm_add_ps(v4AccY, _mm_mul_ps(v4Gravity, v4InverseMass));
+
+		__m128 v4VelX = _mm_add_ps(_mm_loadu_ps(&m_Velocity.x[i]), v4AccX);
+		__m128 v4VelY = _mm_add_ps(_mm_loadu_ps(&m_Velocity.y[i]), v4AccY);
+		__m128 v4VelZ = _mm_add_ps(_mm_loadu_ps(&m_Velocity.z[i]), v4AccZ);
+
+		//clamp to the maximum velocity, the only square root of the step
+		__m128 v4LengthSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(v4VelX, v4VelX), _mm_mul_ps(v4VelY, v4VelY)), _mm_mul_ps(v4VelZ, v4VelZ));
+		__m128 v4TooFast = _mm_cmpgt_ps(v4LengthSq, v4MaxVelocitySq);
+		__m128 v4Scale = _mm_div_ps(v4MaxVelocity, _mm_sqrt_ps(_mm_max_ps(v4LengthSq, v4MaxVelocitySq)));
+		v4Scale = _mm_or_ps(_mm_and_ps(v4TooFast, v4Scale), _mm_andnot_ps(v4TooFast, v4One));
+
+		//bodies that do not move keep no velocity
+		v4Scale = _mm_and_ps(v4Scale, v4Simulated);
+		_mm_storeu_ps(&m_Velocity.x[i], _mm_mul_ps(v4VelX, v4Scale));
+		_mm_storeu_ps(&m_Velocity.y[i], _mm_mul_ps(v4VelY, v4Scale));
+		_mm_storeu_ps(&m_Velocity.z[i], _mm_mul_ps(v4VelZ, v4Scale));
+		_mm_storeu_ps(&m_Acceleration.x[i], v4Zero);
+		_mm_storeu_ps(&m_Acceleration.y[i], v4Zero);
+		_mm_storeu_ps(&m_Acceleration.z[i], v4Zero);
+	}
 }
-vector3 CalculateMaxVelocity(vector3 a_v3Velocity, float maxVelocity)
+void MySolver::IntegrateVelocities(void)
 {
-	if (glm::length(a_v3Velocity) > maxVelocity)
+	const __m128 v4Zero = _mm_setzero_ps();
+	const __m128 v4One = _mm_set1_ps(1.0f);
+	const __m128 v4Friction = _mm_set1_ps(1.0f - 0.1f);
+	//friction rounds under 0.01 and the solver under 0.028, the larger one wins
+	const __m128 v4MinVelocitySq = _mm_set1_ps(0.028f * 0.028f);
+	const __m128 v4SleepVelocitySq = _mm_set1_ps(m_fSleepVelocity * m_fSleepVelocity);
+	const __m128 v4SleepFrames = _mm_set1_ps(static_cast<float>(m_uSleepFrames));
+
+	m_uAwakeCount = 0;
+	uint uSize = static_cast<uint>(m_Mass.size());
+	for (uint i = 0; i < uSize; i += 4)
 	{
-		a_v3Velocity = glm::normalize(a_v3Velocity);
-		a_v3Velocity *= maxVelocity;
+		//only simulated bodies that are awake move, skip the group if none does
+		__m128 v4Simulated = _mm_and_ps(_mm_cmpgt_ps(_mm_loadu_ps(&m_Simulated[i]), v4Zero), _mm_cmpgt_ps(_mm_loadu_ps(&m_Awake[i]), v4Zero));
+		if (_mm_movemask_ps(v4Simulated) == 0)
+			continue;
+
+		//friction
+		__m128 v4VelX = _mm_mul_ps(_mm_loadu_ps(&m_Velocity.x[i]), v4Friction);
+		__m128 v4VelY = _mm_mul_ps(_mm_loadu_ps(&m_Velocity.y[i]), v4Friction);
+		__m128 v4VelZ = _mm_mul_ps(_mm_loadu_ps(&m_Velocity.z[i]), v4Friction);
+
+		//if velocity is really small make it zero, unsimulated bodies do not move at all
+		__m128 v4LengthSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(v4VelX, v4VelX), _mm_mul_ps(v4VelY, v4VelY)), _mm_mul_ps(v4VelZ, v4VelZ));
+		__m128 v4Keep = _mm_and_ps(_mm_cmpge_ps(v4LengthSq, v4MinVelocitySq), v4Simulated);
+		v4VelX = _mm_and_ps(v4VelX, v4Keep);
+		v4VelY = _mm_and_ps(v4VelY, v4Keep);
+		v4VelZ = _mm_and_ps(v4VelZ, v4Keep);
+
+		//keep where we started so fast movers can be swept along this frame's motion
+		__m128 v4PosX = _mm_loadu_ps(&m_Position.x[i]);
+		__m128 v4PosY = _mm_loadu_ps(&m_Position.y[i]);
+		__m128 v4PosZ = _mm_loadu_ps(&m_Position.z[i]);
+		__m128 v4PrevX = v4PosX;
+		__m128 v4PrevY = v4PosY;
+		__m128 v4PrevZ = v4PosZ;
+
+		v4PosX = _mm_add_ps(v4PosX, v4VelX);
+		v4PosY = _mm_add_ps(v4PosY, v4VelY);
+		v4PosZ = _mm_add_ps(v4PosZ, v4VelZ);
+
+		//the floor is at y = 0
+		__m128 v4OnFloor = _mm_and_ps(_mm_cmple_ps(v4PosY, v4Zero), v4Simulated);
+		v4PosY = _mm_andnot_ps(v4OnFloor, v4PosY);
+		v4VelY = _mm_andnot_ps(v4OnFloor, v4VelY);
+
+		//count the steps the body has been still, once it has been still long enough it falls asleep
+		v4LengthSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(v4VelX, v4VelX), _mm_mul_ps(v4VelY, v4VelY)), _mm_mul_ps(v4VelZ, v4VelZ));
+		__m128 v4Still = _mm_cmplt_ps(v4LengthSq, v4SleepVelocitySq);
+		__m128 v4StillFrames = _mm_and_ps(_mm_add_ps(_mm_loadu_ps(&m_StillFrames[i]), v4One), v4Still);
+		__m128 v4Asleep = _mm_and_ps(_mm_cmpge_ps(v4StillFrames, v4SleepFrames), v4Simulated);
+		v4VelX = _mm_andnot_ps(v4Asleep, v4VelX);
+		v4VelY = _mm_andnot_ps(v4Asleep, v4VelY);
+		v4VelZ = _mm_andnot_ps(v4Asleep, v4VelZ);
+
+		//a body falling asleep has no motion left to sweep
+		v4PrevX = _mm_or_ps(_mm_and_ps(v4Asleep, v4PosX), _mm_andnot_ps(v4Asleep, v4PrevX));
+		v4PrevY = _mm_or_ps(_mm_and_ps(v4Asleep, v4PosY), _mm_andnot_ps(v4Asleep, v4PrevY));
+		v4PrevZ = _mm_or_ps(_mm_and_ps(v4Asleep, v4PosZ), _mm_andnot_ps(v4Asleep, v4PrevZ));
+
+		//lanes that were already sleeping keep their state
+		__m128 v4Awake = _mm_loadu_ps(&m_Awake[i]);
+		v4Awake = _mm_or_ps(_mm_and_ps(v4Simulated, _mm_andnot_ps(v4Asleep, v4One)), _mm_andnot_ps(v4Simulated, v4Awake));
+		v4StillFrames = _mm_or_ps(_mm_and_ps(v4Simulated, v4StillFrames), _mm_andnot_ps(v4Simulated, _mm_loadu_ps(&m_StillFrames[i])));
+		v4PrevX = _mm_or_ps(_mm_and_ps(v4Simulated, v4PrevX), _mm_andnot_ps(v4Simulated, _mm_loadu_ps(&m_PreviousPosition.x[i])));
+		v4PrevY = _mm_or_ps(_mm_and_ps(v4Simulated, v4PrevY), _mm_andnot_ps(v4Simulated, _mm_loadu_ps(&m_PreviousPosition.y[i])));
+		v4PrevZ = _mm_or_ps(_mm_and_ps(v4Simulated, v4PrevZ), _mm_andnot_ps(v4Simulated, _mm_loadu_ps(&m_PreviousPosition.z[i])));
+		_mm_storeu_ps(&m_Awake[i], v4Awake);
+		_mm_storeu_ps(&m_StillFrames[i], v4StillFrames);
+		_mm_storeu_ps(&m_PreviousPosition.x[i], v4PrevX);
+		_mm_storeu_ps(&m_PreviousPosition.y[i], v4PrevY);
+		_mm_storeu_ps(&m_PreviousPosition.z[i], v4PrevZ);
+
+		//count the bodies still awake
+		int nAwake = _mm_movemask_ps(_mm_andnot_ps(v4Asleep, v4Simulated));
+		m_uAwakeCount += (nAwake & 1) + ((nAwake >> 1) & 1) + ((nAwake >> 2) & 1) + ((nAwake >> 3) & 1);
+
+		_mm_storeu_ps(&m_Position.x[i], v4PosX);
+		_mm_storeu_ps(&m_Position.y[i], v4PosY);
+		_mm_storeu_ps(&m_Position.z[i], v4PosZ);
+		_mm_storeu_ps(&m_Velocity.x[i], v4VelX);
+		_mm_storeu_ps(&m_Velocity.y[i], v4VelY);
+		_mm_storeu_ps(&m_Velocity.z[i], v4VelZ);
 	}
-	return a_v3Velocity;
 }
-vector3 RoundSmallVelocity(vector3 a_v3Velocity, float minVelocity = 0.01f)
+
+//Contacts
+void MySolver::SetIterationCount(uint a_uIterations) { m_uIterationCount = a_uIterations; }
+uint MySolver::GetIterationCount(void) { return m_uIterationCount; }
+void MySolver::SetFriction(float a_fFriction) { m_fFriction = a_fFriction; }
+float MySolver::GetFriction(void) { return m_fFriction; }
+uint MySolver::GetContactCount(void) { return static_cast<uint>(m_ContactList.size()); }
+float MySolver::GetContactInverseMass(uint a_uIndex)
+{
+	if (m_Simulated[a_uIndex] == 0.0f || m_Awake[a_uIndex] == 0.0f)
+		return 0.0f;
+	return m_InverseMass[a_uIndex];
+}
+void MySolver::ApplyImpulse(MyContact& a_Contact, vector3 a_v3Impulse)
+{
+	//bodies that do not move are only read, so islands sharing one can be solved at the same time
+	if (a_Contact.fInverseMass > 0.0f)
+		m_Velocity.Set(a_Contact.uIndex, m_Velocity.Get(a_Contact.uIndex) - a_v3Impulse * a_Contact.fInverseMass);
+	if (a_Contact.fOtherInverseMass > 0.0f)
+		m_Velocity.Set(a_Contact.uOther, m_Velocity.Get(a_Contact.uOther) + a_v3Impulse * a_Contact.fOtherInverseMass);
+}
+void MySolver::SolveFloor(uint a_uIndex)
 {
-	if (glm::length(a_v3Velocity) < minVelocity)
+	if (GetContactInverseMass(a_uIndex) == 0.0f)
+		return;
+
+	//the floor is at y = 0, the body can fall at most down to it
+	float fMinVelocity = -m_Position.y[a_uIndex];
+	if (m_Velocity.y[a_uIndex] < fMinVelocity)
+		m_Velocity.y[a_uIndex] = fMinVelocity;
+}
+void MySolver::ClearContacts(void)
+{
+	m_ContactList.clear();
+
+	if (m_RemovedList.empty())
+		return;
+
+	//forget the pairs of the bodies removed since the last step
+	std::vector<bool> removed(m_uBodyCount, false);
+	for (uint uIndex : m_RemovedList)
+	{
+		removed[uIndex] = true;
+	}
+	m_RemovedList.clear();
+	for (auto it = m_ContactCache.begin(); it != m_ContactCache.end();)
 	{
-		a_v3Velocity = ZERO_V3;
+		if (removed[it->first.first] || removed[it->first.second])
+			it = m_ContactCache.erase(it);
+		else
+			++it;
 	}
-	return a_v3Velocity;
 }
-void MySolver::Update(void)
+uint MySolver::AddContact(uint a_uIndex, uint a_uOther, vector3 a_v3Normal, float a_fPenetration)
 {
-	ApplyForce(vector3(0.0f, -0.035f, 0.0f));
+	//the pair is always stored with the smaller index first so it is found on the next step
+	if (a_uOther < a_uIndex)
+	{
+		std::swap(a_uIndex, a_uOther);
+		a_v3Normal = -a_v3Normal;
+	}
+
+	//a body that moved on the last step wakes up the sleeping one it touches, one that is awake but resting
+	//does not, otherwise the bodies of a pile would keep waking each other up before all of them could sleep
+	bool bMoving = GetContactInverseMass(a_uIndex) > 0.0f && m_StillFrames[a_uIndex] == 0.0f;
+	bool bOtherMoving = GetContactInverseMass(a_uOther) > 0.0f && m_StillFrames[a_uOther] == 0.0f;
+	if (bMoving && m_Simulated[a_uOther] != 0.0f && m_Awake[a_uOther] == 0.0f)
+		WakeUp(a_uOther);
+	else if (bOtherMoving && m_Simulated[a_uIndex] != 0.0f && m_Awake[a_uIndex] == 0.0f)
+		WakeUp(a_uIndex);
 
-	m_v3Velocity += m_v3Acceleration;
-	
-	float fMaxVelocity = 5.0f;
-	m_v3Velocity = CalculateMaxVelocity(m_v3Velocity, fMaxVelocity);
+	MyContact contact;
+	contact.uIndex = a_uIndex;
+	contact.uOther = a_uOther;
+	contact.v3Normal = a_v3Normal;
+	contact.fInverseMass = GetContactInverseMass(a_uIndex);
+	contact.fOtherInverseMass = GetContactInverseMass(a_uOther);
+	float fInverseMassSum = contact.fInverseMass + contact.fOtherInverseMass;
+	contact.fEffectiveMass = fInverseMassSum > 0.0f ? 1.0f / fInverseMassSum : 0.0f;
 
-	ApplyFriction(0.1f);
-	m_v3Velocity = RoundSmallVelocity(m_v3Velocity, 0.028f);
+	//remove a fraction of the penetration each step, leaving a small slop so resting contacts persist
+	contact.fBias = 0.2f * glm::max(a_fPenetration - 0.01f, 0.0f);
 
-	m_v3Position += m_v3Velocity;
-			
-	if (m_v3Position.y <= 0)
+	//friction directions perpendicular to the normal
+	if (glm::abs(a_v3Normal.x) > 0.57735f)
+		contact.v3Tangent[0] = glm::normalize(vector3(a_v3Normal.y, -a_v3Normal.x, 0.0f));
+	else
+		contact.v3Tangent[0] = glm::normalize(vector3(0.0f, a_v3Normal.z, -a_v3Normal.y));
+	contact.v3Tangent[1] = glm::cross(a_v3Normal, contact.v3Tangent[0]);
+
+	//start from what the same pair needed on the last step
+	auto cached = m_ContactCache.find(std::make_pair(a_uIndex, a_uOther));
+	if (cached != m_ContactCache.end())
 	{
-		m_v3Position.y = 0;
-		m_v3Velocity.y = 0;
+		contact.fNormalImpulse = cached->second.fNormal;
+		contact.fTangentImpulse[0] = glm::dot(cached->second.v3Tangent, contact.v3Tangent[0]);
+		contact.fTangentImpulse[1] = glm::dot(cached->second.v3Tangent, contact.v3Tangent[1]);
 	}
 
-	m_v3Acceleration = ZERO_V3;
+	m_ContactList.push_back(contact);
+	return static_cast<uint>(m_ContactList.size() - 1);
 }
-void MySolver::ResolveCollision(MySolver* a_pOther)
+void MySolver::SolveContacts(uint a_uFirst, uint a_uLast)
 {
-	float fMagThis = glm::length(m_v3Velocity);
-	float fMagOther = glm::length(m_v3Velocity);
+	//warm start, apply the impulses the contacts ended the last step with
+	for (uint i = a_uFirst; i < a_uLast; i++)
+	{
+		MyContact& contact = m_ContactList[i];
+		ApplyImpulse(contact, contact.v3Normal * contact.fNormalImpulse +
+			contact.v3Tangent[0] * contact.fTangentImpulse[0] + contact.v3Tangent[1] * contact.fTangentImpulse[1]);
+	}
 
-	if (fMagThis > 0.015f || fMagOther > 0.015f)
+	for (uint uIteration = 0; uIteration < m_uIterationCount; uIteration++)
 	{
-		//a_pOther->ApplyForce(GetVelocity());
-		ApplyForce(-m_v3Velocity);
-		a_pOther->ApplyForce(m_v3Velocity);
+		for (uint i = a_uFirst; i < a_uLast; i++)
+		{
+			MyContact& contact = m_ContactList[i];
+			if (contact.fEffectiveMass == 0.0f)
+				continue;
+
+			//normal, the bodies have to separate at least at the bias velocity, the accumulated impulse can only push
+			vector3 v3Relative = m_Velocity.Get(contact.uOther) - m_Velocity.Get(contact.uIndex);
+			float fImpulse = (contact.fBias - glm::dot(v3Relative, contact.v3Normal)) * contact.fEffectiveMass;
+			float fAccumulated = glm::max(contact.fNormalImpulse + fImpulse, 0.0f);
+			fImpulse = fAccumulated - contact.fNormalImpulse;
+			contact.fNormalImpulse = fAccumulated;
+			ApplyImpulse(contact, contact.v3Normal * fImpulse);
+			SolveFloor(contact.uIndex);
+			SolveFloor(contact.uOther);
+
+			//friction, bounded by the normal impulse
+			float fMaxFriction = m_fFriction * contact.fNormalImpulse;
+			for (uint uTangent = 0; uTangent < 2; uTangent++)
+			{
+				v3Relative = m_Velocity.Get(contact.uOther) - m_Velocity.Get(contact.uIndex);
+				fImpulse = -glm::dot(v3Relative, contact.v3Tangent[uTangent]) * contact.fEffectiveMass;
+				fAccumulated = glm::clamp(contact.fTangentImpulse[uTangent] + fImpulse, -fMaxFriction, fMaxFriction);
+				fImpulse = fAccumulated - contact.fTangentImpulse[uTangent];
+				contact.fTangentImpulse[uTangent] = fAccumulated;
+				ApplyImpulse(contact, contact.v3Tangent[uTangent] * fImpulse);
+			}
+		}
 	}
-	else
+}
+void MySolver::StoreContacts(void)
+{
+	//pairs that are no longer touching are forgotten, the removed bodies with them
+	m_ContactCache.clear();
+	m_RemovedList.clear();
+	for (uint i = 0; i < m_ContactList.size(); i++)
 	{
-		vector3 v3Direction = m_v3Position - a_pOther->m_v3Position;
-		if(glm::length(v3Direction) != 0)
-			v3Direction = glm::normalize(v3Direction);
-		v3Direction *= 0.04f;
-		ApplyForce(v3Direction);
-		a_pOther->ApplyForce(-v3Direction);
+		MyContact& contact = m_ContactList[i];
+		MyContactImpulse impulse;
+		impulse.fNormal = contact.fNormalImpulse;
+		impulse.v3Tangent = contact.v3Tangent[0] * contact.fTangentImpulse[0] + contact.v3Tangent[1] * contact.fTangentImpulse[1];
+		m_ContactCache[std::make_pair(contact.uIndex, contact.uOther)] = impulse;
 	}
+}
+void MySolver::ResolveCollision(uint a_uIndex, uint a_uOther, vector3 a_v3Normal)
+{
+	MyContact contact;
+	contact.uIndex = a_uIndex;
+	contact.uOther = a_uOther;
+	contact.fInverseMass = GetContactInverseMass(a_uIndex);
+	contact.fOtherInverseMass = GetContactInverseMass(a_uOther);
+	float fInverseMassSum = contact.fInverseMass + contact.fOtherInverseMass;
+	if (fInverseMassSum == 0.0f)
+		return;
+
+	//only remove the velocity that brings them together
+	float fApproach = glm::dot(m_Velocity.Get(a_uOther) - m_Velocity.Get(a_uIndex), a_v3Normal);
+	if (fApproach < 0.0f)
+		ApplyImpulse(contact, a_v3Normal * (-fApproach / fInverseMassSum));
 }
\ No newline at end of file
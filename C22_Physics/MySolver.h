@@ -10,122 +10,378 @@ Date: 2017/07
 namespace Simplex
 {
 
+//Physics world, stores the state of every body in contiguous arrays (one per component) so
+//the integration can process four bodies at a time, bodies are addressed by index
 class MySolver
 {
-	vector3 m_v3Acceleration = ZERO_V3; //Acceleration of the MySolver
-	vector3 m_v3Position = ZERO_V3; //Position of the MySolver
-	vector3 m_v3Size = vector3(1.0f); //Size of the MySolver
-	vector3 m_v3Velocity = ZERO_V3; //Velocity of the MySolver
-	float m_fMass = 1.0f; //Mass of the solver
+	struct MyVector3Array
+	{
+		std::vector<float> x; //x component of every entry
+		std::vector<float> y; //y component of every entry
+		std::vector<float> z; //z component of every entry
+		vector3 Get(uint a_uIndex) const { return vector3(x[a_uIndex], y[a_uIndex], z[a_uIndex]); }
+		void Set(uint a_uIndex, vector3 a_v3Value) { x[a_uIndex] = a_v3Value.x; y[a_uIndex] = a_v3Value.y; z[a_uIndex] = a_v3Value.z; }
+		void Resize(uint a_uSize) { x.resize(a_uSize, 0.0f); y.resize(a_uSize, 0.0f); z.resize(a_uSize, 0.0f); }
+	};
+
+	//Contact between two bodies, the normal goes from the first body to the second one
+	struct MyContact
+	{
+		uint uIndex = 0; //first body
+		uint uOther = 0; //second body
+		vector3 v3Normal = ZERO_V3; //direction to push the second body away from the first one
+		vector3 v3Tangent[2]; //friction directions
+		float fInverseMass = 0.0f; //inverse mass of the first body, zero if it does not move
+		float fOtherInverseMass = 0.0f; //inverse mass of the second body, zero if it does not move
+		float fEffectiveMass = 0.0f; //mass seen by the impulses of this contact
+		float fBias = 0.0f; //separating velocity requested to remove the penetration
+		float fNormalImpulse = 0.0f; //accumulated normal impulse
+		float fTangentImpulse[2] = { 0.0f, 0.0f }; //accumulated friction impulses
+	};
+	//Impulses a contact ended a step with, used to warm start it on the next one
+	struct MyContactImpulse
+	{
+		float fNormal = 0.0f; //accumulated normal impulse
+		vector3 v3Tangent = ZERO_V3; //accumulated friction impulse in world space
+	};
+
+	static MySolver* m_pInstance; // Singleton pointer
+
+	uint m_uBodyCount = 0; //number of body slots in use (including released ones waiting in the free list)
+	std::vector<uint> m_FreeList; //released body slots available for reuse
+
+	MyVector3Array m_Acceleration; //Acceleration of each body
+	MyVector3Array m_Position; //Position of each body
+	MyVector3Array m_PreviousPosition; //Position of each body before the last Update
+	MyVector3Array m_Size; //Size of each body
+	MyVector3Array m_Velocity; //Velocity of each body
+	std::vector<float> m_Mass; //Mass of each body
+	std::vector<float> m_InverseMass; //1 / mass of each body, with the mass clamped to its minimum
+	std::vector<float> m_Simulated; //1.0f if the body is integrated, 0.0f if it is not (or the slot is free)
+	std::vector<bool> m_Continuous; //Is this a fast mover that needs continuous collision detection?
+	std::vector<float> m_Awake; //1.0f if the body is awake, 0.0f if it is sleeping
+	std::vector<float> m_StillFrames; //number of consecutive steps the body has been under the sleep velocity
+
+	float m_fSleepVelocity = 0.03f; //bodies slower than this are considered still
+	uint m_uSleepFrames = 30; //steps a body needs to be still to fall asleep
+	uint m_uAwakeCount = 0; //simulated bodies awake after the last Update
+
+	std::vector<MyContact> m_ContactList; //contacts of the current step
+	std::map<std::pair<uint, uint>, MyContactImpulse> m_ContactCache; //impulses of the last step per pair of bodies
+	std::vector<uint> m_RemovedList; //bodies removed since the last step, their impulses are dropped from the cache all at once
+	uint m_uIterationCount = 8; //passes over the contacts per step
+	float m_fFriction = 0.5f; //friction coefficient of the contacts
 public:
 	/*
-	USAGE: Constructor
+	Usage: Gets the singleton pointer
+	Arguments: ---
+	Output: singleton pointer
+	*/
+	static MySolver* GetInstance();
+	/*
+	Usage: Releases the content of the singleton
+	Arguments: ---
+	Output: ---
+	*/
+	static void ReleaseInstance(void);
+
+	/*
+	USAGE: Adds a body to the world, it will not be integrated until SetSimulated is called
 	ARGUMENTS: ---
-	OUTPUT: object instance
+	OUTPUT: index of the body
 	*/
-	MySolver(void);
+	uint AddBody(void);
 	/*
-	USAGE: Copy Constructor
-	ARGUMENTS: object to copy
-	OUTPUT: object instance
+	USAGE: Adds a body to the world copying the state of an existing one
+	ARGUMENTS: uint a_uSource -> index of the body to copy
+	OUTPUT: index of the body
 	*/
-	MySolver(MySolver const& other);
+	uint AddBody(uint a_uSource);
 	/*
-	USAGE: Copy Assignment Operator
-	ARGUMENTS: object to copy
-	OUTPUT: this instance
+	USAGE: Removes a body from the world, its index can be given to a new body afterwards
+	ARGUMENTS: uint a_uIndex -> index of the body
+	OUTPUT: ---
 	*/
-	MySolver& operator=(MySolver const& other);
+	void RemoveBody(uint a_uIndex);
 	/*
-	USAGE: Destructor
+	USAGE: Gets the number of body slots in use
 	ARGUMENTS: ---
-	OUTPUT: ---
+	OUTPUT: body count
 	*/
-	~MySolver(void);
+	uint GetBodyCount(void);
+
 	/*
-	USAGE: Content Swap
-	ARGUMENTS: object to swap content with
+	USAGE: Sets if the body is integrated on Update
+	ARGUMENTS:
+	-	uint a_uIndex -> index of the body
+	-	bool a_bSimulated = true -> integrate the body?
 	OUTPUT: ---
 	*/
-	void Swap(MySolver& other);
+	void SetSimulated(uint a_uIndex, bool a_bSimulated = true);
+	/*
+	USAGE: Asks if the body is integrated on Update
+	ARGUMENTS: uint a_uIndex -> index of the body
+	OUTPUT: integrated?
+	*/
+	bool IsSimulated(uint a_uIndex);
 
 	/*
-	USAGE: Sets the position of the solver
-	ARGUMENTS: vector3 a_v3Position -> position to set
+	USAGE: Asks if the body is awake, sleeping bodies are not integrated until a force wakes them up
+	ARGUMENTS: uint a_uIndex -> index of the body
+	OUTPUT: awake?
+	*/
+	bool IsAwake(uint a_uIndex);
+	/*
+	USAGE: Wakes the body up
+	ARGUMENTS: uint a_uIndex -> index of the body
 	OUTPUT: ---
 	*/
-	void SetPosition(vector3 a_v3Position);
+	void WakeUp(uint a_uIndex);
 	/*
-	USAGE: Gets the position of the solver
+	USAGE: Sets the conditions for a body to fall asleep
+	ARGUMENTS:
+	-	float a_fVelocity -> bodies slower than this are considered still
+	-	uint a_uFrames -> steps a body needs to be still to fall asleep
+	OUTPUT: ---
+	*/
+	void SetSleepThreshold(float a_fVelocity, uint a_uFrames);
+	/*
+	USAGE: Gets the number of simulated bodies that were awake after the last Update
 	ARGUMENTS: ---
-	OUTPUT: position of the solver
+	OUTPUT: awake count
 	*/
-	vector3 GetPosition(void);
+	uint GetAwakeCount(void);
 
 	/*
-	USAGE: Sets the Size of the solver
-	ARGUMENTS: vector3 a_v3Size -> position to set
+	USAGE: Sets the position of the body
+	ARGUMENTS:
+	-	uint a_uIndex -> index of the body
+	-	vector3 a_v3Position -> position to set
 	OUTPUT: ---
 	*/
-	void SetSize(vector3 a_v3Size);
+	void SetPosition(uint a_uIndex, vector3 a_v3Position);
 	/*
-	USAGE: Gets the size of the solver
-	ARGUMENTS: ---
-	OUTPUT: size of the solver
+	USAGE: Gets the position of the body
+	ARGUMENTS: uint a_uIndex -> index of the body
+	OUTPUT: position of the body
 	*/
-	vector3 GetSize(void);
+	vector3 GetPosition(uint a_uIndex);
 
 	/*
-	USAGE: Sets the velocity of the solver
-	ARGUMENTS: vector3 a_v3Velocity -> velocity to set
+	USAGE: Sets the Size of the body
+	ARGUMENTS:
+	-	uint a_uIndex -> index of the body
+	-	vector3 a_v3Size -> size to set
 	OUTPUT: ---
 	*/
-	void SetVelocity(vector3 a_v3Velocity);
+	void SetSize(uint a_uIndex, vector3 a_v3Size);
 	/*
-	USAGE: Gets the velocity of the solver
-	ARGUMENTS: ---
-	OUTPUT: velocity of the solver
+	USAGE: Gets the size of the body
+	ARGUMENTS: uint a_uIndex -> index of the body
+	OUTPUT: size of the body
 	*/
-	vector3 GetVelocity(void);
+	vector3 GetSize(uint a_uIndex);
 
 	/*
-	USAGE: Sets the mass of the solver
-	ARGUMENTS: float a_fMass -> mass to set
+	USAGE: Sets the velocity of the body
+	ARGUMENTS:
+	-	uint a_uIndex -> index of the body
+	-	vector3 a_v3Velocity -> velocity to set
 	OUTPUT: ---
 	*/
-	void SetMass(float a_fMass);
+	void SetVelocity(uint a_uIndex, vector3 a_v3Velocity);
 	/*
-	USAGE: Gets mass of the solver
-	ARGUMENTS: ---
-	OUTPUT: mass of the object
+	USAGE: Gets the velocity of the body
+	ARGUMENTS: uint a_uIndex -> index of the body
+	OUTPUT: velocity of the body
+	*/
+	vector3 GetVelocity(uint a_uIndex);
+
+	/*
+	USAGE: Sets the mass of the body
+	ARGUMENTS:
+	-	uint a_uIndex -> index of the body
+	-	float a_fMass -> mass to set
+	OUTPUT: ---
+	*/
+	void SetMass(uint a_uIndex, float a_fMass);
+	/*
+	USAGE: Gets mass of the body
+	ARGUMENTS: uint a_uIndex -> index of the body
+	OUTPUT: mass of the body
+	*/
+	float GetMass(uint a_uIndex);
+
+	/*
+	USAGE: Sets the continuous collision detection flag of the body
+	ARGUMENTS:
+	-	uint a_uIndex -> index of the body
+	-	bool a_bContinuous = true -> is this a fast mover?
+	OUTPUT: ---
+	*/
+	void SetContinuous(uint a_uIndex, bool a_bContinuous = true);
+	/*
+	USAGE: Asks if the body uses continuous collision detection
+	ARGUMENTS: uint a_uIndex -> index of the body
+	OUTPUT: is this a fast mover?
 	*/
-	float GetMass(void);
+	bool IsContinuous(uint a_uIndex);
 
 	/*
-	USAGE: Applies friction to the movement
-	ARGUMENTS: float a_fFriction = 0.1f -> friction to apply negative friction gets minimized to 0.01f
+	USAGE: Gets the position the body had before the last Update
+	ARGUMENTS: uint a_uIndex -> index of the body
+	OUTPUT: previous position of the body
+	*/
+	vector3 GetPreviousPosition(uint a_uIndex);
+	/*
+	USAGE: Makes the current position of the body its previous one too, for bodies placed from outside the solver
+	so they are neither interpolated nor swept from where they were before
+	ARGUMENTS: uint a_uIndex -> index of the body
 	OUTPUT: ---
 	*/
-	void ApplyFriction(float a_fFriction = 0.1f);
+	void ResetPreviousPosition(uint a_uIndex);
+	/*
+	USAGE: Gets the motion of the body during the last Update
+	ARGUMENTS: uint a_uIndex -> index of the body
+	OUTPUT: displacement from the previous position to the current one
+	*/
+	vector3 GetDisplacement(uint a_uIndex);
+	/*
+	USAGE: Moves the body back along its last motion to the specified time of the frame
+	ARGUMENTS:
+	-	uint a_uIndex -> index of the body
+	-	float a_fTime -> time in the frame to move to, 0 previous position, 1 current position
+	OUTPUT: ---
+	*/
+	void AdvanceTo(uint a_uIndex, float a_fTime);
+
 	/*
-	USAGE: Applies a force to the solver
-	ARGUMENTS: vector3 a_v3Force -> Force to apply
+	USAGE: Applies a force to the body, wakes it up if it was sleeping
+	ARGUMENTS:
+	-	uint a_uIndex -> index of the body
+	-	vector3 a_v3Force -> Force to apply
 	OUTPUT: ---
 	*/
-	void ApplyForce(vector3 a_v3Force);
+	void ApplyForce(uint a_uIndex, vector3 a_v3Force);
 	/*
-	USAGE: Updates the MySolver
+	USAGE: Integrates every simulated body that is awake without solving contacts,
+	same as IntegrateForces followed by IntegrateVelocities
 	ARGUMENTS: ---
 	OUTPUT: ---
 	*/
 	void Update(void);
 	/*
-	USAGE: Resolve the collision between two solvers
-	ARGUMENTS: MySolver* a_pOther -> other solver to resolve collision with
+	USAGE: First half of the step, adds the applied forces and gravity to the velocity of every simulated body
+	that is awake and clamps it, contacts are solved after this
+	ARGUMENTS: ---
+	OUTPUT: ---
+	*/
+	void IntegrateForces(void);
+	/*
+	USAGE: Second half of the step, applies friction and moves every simulated body that is awake,
+	bodies that stay still for long enough fall asleep
+	ARGUMENTS: ---
 	OUTPUT: ---
 	*/
-	void ResolveCollision(MySolver* a_pOther);
+	void IntegrateVelocities(void);
+
+	/*
+	USAGE: Sets the number of passes the contact solver makes over the contacts on each step
+	ARGUMENTS: uint a_uIterations -> number of passes
+	OUTPUT: ---
+	*/
+	void SetIterationCount(uint a_uIterations);
+	/*
+	USAGE: Gets the number of passes the contact solver makes over the contacts on each step
+	ARGUMENTS: ---
+	OUTPUT: number of passes
+	*/
+	uint GetIterationCount(void);
+	/*
+	USAGE: Sets the friction coefficient of the contacts
+	ARGUMENTS: float a_fFriction -> friction coefficient
+	OUTPUT: ---
+	*/
+	void SetFriction(float a_fFriction);
+	/*
+	USAGE: Gets the friction coefficient of the contacts
+	ARGUMENTS: ---
+	OUTPUT: friction coefficient
+	*/
+	float GetFriction(void);
+	/*
+	USAGE: Removes the contacts of the last step, the impulses they ended with are kept until StoreContacts
+	except the ones of the bodies removed since then
+	ARGUMENTS: ---
+	OUTPUT: ---
+	*/
+	void ClearContacts(void);
+	/*
+	USAGE: Adds a contact between two bodies, it starts with the impulses the same pair ended the last step with,
+	a sleeping body touched by one that is awake wakes up
+	ARGUMENTS:
+	-	uint a_uIndex -> index of the first body
+	-	uint a_uOther -> index of the second body
+	-	vector3 a_v3Normal -> direction to push the second body away from the first one
+	-	float a_fPenetration -> depth of the overlap along the normal
+	OUTPUT: index of the contact
+	*/
+	uint AddContact(uint a_uIndex, uint a_uOther, vector3 a_v3Normal, float a_fPenetration);
+	/*
+	USAGE: Gets the number of contacts added on this step
+	ARGUMENTS: ---
+	OUTPUT: contact count
+	*/
+	uint GetContactCount(void);
+	/*
+	USAGE: Solves a range of contacts with sequential impulses, the contacts of the range must not share a moving
+	body with any other range solved at the same time
+	ARGUMENTS:
+	-	uint a_uFirst -> first contact of the range
+	-	uint a_uLast -> one past the last contact of the range
+	OUTPUT: ---
+	*/
+	void SolveContacts(uint a_uFirst, uint a_uLast);
+	/*
+	USAGE: Keeps the impulses every contact ended with to warm start the next step
+	ARGUMENTS: ---
+	OUTPUT: ---
+	*/
+	void StoreContacts(void);
+	/*
+	USAGE: Resolve the collision between two bodies with a single impulse that stops them from approaching each other
+	ARGUMENTS:
+	-	uint a_uIndex -> index of the body
+	-	uint a_uOther -> other body to resolve collision with
+	-	vector3 a_v3Normal -> direction from the body to the other one
+	OUTPUT: ---
+	*/
+	void ResolveCollision(uint a_uIndex, uint a_uOther, vector3 a_v3Normal);
 private:
+	/*
+	USAGE: Constructor
+	ARGUMENTS: ---
+	OUTPUT: object instance
+	*/
+	MySolver(void);
+	/*
+	USAGE: Copy Constructor
+	ARGUMENTS: object to copy
+	OUTPUT: object instance
+	*/
+	MySolver(MySolver const& other);
+	/*
+	USAGE: Copy Assignment Operator
+	ARGUMENTS: object to copy
+	OUTPUT: this instance
+	*/
+	MySolver& operator=(MySolver const& other);
+	/*
+	USAGE: Destructor
+	ARGUMENTS: ---
+	OUTPUT: ---
+	*/
+	~MySolver(void);
 	/*
 	Usage: Deallocates member fields
 	Arguments: ---
@@ -138,6 +394,38 @@ private:
 	Output: ---
 	*/
 	void Init(void);
+	/*
+	Usage: Resizes every array, the size is rounded up to a multiple of four
+	Arguments: uint a_uSize -> number of body slots needed
+	Output: ---
+	*/
+	void Resize(uint a_uSize);
+	/*
+	Usage: Sets the default state on a body slot
+	Arguments: uint a_uIndex -> index of the body
+	Output: ---
+	*/
+	void ResetBody(uint a_uIndex);
+	/*
+	Usage: Gets the inverse mass the contacts see for a body, bodies that are not simulated or are sleeping do not move
+	Arguments: uint a_uIndex -> index of the body
+	Output: inverse mass
+	*/
+	float GetContactInverseMass(uint a_uIndex);
+	/*
+	Usage: Applies an impulse to the two bodies of a contact, pushing the second one along it and the first one against it
+	Arguments:
+	-	MyContact& a_Contact -> contact
+	-	vector3 a_v3Impulse -> impulse
+	Output: ---
+	*/
+	void ApplyImpulse(MyContact& a_Contact, vector3 a_v3Impulse);
+	/*
+	Usage: Keeps the velocity of a body from taking it under the floor, so the floor supports the bodies resting on it
+	Arguments: uint a_uIndex -> index of the body
+	Output: ---
+	*/
+	void SolveFloor(uint a_uIndex);
 };//class
 
 } //namespace Simplex
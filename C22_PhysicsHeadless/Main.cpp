@@ -0,0 +1,250 @@
+/*----------------------------------------------
+Programmer: Alberto Bobadilla (labigm@gmail.com)
+Date: 2017/07
+----------------------------------------------*/
+//Runs the entity and physics layer of C22_Physics without a window or an OpenGL context, as fast as it can,
+//and reports the steps per second and the time of each phase of the step.
+//usage: C22_PhysicsHeadless [steps = 10000] [cubes = 100] [model folder = Data/MOBJ/]
+//       C22_PhysicsHeadless --record <log> [steps = 10000] [cubes = 100] [model folder = Data/MOBJ/]
+//       C22_PhysicsHeadless --replay <log> [model folder = Data/MOBJ/] [--csv <file>]
+//       C22_PhysicsHeadless --occlusion [frames = 1000] [cubes = 100] [model folder = Data/MOBJ/]
+#include "MyReplayer.h"
+
+using namespace Simplex;
+
+const char* g_sPhaseName[PHASE_COUNT] = { "Detection", "Forces", "Contacts", "Velocities", "Entities", "Continuous" };
+
+//prints the time of each phase and its share of the total
+void PrintPhaseTable(double a_dPhaseTime[PHASE_COUNT], uint a_uStepCount, double a_dTotal)
+{
+	printf("\n%-12s %12s %12s %8s\n", "Phase", "Total ms", "Per step ms", "Share");
+	for (uint i = 0; i < PHASE_COUNT; i++)
+	{
+		printf("%-12s %12.3f %12.5f %7.1f%%\n", g_sPhaseName[i], a_dPhaseTime[i],
+			a_uStepCount > 0 ? a_dPhaseTime[i] / a_uStepCount : 0.0, a_dTotal > 0.0 ? a_dPhaseTime[i] * 100.0 / a_dTotal : 0.0);
+	}
+}
+
+//runs a log written by the windowed application or by --record and reports how long its frames took
+int Replay(String a_sLog, String a_sFolder, String a_sCSV)
+{
+	MyEntity::SetModelFolder(a_sFolder);
+	MyReplayer replayer;
+	if (!replayer.Load(a_sLog))
+	{
+		printf("Could not read the log %s\n", a_sLog.c_str());
+		return 1;
+	}
+
+	MyEntityManager* pEntityMngr = MyEntityManager::GetInstance();
+	bool bComplete = replayer.Replay(pEntityMngr);
+
+	//add up the frames and sort them to find the percentiles
+	uint uFrameCount = replayer.GetFrameCount();
+	uint uStepCount = 0;
+	double dTotal = 0.0;
+	double dPhaseTime[PHASE_COUNT] = {};
+	std::vector<float> frameList(uFrameCount);
+	for (uint uFrame = 0; uFrame < uFrameCount; uFrame++)
+	{
+		MyFrameTime frame = replayer.GetFrameTime(uFrame);
+		frameList[uFrame] = frame.fTotal;
+		dTotal += frame.fTotal;
+		uStepCount += frame.uSubsteps;
+		for (uint i = 0; i < PHASE_COUNT; i++)
+		{
+			dPhaseTime[i] += frame.fPhase[i];
+		}
+	}
+	std::sort(frameList.begin(), frameList.end());
+
+	printf("Log:              %s%s\n", a_sLog.c_str(), bComplete ? "" : " (cut short)");
+	printf("Entities:         %u\n", pEntityMngr->GetEntityCount());
+	printf("Threads:          %u\n", MyJobSystem::GetInstance()->GetThreadCount());
+	printf("Frames:           %u\n", uFrameCount);
+	printf("Steps:            %u\n", uStepCount);
+	printf("Total time:       %.3f ms\n", dTotal);
+	if (uFrameCount > 0)
+	{
+		printf("Frame mean:       %.5f ms\n", dTotal / uFrameCount);
+		printf("Frame median:     %.5f ms\n", frameList[uFrameCount / 2]);
+		printf("Frame 99th:       %.5f ms\n", frameList[std::min(uFrameCount - 1, uFrameCount * 99 / 100)]);
+		printf("Frame max:        %.5f ms\n", frameList[uFrameCount - 1]);
+	}
+	printf("Checksum:         %08x\n", replayer.GetChecksum());
+	PrintPhaseTable(dPhaseTime, uStepCount, dTotal);
+
+	if (a_sCSV != "" && !replayer.WriteFrameTimes(a_sCSV))
+		printf("Could not write %s\n", a_sCSV.c_str());
+
+	MyEntityManager::ReleaseInstance();
+	MySolver::ReleaseInstance();
+	MyJobSystem::ReleaseInstance();
+	return bComplete ? 0 : 1;
+}
+
+//culls the scene of the benchmark with the cubes as occluders from a camera circling it and reports how long it took
+int Occlusion(uint a_uFrameCount, uint a_uCubeCount, String a_sFolder)
+{
+	std::vector<vector3> cubeShape = MyEntity::LoadVertexList(a_sFolder + "Minecraft/Cube.obj");
+	if (cubeShape.empty())
+		cubeShape = { vector3(0.0f), vector3(1.0f) };
+	std::vector<vector3> steveShape = MyEntity::LoadVertexList(a_sFolder + "Minecraft/Steve.obj");
+	if (steveShape.empty())
+		steveShape = { vector3(-0.5f, 0.0f, -0.25f), vector3(0.5f, 2.0f, 0.25f) };
+
+	MyEntityManager* pEntityMngr = MyEntityManager::GetInstance();
+	pEntityMngr->Reserve(a_uCubeCount + 1);
+	pEntityMngr->AddEntity(steveShape, "Steve");
+
+	//fixed seed so every run culls the same scene
+	std::mt19937 generator(0);
+	std::uniform_real_distribution<float> angle(0.0f, 2.0f * glm::pi<float>());
+	for (uint i = 0; i < a_uCubeCount; i++)
+	{
+		pEntityMngr->AddEntity(cubeShape, "Cube_" + std::to_string(i));
+		float fAngle = angle(generator);
+		vector3 v3Position = vector3(glm::cos(fAngle), 0.0f, glm::sin(fAngle)) * 12.0f;
+		pEntityMngr->SetModelMatrix(glm::translate(v3Position) * glm::scale(vector3(2.0f)));
+		pEntityMngr->SetOccluder();
+	}
+	pEntityMngr->UseOcclusionCulling();
+
+	//same camera as the windowed application, low and outside the ring so the near cubes hide the far ones
+	matrix4 m4Projection = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.001f, 1000.0f);
+	double dTotal = 0.0;
+	uint uOccluded = 0;
+	uint uTriangles = 0;
+	for (uint uFrame = 0; uFrame < a_uFrameCount; uFrame++)
+	{
+		float fAngle = uFrame * 2.0f * glm::pi<float>() / a_uFrameCount;
+		vector3 v3Eye = vector3(glm::sin(fAngle) * 25.0f, 1.0f, glm::cos(fAngle) * 25.0f);
+		pEntityMngr->CullOccludedEntities(m4Projection * glm::lookAt(v3Eye, ZERO_V3, AXIS_Y));
+		dTotal += pEntityMngr->GetOcclusionTime();
+		uOccluded += pEntityMngr->GetOccludedCount();
+		uTriangles += pEntityMngr->GetOcclusionCuller()->GetTriangleCount();
+	}
+
+	printf("Entities:         %u\n", pEntityMngr->GetEntityCount());
+	printf("Frames:           %u\n", a_uFrameCount);
+	printf("Total time:       %.3f ms\n", dTotal);
+	if (a_uFrameCount > 0)
+	{
+		printf("Frame mean:       %.5f ms\n", dTotal / a_uFrameCount);
+		printf("Triangles:        %.1f per frame\n", static_cast<double>(uTriangles) / a_uFrameCount);
+		printf("Occluded:         %.1f per frame\n", static_cast<double>(uOccluded) / a_uFrameCount);
+	}
+
+	MyEntityManager::ReleaseInstance();
+	MySolver::ReleaseInstance();
+	MyJobSystem::ReleaseInstance();
+	return 0;
+}
+
+int main(int argc, char* argv[])
+{
+	//occlusion culling mode
+	if (argc > 1 && String(argv[1]) == "--occlusion")
+	{
+		uint uFrameCount = argc > 2 ? static_cast<uint>(std::atoi(argv[2])) : 1000;
+		uint uCubeCount = argc > 3 ? static_cast<uint>(std::atoi(argv[3])) : 100;
+		String sFolder = argc > 4 ? argv[4] : "Data/MOBJ/";
+		return Occlusion(uFrameCount, uCubeCount, sFolder);
+	}
+
+	//replay mode
+	if (argc > 2 && String(argv[1]) == "--replay")
+	{
+		String sFolder = "Data/MOBJ/";
+		String sCSV = "";
+		for (int i = 3; i < argc; i++)
+		{
+			if (String(argv[i]) == "--csv" && i + 1 < argc)
+				sCSV = argv[++i];
+			else
+				sFolder = argv[i];
+		}
+		return Replay(argv[2], sFolder, sCSV);
+	}
+
+	//record mode runs the benchmark writing it to a log
+	String sLog = "";
+	int nFirst = 1;
+	if (argc > 2 && String(argv[1]) == "--record")
+	{
+		sLog = argv[2];
+		nFirst = 3;
+	}
+
+	uint uStepCount = argc > nFirst ? static_cast<uint>(std::atoi(argv[nFirst])) : 10000;
+	uint uCubeCount = argc > nFirst + 1 ? static_cast<uint>(std::atoi(argv[nFirst + 1])) : 100;
+	String sFolder = argc > nFirst + 2 ? argv[nFirst + 2] : "Data/MOBJ/";
+
+	MyEntityManager* pEntityMngr = MyEntityManager::GetInstance();
+	if (sLog != "" && !pEntityMngr->StartRecording(sLog))
+	{
+		printf("Could not create the log %s\n", sLog.c_str());
+		return 1;
+	}
+
+	//same scene as the windowed application, the vertices of the models are read straight from the OBJ files,
+	//if they cannot be found a box of the same size is used instead
+	std::vector<vector3> steveShape = MyEntity::LoadVertexList(sFolder + "Minecraft/Steve.obj");
+	if (steveShape.empty())
+		steveShape = { vector3(-0.5f, 0.0f, -0.25f), vector3(0.5f, 2.0f, 0.25f) };
+	std::vector<vector3> cubeShape = MyEntity::LoadVertexList(sFolder + "Minecraft/Cube.obj");
+	if (cubeShape.empty())
+		cubeShape = { vector3(0.0f), vector3(1.0f) };
+
+	std::chrono::high_resolution_clock::time_point setupStart = std::chrono::high_resolution_clock::now();
+	pEntityMngr->Reserve(uCubeCount + 1);
+	MyEntityHandle hSteve = pEntityMngr->AddEntity(steveShape, "Steve");
+	pEntityMngr->UsePhysicsSolver();
+	pEntityMngr->UseContinuousCollision();
+
+	//fixed seed so every run simulates the same scene
+	std::mt19937 generator(0);
+	std::uniform_real_distribution<float> angle(0.0f, 2.0f * glm::pi<float>());
+	for (uint i = 0; i < uCubeCount; i++)
+	{
+		pEntityMngr->AddEntity(cubeShape, "Cube_" + std::to_string(i));
+		float fAngle = angle(generator);
+		vector3 v3Position = vector3(glm::cos(fAngle), 0.0f, glm::sin(fAngle)) * 12.0f;
+		pEntityMngr->SetModelMatrix(glm::translate(v3Position) * glm::scale(vector3(2.0f)));
+		pEntityMngr->UsePhysicsSolver();
+	}
+
+	double dSetup = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - setupStart).count();
+
+	//push Steve through the ring so there is something to solve
+	pEntityMngr->ApplyForce(vector3(3.0f, 0.0f, 0.0f), hSteve);
+
+	//step as fast as possible
+	double dPhaseTime[PHASE_COUNT] = {};
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+	for (uint uStep = 0; uStep < uStepCount; uStep++)
+	{
+		pEntityMngr->Step();
+		for (uint i = 0; i < PHASE_COUNT; i++)
+		{
+			dPhaseTime[i] += pEntityMngr->GetPhaseTime(i);
+		}
+	}
+	double dTotal = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+	//report
+	printf("Entities:         %u\n", pEntityMngr->GetEntityCount());
+	printf("Threads:          %u\n", MyJobSystem::GetInstance()->GetThreadCount());
+	printf("Steps:            %u\n", uStepCount);
+	printf("Setup time:       %.3f ms\n", dSetup);
+	printf("Total time:       %.3f ms\n", dTotal);
+	printf("Steps per second: %.1f\n", dTotal > 0.0 ? uStepCount * 1000.0 / dTotal : 0.0);
+	printf("Awake bodies:     %u\n", MySolver::GetInstance()->GetAwakeCount());
+	printf("Islands:          %u\n", pEntityMngr->GetIslandCount());
+	PrintPhaseTable(dPhaseTime, uStepCount, dTotal);
+
+	MyEntityManager::ReleaseInstance();
+	MySolver::ReleaseInstance();
+	MyJobSystem::ReleaseInstance();
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,18 @@
+#version 330
+layout (location = 0) in vec3 Position_b;
+layout (location = 1) in vec3 Color_b;
+layout (location = 6) in mat4 m4ToWorld_i;
+layout (location = 10) in vec4 Tint_i;
+layout (location = 11) in vec4 Color_i;
+
+uniform mat4 VP;
+
+
+out vec3 Color;
+
+void main()
+{
+	gl_Position = (VP * m4ToWorld_i) * vec4(Position_b, 1);
+	
+	Color = mix(mix(Color_b, Color_i.rgb, Color_i.a), Tint_i.rgb, Tint_i.a);
+}
\ No newline at end of file
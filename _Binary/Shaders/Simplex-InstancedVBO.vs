@@ -0,0 +1,34 @@
+#version 330
+layout (location = 0) in vec3 Position_b;
+layout (location = 1) in vec3 Color_b;
+layout (location = 2) in vec3 UV_b;
+layout (location = 3) in vec3 Normal_b;
+layout (location = 4) in vec3 Binormal_b;
+layout (location = 5) in vec3 Tangent_b;
+layout (location = 6) in mat4 m4ToWorld_i;
+layout (location = 10) in vec4 Tint_i;
+layout (location = 11) in vec4 Color_i;
+
+uniform mat4 VP;
+
+out vec3 Normal_W;
+out vec3 Tangent_W;
+out vec3 Binormal_W;
+out vec3 Position_W;
+out vec3 Eye_W;
+out vec2 UV;
+out vec3 Color;
+
+void main()
+{
+	//m4ToWorld_i, Tint_i and Color_i advance once per instance (attribute divisor 1)
+	gl_Position = (VP * m4ToWorld_i) * vec4(Position_b, 1);
+	
+	UV = UV_b.xy;
+	Color = mix(mix(Color_b, Color_i.rgb, Color_i.a), Tint_i.rgb, Tint_i.a);
+
+	Position_W =	(m4ToWorld_i * vec4(Position_b,1)).xyz;
+	Normal_W =		(m4ToWorld_i * vec4(Normal_b,0)).xyz;
+	Tangent_W =		(m4ToWorld_i * vec4(Tangent_b, 0.0)).xyz;
+	Binormal_W =	(m4ToWorld_i * vec4(Binormal_b, 0.0)).xyz;
+}
\ No newline at end of file
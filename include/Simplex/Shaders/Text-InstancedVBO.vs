@@ -0,0 +1,17 @@
+#version 330
+layout (location = 0) in vec2 Corner_b;
+layout (location = 6) in vec4 Rect_i;
+layout (location = 7) in vec4 UV_i;
+layout (location = 8) in vec4 Color_i;
+
+uniform mat4 MVP;
+
+out vec2 UV;
+out vec3 v3Color;
+
+void main()
+{
+	gl_Position = MVP * vec4(mix(Rect_i.xy, Rect_i.zw, Corner_b), 0, 1);
+	v3Color = Color_i.rgb;
+	UV = mix(UV_i.xy, UV_i.zw, Corner_b);
+}
\ No newline at end of file